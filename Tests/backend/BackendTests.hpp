@@ -0,0 +1,48 @@
+/**
+ * @file BackendTests.hpp
+ * @brief Lets a backend test be its own distance backend (`INDEXGEN_BACKEND=cpu`), as IndexGen is in a real run.
+ */
+
+#ifndef BACKENDTESTS_HPP_
+#define BACKENDTESTS_HPP_
+
+#include "SparseMat.hpp"
+#include <cstdlib>
+#include <map>
+#include <string>
+
+/**
+ * @brief Selects the CPU stand-in backend. `GraphBackendCommand` then starts `/proc/self/exe`, i.e. the test itself.
+ */
+inline void UseCpuTestBackend()
+{
+    setenv("INDEXGEN_BACKEND", "cpu", 1);
+}
+
+/**
+ * @brief When the test was started as the backend (`--graphWorker`), serves it as IndexGen's `--graphWorker` does.
+ * @return Whether it was; `status` is then the exit status for `main`.
+ */
+inline bool ServeTestBackend(int argc, char **argv, int &status)
+{
+    std::map<std::string, int> args = {
+        {"--editDist", 3}, {"--threads", 1}, {"--candidates-fd", -1}, {"--edges-fd", -1}, {"--worker-fd", -1}};
+    bool graphWorker = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--graphWorker")
+            graphWorker = true;
+        else if (args.count(arg) && i + 1 < argc)
+            args[arg] = std::atoi(argv[++i]);
+    }
+    if (!graphWorker)
+        return false;
+    if (args["--worker-fd"] >= 0)
+        status = RunCpuGraphWorker(args["--worker-fd"], args["--editDist"], args["--threads"]);
+    else
+        status = RunCpuGraphBackend(args["--candidates-fd"], args["--edges-fd"], args["--editDist"], args["--threads"]);
+    return true;
+}
+
+#endif /* BACKENDTESTS_HPP_ */
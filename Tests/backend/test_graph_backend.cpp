@@ -0,0 +1,127 @@
+/**
+ * @file test_graph_backend.cpp
+ * @brief The CPU stand-in backend (`INDEXGEN_BACKEND=cpu`, memory file and edge pipe) gives the in-process all-pairs
+ * edge set, whatever the chunk size, and `FillAdjListGPU` ingests it into the same graph in RAM and out of core.
+ */
+
+#include "BackendTests.hpp"
+#include "GraphBackend.hpp"
+#include "TestGraphs.hpp"
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+// Builds the graph through the backend; `runNum` gets the number of runs an out-of-core build merged
+vector<pair<int, int>> BackendEdges(const PackedCandidateSet &candidates, int minED, size_t externalBudget,
+                                    size_t &runNum)
+{
+    AdjList adjList;
+    adjList.SetExternalMemory(externalBudget);
+    long long int matrixOnesNum = 0;
+    ostringstream log;
+    streambuf *coutBuf = cout.rdbuf(log.rdbuf());
+    try
+    {
+        FillAdjListGPU(adjList, candidates, minED, 2, matrixOnesNum, 10.0, false);
+    }
+    catch (...)
+    {
+        cout.rdbuf(coutBuf);
+        throw;
+    }
+    cout.rdbuf(coutBuf);
+    const string text = log.str();
+    const size_t into = text.find(" edges into ");
+    runNum = into == string::npos ? 0 : stoul(text.substr(into + 12));
+
+    const vector<pair<int, int>> edges = TestGraphEdges(adjList);
+    Expect(matrixOnesNum == 2 * (long long int)edges.size(), "backend: entry count differs from the edges");
+    return edges;
+}
+
+// Streams the backend's edges in chunks of `chunkPairs` and checks the chunking; returns the edges, sorted
+vector<pair<int, int>> ChunkedEdges(const PackedCandidateSet &candidates, int minED, size_t chunkPairs,
+                                    const string &what)
+{
+    vector<pair<int, int>> edges;
+    size_t chunkNum = 0;
+    bool shortChunk = false;
+    const size_t edgeNum = RunGraphBackend(GraphBackendCommand(minED, 2, 10.0, false), candidates, chunkPairs, true,
+                                           [&](vector<pair<int, int>> &chunk) {
+                                               // Only the last chunk may be short, and none is empty
+                                               Expect(!shortChunk && !chunk.empty() && chunk.size() <= chunkPairs,
+                                                      what + ": chunk of " + to_string(chunk.size()) + " records");
+                                               shortChunk = chunk.size() < chunkPairs;
+                                               edges.insert(edges.end(), chunk.begin(), chunk.end());
+                                               ++chunkNum;
+                                           });
+    Expect(edgeNum == edges.size(), what + ": record count differs from the records received");
+    Expect(chunkNum == (edges.size() + chunkPairs - 1) / chunkPairs, what + ": wrong number of chunks");
+    for (const pair<int, int> &e : edges)
+        Expect(e.first < e.second, what + ": record not in (u < v) order");
+    sort(edges.begin(), edges.end());
+    return edges;
+}
+
+int main(int argc, char **argv)
+{
+    int status;
+    if (ServeTestBackend(argc, argv, status))
+        return status;
+    UseCpuTestBackend();
+
+    mt19937_64 rng(18);
+    int caseNum = 0;
+    size_t multiRunNum = 0;
+    // (length, alphabet, candidates), from a lone candidate to a few thousand
+    const vector<vector<int>> shapes = {{8, 4, 1}, {8, 4, 60}, {10, 2, 700}, {12, 4, 2000}, {16, 4, 1500},
+                                        {24, 2, 1200}, {40, 4, 800}};
+    for (const vector<int> &shape : shapes)
+    {
+        for (int minED = 2; minED <= 4; ++minED)
+        {
+            const PackedCandidateSet candidates = RandomTestCandidates(rng, shape[0], shape[1], shape[2]);
+            const string what = to_string(candidates.size()) + " candidates of length " + to_string(shape[0]) +
+                                " minED " + to_string(minED);
+            const vector<pair<int, int>> reference = AllPairsTestEdges(candidates, minED);
+
+            size_t runNum;
+            Expect(BackendEdges(candidates, minED, 0, runNum) == reference, what + ": in RAM differs from allpairs");
+            Expect(BackendEdges(candidates, minED, size_t(8) << 10, runNum) == reference,
+                   what + ": out of core differs from allpairs");
+            multiRunNum += runNum > 1;
+
+            // Chunks of one record, a few, one short of the edge count, exactly it and one over
+            const size_t edgeNum = reference.size();
+            for (size_t chunkPairs : {size_t(1), size_t(7), edgeNum - 1, edgeNum, edgeNum + 1})
+            {
+                if (chunkPairs == 0 || chunkPairs > edgeNum + 1)
+                    continue;
+                Expect(ChunkedEdges(candidates, minED, chunkPairs, what + " chunk " + to_string(chunkPairs)) ==
+                           reference,
+                       what + " chunk " + to_string(chunkPairs) + ": edges differ from allpairs");
+            }
+            ++caseNum;
+        }
+    }
+    Expect(multiRunNum > 0, "no out-of-core build spilled more than one run");
+
+    // A backend that fails is reported, not taken for an empty graph
+    bool threw = false;
+    try
+    {
+        RunGraphBackend({"false"}, RandomTestCandidates(rng, 8, 4, 10), 16, true,
+                        [](vector<pair<int, int>> &) {});
+    }
+    catch (const runtime_error &)
+    {
+        threw = true;
+    }
+    Expect(threw, "a failing backend is not reported");
+    ++caseNum;
+
+    cout << "GraphBackend: " << caseNum << " cases (" << multiRunNum << " out of core over several runs), "
+         << TestFailures() << " failures" << endl;
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file test_graph_worker.cpp
+ * @brief A persistent CPU stand-in worker (`GraphWorker`, `--graphWorker --worker-fd`) answers batch after batch with
+ * the in-process edges of every job, its codebooks are the ones `SolveIndependentSet` finds, and it exits cleanly.
+ */
+
+#include "BackendTests.hpp"
+#include "GraphBackend.hpp"
+#include "TestGraphs.hpp"
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+// A batch of one to six jobs of one length, from empty sets to a few hundred candidates
+vector<PackedCandidateSet> RandomBatch(mt19937_64 &rng, int n)
+{
+    vector<PackedCandidateSet> jobs;
+    for (int j = 1 + (int)(rng() % 6); j > 0; --j)
+    {
+        const int count = rng() % 5 == 0 ? (int)(rng() % 2) : 2 + (int)(rng() % 400);
+        jobs.push_back(count ? RandomTestCandidates(rng, n, rng() % 3 == 0 ? 2 : 4, count) : PackedCandidateSet(n));
+    }
+    return jobs;
+}
+
+// Checks the worker's reply to one batch against the in-process edges and codebooks
+void CheckBatch(const vector<PackedCandidateSet> &jobs, vector<vector<pair<int, int>>> &reply, int minED,
+                const string &what)
+{
+    Expect(reply.size() == jobs.size(), what + ": one reply per job expected");
+    for (size_t j = 0; j < jobs.size() && j < reply.size(); ++j)
+    {
+        const string job = what + " job " + to_string(j) + " (" + to_string(jobs[j].size()) + " candidates)";
+        for (const pair<int, int> &e : reply[j])
+            Expect(e.first < e.second && e.second < (int)jobs[j].size(), job + ": record out of range or order");
+        vector<pair<int, int>> edges = reply[j];
+        sort(edges.begin(), edges.end());
+        Expect(edges == AllPairsTestEdges(jobs[j], minED), job + ": edges differ from allpairs");
+        const PackedCandidateSet fromWorker = SolveIndependentSetFromEdges(jobs[j], reply[j], 1, GraphParams());
+        const PackedCandidateSet inProcess = SolveIndependentSet(jobs[j], minED, 1, false, 10.0, GraphParams());
+        Expect(fromWorker.ToStrings() == inProcess.ToStrings(), job + ": codebook differs from SolveIndependentSet");
+    }
+}
+
+// Runs `batches` through `worker` one after the other and returns the replies
+vector<vector<vector<pair<int, int>>>> RunBatches(GraphWorker &worker, const vector<vector<PackedCandidateSet>> &batches)
+{
+    vector<vector<vector<pair<int, int>>>> replies;
+    for (const vector<PackedCandidateSet> &batch : batches)
+    {
+        vector<const PackedCandidateSet *> jobs;
+        for (const PackedCandidateSet &job : batch)
+            jobs.push_back(&job);
+        replies.push_back(worker.Run(jobs));
+    }
+    return replies;
+}
+
+void CheckBatches(const vector<vector<PackedCandidateSet>> &batches, vector<vector<vector<pair<int, int>>>> &replies,
+                  int minED, const string &what)
+{
+    Expect(replies.size() == batches.size(), what + ": one reply per batch expected");
+    for (size_t b = 0; b < batches.size() && b < replies.size(); ++b)
+        CheckBatch(batches[b], replies[b], minED, what + " batch " + to_string(b));
+}
+
+bool Throws(const function<void()> &f)
+{
+    try
+    {
+        f();
+    }
+    catch (const runtime_error &)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    int status;
+    if (ServeTestBackend(argc, argv, status))
+        return status;
+    UseCpuTestBackend();
+
+    mt19937_64 rng(19);
+    int batchNum = 0;
+    for (int minED = 2; minED <= 4; ++minED)
+    {
+        const string what = "minED " + to_string(minED);
+        GraphWorker worker(GraphBackendCommand(minED, 3, 10.0, false), true);
+
+        // Batches of changing lengths, one after the other
+        vector<vector<PackedCandidateSet>> batches;
+        for (int n : {8, 12, 8, 20, 40})
+            batches.push_back(RandomBatch(rng, n));
+        vector<vector<vector<pair<int, int>>>> replies = RunBatches(worker, batches);
+        CheckBatches(batches, replies, minED, what);
+        batchNum += (int)batches.size();
+
+        // Two threads sharing the worker: the batches are served one at a time
+        vector<vector<PackedCandidateSet>> left, right;
+        for (int b = 0; b < 3; ++b)
+        {
+            left.push_back(RandomBatch(rng, 10));
+            right.push_back(RandomBatch(rng, 14));
+        }
+        vector<vector<vector<pair<int, int>>>> rightReplies;
+        bool rightFailed = false;
+        thread other([&]() {
+            try
+            {
+                rightReplies = RunBatches(worker, right);
+            }
+            catch (const runtime_error &)
+            {
+                rightFailed = true;
+            }
+        });
+        vector<vector<vector<pair<int, int>>>> leftReplies = RunBatches(worker, left);
+        other.join();
+        Expect(!rightFailed, what + " thread 2: a batch failed");
+        CheckBatches(left, leftReplies, minED, what + " thread 1");
+        CheckBatches(right, rightReplies, minED, what + " thread 2");
+        batchNum += 6;
+
+        Expect(worker.Run({}).empty(), what + ": an empty batch has replies");
+        Expect(!Throws([&]() { worker.Close(); }), what + ": the worker did not exit cleanly");
+        const PackedCandidateSet job = RandomTestCandidates(rng, 8, 4, 10);
+        Expect(Throws([&]() { worker.Run({&job}); }), what + ": a closed worker takes a batch");
+    }
+
+    // A worker that exits instead of serving fails its batch and its shutdown
+    GraphWorker failing({"false"}, true);
+    const PackedCandidateSet job = RandomTestCandidates(rng, 8, 4, 50);
+    Expect(Throws([&]() { failing.Run({&job}); }), "a failed worker returns a reply");
+    Expect(Throws([&]() { failing.Close(); }), "a failed worker closes cleanly");
+
+    cout << "GraphWorker: " << batchNum << " batches, " << TestFailures() << " failures" << endl;
+    return TestFailures() == 0 ? 0 : 1;
+}
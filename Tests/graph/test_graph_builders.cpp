@@ -0,0 +1,76 @@
+/**
+ * @file test_graph_builders.cpp
+ * @brief The ball, segment and deletion builders give the all-pairs conflict graph, in RAM and out of core, on random
+ * candidate sets over both alphabets at minimum distances 2-4.
+ */
+
+#include "TestGraphs.hpp"
+#include <map>
+#include <sstream>
+
+using namespace std;
+
+// Builds the conflict graph with `builder` and returns its edges (u < v) in order; `ran` tells whether the builder
+// did the work or fell back to the all-pairs scan
+vector<pair<int, int>> BuilderEdges(const PackedCandidateSet &candidates, int minED, const string &builder,
+                                    size_t externalBudget, bool &ran)
+{
+    GraphParams graph;
+    graph.builder = builder;
+    AdjList adjList;
+    adjList.SetExternalMemory(externalBudget);
+    long long int matrixOnesNum = 0;
+    ostringstream log;
+    streambuf *coutBuf = cout.rdbuf(log.rdbuf());
+    FillAdjList(adjList, candidates, minED, 3, 0, false, matrixOnesNum, graph);
+    cout.rdbuf(coutBuf);
+    ran = log.str().find("using allpairs") == string::npos;
+
+    const vector<pair<int, int>> edges = TestGraphEdges(adjList);
+    Expect(matrixOnesNum == 2 * (long long int)edges.size(), builder + ": entry count differs from the edges");
+    return edges;
+}
+
+int main()
+{
+    mt19937_64 rng(8);
+    const vector<string> builders = {"ball", "segment", "deletion"};
+    map<pair<string, int>, int> ranNum;
+    int caseNum = 0;
+    // (length, alphabet, candidates): short dense sets where the ball and deletion indexes pay off, longer sparse
+    // ones where the segments filter
+    const vector<vector<int>> shapes = {{6, 4, 3000}, {8, 4, 4000}, {10, 2, 900}, {14, 2, 3000},
+                                        {12, 4, 2500}, {16, 4, 2500}, {20, 2, 2000}};
+    for (const vector<int> &shape : shapes)
+    {
+        for (int minED = 2; minED <= 4; ++minED)
+        {
+            const PackedCandidateSet candidates = RandomTestCandidates(rng, shape[0], shape[1], shape[2]);
+            const string what = "length " + to_string(shape[0]) + " alphabet " + to_string(shape[1]) + " minED " +
+                                to_string(minED);
+            bool ran;
+            const vector<pair<int, int>> reference = BuilderEdges(candidates, minED, "allpairs", 0, ran);
+            Expect(!reference.empty(), what + ": no conflicts to compare");
+            for (const string &builder : builders)
+            {
+                for (size_t budget : {size_t(0), size_t(16) << 10})
+                {
+                    const string how = what + " " + builder + (budget ? " out of core" : "");
+                    Expect(BuilderEdges(candidates, minED, builder, budget, ran) == reference,
+                           how + ": edges differ from allpairs");
+                    ranNum[make_pair(builder, minED)] += ran;
+                    ++caseNum;
+                }
+            }
+        }
+    }
+    // A builder that always fell back would only have compared allpairs with itself. The radius-3 ball is larger than
+    // any of these sets once weighted by its probe cost, so the ball builder is only required up to minED 3
+    for (const string &builder : builders)
+    {
+        for (int minED = 2; minED <= (builder == "ball" ? 3 : 4); ++minED)
+            Expect(ranNum[make_pair(builder, minED)] > 0, builder + " minED " + to_string(minED) + ": never applied");
+    }
+    cout << "GraphBuilders: " << caseNum << " cases, " << TestFailures() << " failures" << endl;
+    return TestFailures() == 0 ? 0 : 1;
+}
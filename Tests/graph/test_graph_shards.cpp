@@ -0,0 +1,114 @@
+/**
+ * @file test_graph_shards.cpp
+ * @brief Shards of one graph merge into the all-pairs graph with either tiling; shards cut from different triangles
+ * (`--compositionTiles` changed between them) are refused by the merge, and the odd shard is rebuilt when run again.
+ */
+
+#include "Candidates.hpp"
+#include "GraphCache.hpp"
+#include "TestGraphs.hpp"
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace std;
+
+const int kShardCount = 3;
+
+// All length-7 strings with 30-70% GC and runs of at most 3 (a few thousand candidates) at ED 3
+unique_ptr<Params> ShardParams(const string &cacheDir, bool compositionTiles, int shardIndex)
+{
+    unique_ptr<Params> params(new Params(7, 3, 3, 0.3, 0.7, 2, 0, GenerationMethod::ALL_STRINGS,
+                                         unique_ptr<GenerationConstraints>(new AllStringsConstraints()), false,
+                                         false));
+    params->graph.cacheDir = cacheDir;
+    params->graph.compositionTiles = compositionTiles;
+    params->graphShardIndex = shardIndex;
+    params->graphShardCount = kShardCount;
+    return params;
+}
+
+// Runs `f` with the standard output (progress reports) discarded
+template <typename F> void Quietly(F &&f)
+{
+    ostringstream log;
+    streambuf *coutBuf = cout.rdbuf(log.rdbuf());
+    try
+    {
+        f();
+    }
+    catch (...)
+    {
+        cout.rdbuf(coutBuf);
+        throw;
+    }
+    cout.rdbuf(coutBuf);
+}
+
+void BuildShard(const string &cacheDir, bool compositionTiles, int shardIndex)
+{
+    Quietly([&]() { GenerateGraphShard(*ShardParams(cacheDir, compositionTiles, shardIndex)); });
+}
+
+// Merges the shards and checks the merged graph against the in-process all-pairs graph; false when the merge throws
+bool MergeAndCheck(const string &cacheDir, const PackedCandidateSet &candidates, const vector<pair<int, int>> &edges,
+                   const string &what)
+{
+    try
+    {
+        Quietly([&]() { GenerateGraphMerge(*ShardParams(cacheDir, true, 0)); });
+    }
+    catch (const runtime_error &)
+    {
+        return false;
+    }
+    AdjList adjList;
+    Expect(LoadCachedGraph(adjList, cacheDir, IGraphHeader::ForCandidates(candidates, 3)), what + ": no merged graph");
+    Expect(TestGraphEdges(adjList) == edges, what + ": merged graph differs from allpairs");
+    filesystem::remove_all(cacheDir);
+    return true;
+}
+
+int main()
+{
+    const string cacheDir =
+        (filesystem::temp_directory_path() / ("test_graph_shards_" + to_string(getpid()))).string();
+    filesystem::remove_all(cacheDir);
+    const PackedCandidateSet candidates = Candidates(*ShardParams(cacheDir, true, 0));
+    const IGraphHeader key = IGraphHeader::ForCandidates(candidates, 3);
+    const vector<pair<int, int>> edges = AllPairsTestEdges(candidates, 3);
+    int caseNum = 0;
+
+    // Either tiling gives the graph, as long as every shard uses it
+    for (bool compositionTiles : {true, false})
+    {
+        const string what = compositionTiles ? "composition tiles" : "fixed blocks";
+        for (int shard = 0; shard < kShardCount; ++shard)
+            BuildShard(cacheDir, compositionTiles, shard);
+        Expect(MergeAndCheck(cacheDir, candidates, edges, what), what + ": merge failed");
+        ++caseNum;
+    }
+
+    // One shard cut from the other triangle: the merge refuses the set and keeps the shards
+    for (int shard = 0; shard < kShardCount; ++shard)
+        BuildShard(cacheDir, shard != 1, shard);
+    Expect(!MergeAndCheck(cacheDir, candidates, edges, "mixed tilings"), "shards of mixed tilings merged");
+    for (int shard = 0; shard < kShardCount; ++shard)
+        Expect(GraphShardDone(cacheDir, key, shard, kShardCount, shard != 1),
+               "shard " + to_string(shard) + " lost by the refused merge");
+    Expect(!GraphShardDone(cacheDir, key, 1, kShardCount, true), "a shard of the other tiling counts as done");
+    ++caseNum;
+
+    // Running the odd shard again with the tiling of the others rebuilds it, and the set merges
+    BuildShard(cacheDir, true, 1);
+    Expect(GraphShardDone(cacheDir, key, 1, kShardCount, true), "the rebuilt shard is not done");
+    Expect(MergeAndCheck(cacheDir, candidates, edges, "rebuilt shard"), "rebuilt shard: merge failed");
+    ++caseNum;
+
+    filesystem::remove_all(cacheDir);
+    cout << "GraphShards: " << caseNum << " cases (" << candidates.size() << " candidates, " << edges.size()
+         << " edges), " << TestFailures() << " failures" << endl;
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file test_metric_index.cpp
+ * @brief A `MetricIndex` read back with `Load` answers every radius and nearest-word query as the index it was saved
+ * from, both match a linear scan, and `Load` rejects files that are not an index of the current format.
+ */
+
+#include "MetricIndex.hpp"
+#include "TestGraphs.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+
+// Random words of length n, a third of them one or two substitutions away from an earlier one
+PackedCandidateSet RandomWords(mt19937_64 &rng, int n, int count)
+{
+    vector<string> strs;
+    for (int i = 0; i < count; ++i)
+    {
+        string s(n, '0');
+        if (!strs.empty() && rng() % 3 == 0)
+        {
+            s = strs[rng() % strs.size()];
+            for (int edits = 1 + (int)(rng() % 2); edits > 0; --edits)
+                s[rng() % n] = char('0' + rng() % 4);
+        }
+        else
+        {
+            for (char &c : s)
+                c = char('0' + rng() % 4);
+        }
+        strs.push_back(s);
+    }
+    return PackedCandidateSet::FromStrings(strs);
+}
+
+// A query near one of the words, or a random one
+string RandomQuery(mt19937_64 &rng, const PackedCandidateSet &words, int n)
+{
+    string q(n, '0');
+    if (!words.empty() && rng() % 2 == 0)
+    {
+        q = words.Get(rng() % words.size());
+        for (int edits = (int)(rng() % 4); edits > 0; --edits)
+            q[rng() % n] = char('0' + rng() % 4);
+    }
+    else
+    {
+        for (char &c : q)
+            c = char('0' + rng() % 4);
+    }
+    return q;
+}
+
+// The (index, distance) pairs within `radius` of `query`, by a linear scan, sorted as `Within` sorts them
+vector<pair<int, int>> ScanWithin(const PackedCandidateSet &words, const string &query, int radius)
+{
+    vector<pair<int, int>> found;
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        const int d = EditDistanceExact(words.Get(i), query);
+        if (d <= radius)
+            found.push_back(make_pair(d, (int)i));
+    }
+    sort(found.begin(), found.end());
+    for (pair<int, int> &p : found)
+        swap(p.first, p.second);
+    return found;
+}
+
+// Every (index, distance) pair `ForEachWithin` reports from `first` on
+vector<pair<int, int>> WithinFrom(const MetricIndex &index, const string &query, int radius, size_t first)
+{
+    vector<pair<int, int>> found;
+    vector<uint8_t> bound;
+    index.ForEachWithin(query, radius, first, bound, [&](int id, int d) { found.push_back(make_pair(id, d)); });
+    return found;
+}
+
+bool LoadThrows(const string &path)
+{
+    try
+    {
+        MetricIndex::Load(path);
+    }
+    catch (const runtime_error &)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main()
+{
+    mt19937_64 rng(10);
+    const string path = (filesystem::temp_directory_path() / "test_metric_index.igmi").string();
+    int caseNum = 0;
+    for (int trial = 0; trial < 24; ++trial)
+    {
+        const int n = 6 + (int)(rng() % 15);
+        const int count = trial % 8 == 0 ? (int)(rng() % 4) : 1 + (int)(rng() % 1500);
+        const int pivotNum = 1 + (int)(rng() % 20);
+        const PackedCandidateSet words = RandomWords(rng, n, count);
+        const MetricIndex built(words, 1 + (int)(rng() % 3), pivotNum);
+        built.Save(path);
+        const MetricIndex loaded = MetricIndex::Load(path);
+        const string what = "trial " + to_string(trial) + " (" + to_string(count) + " words of length " +
+                            to_string(n) + ")";
+        Expect(loaded.size() == built.size() && loaded.PivotCount() == built.PivotCount(),
+               what + ": size or pivots differ after Load");
+
+        for (int query = 0; query < 40; ++query)
+        {
+            const string q = RandomQuery(rng, words, n);
+            const int radius = (int)(rng() % 5);
+            const vector<pair<int, int>> within = built.Within(q, radius);
+            Expect(loaded.Within(q, radius) == within, what + ": Within differs after Load");
+            Expect(within == ScanWithin(words, q, radius), what + ": Within differs from a linear scan");
+            const size_t first = words.empty() ? 0 : rng() % words.size();
+            Expect(WithinFrom(loaded, q, radius, first) == WithinFrom(built, q, radius, first),
+                   what + ": ForEachWithin differs after Load");
+            const int k = 1 + (int)(rng() % 5);
+            const vector<pair<int, int>> nearest = built.Nearest(q, k);
+            Expect(loaded.Nearest(q, k) == nearest, what + ": Nearest differs after Load");
+            // The k nearest are the first k of the words sorted by distance, then index
+            vector<pair<int, int>> scan = ScanWithin(words, q, 2 * n);
+            scan.resize(min(scan.size(), (size_t)k));
+            Expect(nearest == scan, what + ": Nearest differs from a linear scan");
+            ++caseNum;
+        }
+    }
+
+    // A file of another format, version or size is rejected rather than read as an index
+    const MetricIndex index(RandomWords(rng, 12, 200), 1, 8);
+    index.Save(path);
+    string bytes;
+    {
+        ifstream input(path, ios::binary);
+        bytes.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+    }
+    const auto writeBytes = [&](const string &data) {
+        ofstream output(path, ios::binary | ios::trunc);
+        output.write(data.data(), data.size());
+    };
+    string badMagic = bytes, badVersion = bytes;
+    badMagic[0] = 'X';
+    badVersion[4] ^= 0x7f;
+    writeBytes(badMagic);
+    Expect(LoadThrows(path), "a file with another magic loads");
+    writeBytes(badVersion);
+    Expect(LoadThrows(path), "a file of another version loads");
+    writeBytes(bytes.substr(0, bytes.size() - 1));
+    Expect(LoadThrows(path), "a truncated file loads");
+    writeBytes(bytes + '\0');
+    Expect(LoadThrows(path), "a file with trailing bytes loads");
+    writeBytes(bytes);
+    Expect(!LoadThrows(path), "the saved file does not load");
+    remove(path.c_str());
+    Expect(LoadThrows(path), "a missing file loads");
+    caseNum += 6;
+
+    cout << "MetricIndex: " << caseNum << " cases, " << TestFailures() << " failures" << endl;
+    return TestFailures() == 0 ? 0 : 1;
+}
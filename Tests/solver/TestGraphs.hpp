@@ -0,0 +1,179 @@
+/**
+ * @file TestGraphs.hpp
+ * @brief Random conflict graphs and candidate sets, and the set checks, shared by the tests (`make check`).
+ */
+
+#ifndef TESTGRAPHS_HPP_
+#define TESTGRAPHS_HPP_
+
+#include "PackedCandidates.hpp"
+#include "SparseMat.hpp"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** @brief A graph as plain data: its edges (u < v) and the nodes that are candidates of the codebook. */
+struct TestGraph
+{
+    int nodeNum = 0;
+    std::vector<std::pair<int, int>> edges;
+    std::vector<bool> active;
+};
+
+/** @brief Every storage `BuildTestGraph` knows, so each test can run on all of them. */
+inline const std::vector<std::string> &TestStorages()
+{
+    static const std::vector<std::string> storages = {"plain", "compressed", "bitset", "rcm"};
+    return storages;
+}
+
+/** @brief A G(n, p) graph; with `masked`, about a fifth of the nodes are masked out. */
+inline TestGraph RandomTestGraph(std::mt19937_64 &rng, int nodeNum, double density, bool masked)
+{
+    TestGraph graph;
+    graph.nodeNum = nodeNum;
+    std::bernoulli_distribution edge(density), drop(masked ? 0.2 : 0.0);
+    for (int u = 0; u < nodeNum; ++u)
+        for (int v = u + 1; v < nodeNum; ++v)
+            if (edge(rng))
+                graph.edges.push_back(std::make_pair(u, v));
+    for (int u = 0; u < nodeNum; ++u)
+        graph.active.push_back(!drop(rng));
+    return graph;
+}
+
+/**
+ * @brief Up to `count` distinct random candidates of length `n` over the first `alphabet` letters.
+ * @details About half are one to three edits away from an earlier one, so every distance has conflicts to find.
+ */
+inline PackedCandidateSet RandomTestCandidates(std::mt19937_64 &rng, int n, int alphabet, int count)
+{
+    std::set<std::string> seen;
+    std::vector<std::string> strs;
+    for (int tries = 0; (int)strs.size() < count && tries < 4 * count; ++tries)
+    {
+        std::string s(n, '0');
+        if (!strs.empty() && rng() % 2 == 0)
+        {
+            s = strs[rng() % strs.size()];
+            for (int edits = 1 + (int)(rng() % 3); edits > 0; --edits)
+            {
+                // A substitution, or a deletion and an insertion that keep the length
+                if (rng() % 2 == 0)
+                    s[rng() % n] = char('0' + rng() % alphabet);
+                else
+                {
+                    s.erase(rng() % n, 1);
+                    s.insert(rng() % n, 1, char('0' + rng() % alphabet));
+                }
+            }
+        }
+        else
+        {
+            for (char &c : s)
+                c = char('0' + rng() % alphabet);
+        }
+        if (seen.insert(s).second)
+            strs.push_back(s);
+    }
+    return PackedCandidateSet::FromStrings(strs);
+}
+
+/**
+ * @brief Builds `graph` into `adjList` the way the Codebook stage does: storage, build, vertex order, mask, buckets.
+ * @param storage "plain", "compressed", "bitset" (a bit matrix when it is no larger than the lists) or "rcm" (plain,
+ * relabelled in reverse Cuthill-McKee order).
+ */
+inline void BuildTestGraph(AdjList &adjList, const TestGraph &graph, const std::string &storage, int threadNum = 1)
+{
+    adjList.Init(graph.nodeNum);
+    adjList.SetCompressed(storage == "compressed");
+    adjList.SetBitsetBudget(storage == "bitset" ? size_t(1) << 30 : 0);
+    adjList.Build(std::vector<std::vector<std::pair<int, int>>>(1, graph.edges), threadNum);
+    if (storage == "rcm")
+        adjList.Relabel("rcm");
+    adjList.MaskNodes(graph.active);
+    adjList.RowsBySum();
+}
+
+/** @brief The edges (u < v) between the active nodes of `adjList`, sorted. */
+inline std::vector<std::pair<int, int>> TestGraphEdges(const AdjList &adjList)
+{
+    std::vector<std::pair<int, int>> edges;
+    for (int u = 0; u < (int)adjList.NodeCount(); ++u)
+    {
+        adjList.ForEachActiveNeighbour(u, [&](int v) {
+            if (u < v)
+                edges.push_back(std::make_pair(u, v));
+        });
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+/** @brief The conflict edges of `candidates` at `minED` from the in-process all-pairs scan, sorted. */
+inline std::vector<std::pair<int, int>> AllPairsTestEdges(const PackedCandidateSet &candidates, int minED)
+{
+    AdjList adjList;
+    long long int matrixOnesNum = 0;
+    FillAdjList(adjList, candidates, minED, 2, 0, false, matrixOnesNum, GraphParams(), true);
+    return TestGraphEdges(adjList);
+}
+
+/** @brief Whether `nodes` are active, distinct and pairwise non-adjacent in `graph`. */
+inline bool IsIndependent(const TestGraph &graph, const std::vector<int> &nodes)
+{
+    std::vector<bool> in(graph.nodeNum, false);
+    for (int u : nodes)
+    {
+        if (u < 0 || u >= graph.nodeNum || !graph.active[u] || in[u])
+            return false;
+        in[u] = true;
+    }
+    for (const std::pair<int, int> &e : graph.edges)
+        if (in[e.first] && in[e.second])
+            return false;
+    return true;
+}
+
+/** @brief Whether every active node of `graph` is in `nodes` or adjacent to one of them. */
+inline bool IsMaximal(const TestGraph &graph, const std::vector<int> &nodes)
+{
+    std::vector<bool> in(graph.nodeNum, false), covered(graph.nodeNum, false);
+    for (int u : nodes)
+        in[u] = covered[u] = true;
+    for (const std::pair<int, int> &e : graph.edges)
+    {
+        if (!graph.active[e.first] || !graph.active[e.second])
+            continue;
+        if (in[e.first])
+            covered[e.second] = true;
+        if (in[e.second])
+            covered[e.first] = true;
+    }
+    for (int u = 0; u < graph.nodeNum; ++u)
+        if (graph.active[u] && !covered[u])
+            return false;
+    return true;
+}
+
+/** @brief Counts failed expectations; a test's `main` returns non-zero when there are any. */
+inline int &TestFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+inline void Expect(bool ok, const std::string &what)
+{
+    if (ok)
+        return;
+    ++TestFailures();
+    std::cerr << "FAIL: " << what << std::endl;
+}
+
+#endif /* TESTGRAPHS_HPP_ */
@@ -0,0 +1,106 @@
+/**
+ * @file test_graph_kernel.cpp
+ * @brief `GraphKernel` is exact: lifting a maximum independent set of the reduced graph gives a maximum independent
+ * set of the input, found by brute force on small graphs; lifting a greedy set gives a maximal one.
+ */
+
+#include "GraphKernel.hpp"
+#include "TestGraphs.hpp"
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+// Size of a maximum independent set among the nodes of `candidates`, by branching on the lowest node; nodes and
+// neighbourhoods are bit masks, and `set` receives one such set
+int MaximumSet(const vector<uint32_t> &neighbours, uint32_t candidates, uint32_t &set)
+{
+    set = 0;
+    if (candidates == 0)
+        return 0;
+    const int v = __builtin_ctz(candidates);
+    const uint32_t without = candidates & ~(uint32_t(1) << v);
+    uint32_t takenSet;
+    const int taken = 1 + MaximumSet(neighbours, without & ~neighbours[v], takenSet);
+    if ((neighbours[v] & without) == 0)
+    {
+        set = takenSet | (uint32_t(1) << v);
+        return taken;
+    }
+    uint32_t skippedSet;
+    const int skipped = MaximumSet(neighbours, without, skippedSet);
+    set = skipped > taken ? skippedSet : takenSet | (uint32_t(1) << v);
+    return max(skipped, taken);
+}
+
+int MaximumSetSize(const TestGraph &graph)
+{
+    vector<uint32_t> neighbours(graph.nodeNum, 0);
+    for (const pair<int, int> &e : graph.edges)
+    {
+        neighbours[e.first] |= uint32_t(1) << e.second;
+        neighbours[e.second] |= uint32_t(1) << e.first;
+    }
+    uint32_t candidates = 0, set;
+    for (int u = 0; u < graph.nodeNum; ++u)
+        candidates |= graph.active[u] ? uint32_t(1) << u : 0;
+    return MaximumSet(neighbours, candidates, set);
+}
+
+// A maximum independent set of the reduced graph, in its node ids
+vector<int> MaximumSetOf(const AdjList &reduced)
+{
+    const int nodeNum = (int)reduced.NodeCount();
+    vector<uint32_t> neighbours(nodeNum, 0);
+    for (int u = 0; u < nodeNum; ++u)
+        reduced.ForEachActiveNeighbour(u, [&](int v) { neighbours[u] |= uint32_t(1) << v; });
+    uint32_t set;
+    MaximumSet(neighbours, nodeNum == 32 ? ~uint32_t(0) : (uint32_t(1) << nodeNum) - 1, set);
+    vector<int> nodes;
+    for (int u = 0; u < nodeNum; ++u)
+        if (set >> u & 1)
+            nodes.push_back(u);
+    return nodes;
+}
+
+int main()
+{
+    mt19937_64 rng(25);
+    int caseNum = 0;
+    size_t takenNum = 0, dominatedNum = 0, foldNum = 0;
+    for (int trial = 0; trial < 1000; ++trial)
+    {
+        const int nodeNum = 2 + (int)(rng() % 23);
+        const double density = (2 + (int)(rng() % 38)) / 100.0;
+        const TestGraph graph = RandomTestGraph(rng, nodeNum, density, trial % 3 == 0);
+        const int maximum = MaximumSetSize(graph);
+        for (const string &storage : TestStorages())
+        {
+            const string what = "trial " + to_string(trial) + " " + storage;
+            AdjList adjList;
+            BuildTestGraph(adjList, graph, storage);
+            GraphKernel kernel(adjList);
+            takenNum += kernel.TakenNum();
+            dominatedNum += kernel.DominatedNum();
+            foldNum += kernel.FoldNum();
+
+            const vector<int> exact = kernel.Lift(MaximumSetOf(kernel.Reduced()));
+            Expect(IsIndependent(graph, exact), what + ": lifted maximum set is not independent");
+            Expect((int)exact.size() == maximum, what + ": lifted " + to_string(exact.size()) + " nodes, maximum is " +
+                                                     to_string(maximum));
+
+            const vector<int> greedy = kernel.Lift(kernel.Reduced().GreedyPass(0));
+            Expect(IsIndependent(graph, greedy), what + ": lifted greedy set is not independent");
+            Expect(IsMaximal(graph, greedy), what + ": lifted greedy set is not maximal");
+            Expect(is_sorted(greedy.begin(), greedy.end()), what + ": lifted set is not ascending");
+            for (int u = 0; u < graph.nodeNum; ++u)
+                Expect(adjList.Active(u) == graph.active[u], what + ": the kernel changed the input graph");
+            ++caseNum;
+        }
+    }
+    // Every rule has to have been exercised for the cases above to mean anything
+    Expect(takenNum > 0 && dominatedNum > 0 && foldNum > 0, "a reduction rule never fired");
+    cout << "GraphKernel: " << caseNum << " cases (" << takenNum << " taken, " << dominatedNum << " dominated, "
+         << foldNum << " folded), " << TestFailures() << " failures" << endl;
+    return TestFailures() == 0 ? 0 : 1;
+}
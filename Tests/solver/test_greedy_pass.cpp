@@ -0,0 +1,56 @@
+/**
+ * @file test_greedy_pass.cpp
+ * @brief `AdjList::GreedyPass(0)` is the `FindMinDel` loop of the Codebook stage, node for node, on every storage; the
+ * other passes return maximal independent sets that only depend on the pass number.
+ */
+
+#include "TestGraphs.hpp"
+
+using namespace std;
+
+// The Codebook stage's sequential greedy: FindMinDel until the graph is empty, then the rows still remaining
+vector<int> FindMinDelLoop(AdjList &adjList, const TestGraph &graph)
+{
+    vector<bool> remaining = graph.active;
+    vector<int> nodes;
+    double minSumRowTime = 0.0, delBallTime = 0.0;
+    while (!adjList.empty())
+        nodes.push_back(adjList.FindMinDel(remaining, minSumRowTime, delBallTime));
+    for (int i = 0; i < graph.nodeNum; ++i)
+    {
+        if (remaining[i])
+            nodes.push_back(i);
+    }
+    return nodes;
+}
+
+int main()
+{
+    mt19937_64 rng(24);
+    int caseNum = 0;
+    for (int trial = 0; trial < 80; ++trial)
+    {
+        const int nodeNum = 2 + (int)(rng() % 400);
+        const double density = (1 + (int)(rng() % 40)) / 100.0;
+        const TestGraph graph = RandomTestGraph(rng, nodeNum, density, trial % 3 == 0);
+        for (const string &storage : TestStorages())
+        {
+            const string what = "trial " + to_string(trial) + " " + storage;
+            AdjList adjList;
+            BuildTestGraph(adjList, graph, storage);
+            const vector<int> plain = adjList.GreedyPass(0);
+            for (int pass = 1; pass <= 3; ++pass)
+            {
+                const vector<int> nodes = adjList.GreedyPass(pass);
+                Expect(IsIndependent(graph, nodes), what + " pass " + to_string(pass) + ": not independent");
+                Expect(IsMaximal(graph, nodes), what + " pass " + to_string(pass) + ": not maximal");
+                Expect(adjList.GreedyPass(pass) == nodes, what + " pass " + to_string(pass) + ": not repeatable");
+            }
+            // The passes leave the graph as it is, so the loop still starts from the degrees RowsBySum set
+            Expect(FindMinDelLoop(adjList, graph) == plain, what + ": pass 0 differs from the FindMinDel loop");
+            ++caseNum;
+        }
+    }
+    cout << "GreedyPass: " << caseNum << " cases, " << TestFailures() << " failures" << endl;
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file test_parallel_greedy.cpp
+ * @brief `AdjList::ParallelGreedy` returns a maximal independent set, and the same one for any thread count.
+ */
+
+#include "TestGraphs.hpp"
+
+using namespace std;
+
+int main()
+{
+    mt19937_64 rng(23);
+    int caseNum = 0;
+    for (int trial = 0; trial < 60; ++trial)
+    {
+        const int nodeNum = 20 + (int)(rng() % 400);
+        const double density = (1 + (int)(rng() % 30)) / 100.0;
+        const TestGraph graph = RandomTestGraph(rng, nodeNum, density, trial % 3 == 0);
+        for (const string &storage : TestStorages())
+        {
+            AdjList adjList;
+            BuildTestGraph(adjList, graph, storage);
+            for (double degreeWindow : {0.0, 0.25, 1.0})
+            {
+                const string what = "trial " + to_string(trial) + " " + storage + " window " + to_string(degreeWindow);
+                int roundNum = 0;
+                const vector<int> single = adjList.ParallelGreedy(1, degreeWindow, roundNum);
+                Expect(IsIndependent(graph, single), what + ": not independent");
+                Expect(IsMaximal(graph, single), what + ": not maximal");
+                for (int threadNum : {2, 4, 7})
+                {
+                    int threadedRounds = 0;
+                    Expect(adjList.ParallelGreedy(threadNum, degreeWindow, threadedRounds) == single &&
+                               threadedRounds == roundNum,
+                           what + ": " + to_string(threadNum) + " threads differ from one");
+                }
+                ++caseNum;
+            }
+        }
+    }
+    cout << "ParallelGreedy: " << caseNum << " cases, " << TestFailures() << " failures" << endl;
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -10,6 +10,7 @@
 #define CANDIDATEGENERATOR_HPP_
 
 #include "IndexGen.hpp"
+#include "PackedCandidates.hpp"
 #include <fstream>
 #include <memory>
 #include <string>
@@ -28,6 +29,13 @@ class CandidateGenerator
   protected:
     const Params &params; ///< Reference to the parameters structure
 
+    /**
+     * @brief Tests a single candidate against the GC-content and max run constraints.
+     * @param str The candidate string over '0'..'3'.
+     * @return `true` if the candidate passes all enabled filters.
+     */
+    bool passesFilters(const std::string &str) const;
+
   public:
     /**
      * @brief Constructor that stores a reference to the parameters.
@@ -83,6 +91,14 @@ class CandidateGenerator
      * @return A vector of filtered candidates based on GC-content and max run constraints.
      */
     virtual std::vector<std::string> applyFilters(const std::vector<std::string> &unfiltered) const;
+
+    /**
+     * @brief Generate and filter candidates directly into a packed set.
+     * @return The filtered candidates, packed two bits per symbol.
+     * @details The default implementation packs the result of `applyFilters(generate())`. Generators that can
+     *          enumerate their candidates one at a time override it so the text form is never materialized.
+     */
+    virtual PackedCandidateSet generatePacked();
 };
 
 /**
@@ -123,6 +139,7 @@ class LinearCodeGenerator : public CandidateGenerator
     LinearCodeGenerator(const Params &params, const LinearCodeConstraints &constraints);
 
     std::vector<std::string> generate() override;
+    PackedCandidateSet generatePacked() override;
     void printInfo(std::ostream &output_stream) const override;
     std::string getMethodName() const override;
     void printParams(std::ofstream &output_file) const override;
@@ -143,6 +160,7 @@ class AllStringsGenerator : public CandidateGenerator
     explicit AllStringsGenerator(const Params &params);
 
     std::vector<std::string> generate() override;
+    PackedCandidateSet generatePacked() override;
     void printInfo(std::ostream &output_stream) const override;
     std::string getMethodName() const override;
     void printParams(std::ofstream &output_file) const override;
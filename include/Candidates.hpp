@@ -13,6 +13,8 @@
 #define CANDIDATES_HPP_
 
 #include "IndexGen.hpp"
+#include "PackedCandidates.hpp"
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -28,9 +30,70 @@ using namespace std;
  *
  * @param params A struct containing all the necessary parameters, including code length,
  * minimum Hamming distance, GC-content bounds, and max run length.
- * @return A vector of strings representing the filtered candidates.
+ * @return The filtered candidates, packed two bits per symbol.
  */
-vector<string> Candidates(const Params &params);
+PackedCandidateSet Candidates(const Params &params);
+
+/**
+ * @struct ConstraintSignature
+ * @brief What the biological filters read from one candidate: its GC count (its count of 1s for binary codes) and
+ * its longest homopolymer run.
+ */
+struct ConstraintSignature
+{
+    uint16_t content;
+    uint16_t maxRun;
+
+    /**
+     * @brief Whether the candidate passes the given filters, with the conventions (and the exact comparisons) of the
+     * generators' own filtering: a run limit of 0 and a GC range of (0, 0) disable their filter.
+     */
+    bool Passes(int codeLen, int maxRunLimit, double minCont, double maxCont) const
+    {
+        if (maxRunLimit > 0 && maxRun > maxRunLimit)
+            return false;
+        if (minCont > 0 || maxCont > 0)
+        {
+            const double cont = double(content) / double(codeLen);
+            return cont >= minCont && cont <= maxCont;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Computes the constraint signature of every candidate.
+ * @param binary Count 1s instead of Gs and Cs, as the binary generators do.
+ */
+vector<ConstraintSignature> ConstraintSignatures(const PackedCandidateSet &candidates, bool binary);
+
+/**
+ * @struct FilterCell
+ * @brief One filter setting of a filter sweep.
+ */
+struct FilterCell
+{
+    int maxRun;
+    double minGCCont;
+    double maxGCCont;
+
+    /** @brief The cell's name, e.g. "GC0.3-0.7-RUN3" (the naming of the Codebooks/ directory). */
+    string Label() const;
+};
+
+/**
+ * @brief The filter cells of a sweep: every GC range of `params.gcSweep` with every run limit of
+ * `params.maxRunSweep`; an empty list stands for the single value in `params`.
+ * @return Empty when neither list is set (no sweep).
+ */
+vector<FilterCell> FilterCells(const Params &params);
+
+/**
+ * @brief Generates the candidates of `params` with the biological filters disabled, for a filter sweep.
+ * @details The generators filter while they enumerate, so a cell's filtered candidates are exactly the unfiltered
+ * ones passing its filters, in the same order.
+ */
+PackedCandidateSet UnfilteredCandidates(Params &params);
 
 /**
  * @brief A test function to verify the properties of a generated linear code.
@@ -13,6 +13,7 @@
 #ifndef LINEARCODES_HPP_
 #define LINEARCODES_HPP_
 
+#include <functional>
 #include <vector>
 #include <string> // For std::string usage if needed, though not directly in this function signature.
 
@@ -40,6 +41,22 @@ using namespace std;
 vector<vector<int>> CodedVecs(const int n, const int minHammDist, const vector<int> &bias, const vector<int> &row_perm,
                               const vector<int> &col_perm);
 
+/**
+ * @brief Streams the same codewords as `CodedVecs`, in the same order, without materializing the code.
+ *
+ * The raw data vectors are enumerated in place and each encoded codeword is handed to `visit` as soon as it is
+ * produced, so memory stays O(n) instead of O(4^k * n). Used by the packed candidate path.
+ *
+ * @param n The desired length of the output codewords.
+ * @param minHammDist The desired minimum Hamming distance (2-5).
+ * @param bias The bias vector to add to each codeword (empty for none).
+ * @param row_perm The row permutation vector for the generator matrix.
+ * @param col_perm The column permutation vector for the generator matrix.
+ * @param visit Called once per codeword with a vector of length `n` over {0, 1, 2, 3}.
+ */
+void ForEachCodedVec(const int n, const int minHammDist, const vector<int> &bias, const vector<int> &row_perm,
+                     const vector<int> &col_perm, const function<void(const vector<int> &)> &visit);
+
 /**
  * @brief Generates codewords with default parameters (backward compatibility).
  *
@@ -0,0 +1,435 @@
+/**
+ * @file ConflictJoins.hpp
+ * @brief Index structures for building the conflict graph without comparing every pair of candidates.
+ *
+ * The all-pairs scan in SparseMat.cpp costs O(N^2) edit-distance tests. For small edit distances it is cheaper to
+ * enumerate, for every candidate, the strings that would conflict with it and look them up in an index of the
+ * candidate set, or to only test the pairs that share an exact segment. The classes here provide those building
+ * blocks; SparseMat.cpp owns the threading, checkpointing and the fallback to all-pairs.
+ */
+
+#ifndef CONFLICTJOINS_HPP_
+#define CONFLICTJOINS_HPP_
+
+#include "PackedCandidates.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 2 if every candidate only uses the symbols 0 and 1 (binary codes), otherwise 4.
+ */
+int PackedAlphabetSize(const PackedCandidateSet &candidates);
+
+// -------------------- Exact-match index --------------------
+
+/**
+ * @class PackedWordIndex
+ * @brief Open-addressing hash table from single-word packed candidates to their indices.
+ * @details Duplicate candidates are chained through `next`, so a lookup reports every index holding the word. For
+ * short codewords (4^len bits <= kMaxPresenceBytes) a direct-address presence bitmap answers most lookups, which
+ * for ball enumeration are misses, without touching the hash table.
+ * Only candidates shorter than 32 symbols can be indexed (a full word is reserved as the empty-slot marker).
+ */
+class PackedWordIndex
+{
+  private:
+    static constexpr uint64_t kEmpty = ~0ULL; // never a valid word below 32 symbols
+
+    struct Slot
+    {
+        uint64_t key = kEmpty;
+        int head = -1; // first candidate index holding key
+    };
+
+    std::vector<Slot> slots;
+    std::vector<int> next;          // next candidate index with the same word, or -1
+    std::vector<uint64_t> presence; // bit w set iff some candidate equals w; empty when too large
+    uint64_t slotMask;
+
+    static uint64_t Hash(uint64_t word)
+    {
+        word ^= word >> 33;
+        word *= 0xff51afd7ed558ccdULL;
+        word ^= word >> 33;
+        return word;
+    }
+
+  public:
+    static constexpr size_t kMaxPresenceBytes = size_t(32) << 20;
+
+    /** @brief Indexes every candidate of `candidates`. Throws `std::invalid_argument` for lengths >= 32. */
+    explicit PackedWordIndex(const PackedCandidateSet &candidates);
+
+    /** @brief Hints the cache about the slot `word` hashes to, ahead of a `ForEachMatch` on it. */
+    void Prefetch(uint64_t word) const
+    {
+        if (!presence.empty())
+            __builtin_prefetch(&presence[word >> 6]);
+        else
+            __builtin_prefetch(&slots[Hash(word) & slotMask]);
+    }
+
+    /** @brief Calls f(index) for every candidate equal to `word`, in increasing index order. */
+    template <typename F>
+    void ForEachMatch(uint64_t word, F &&f) const
+    {
+        if (!presence.empty() && !((presence[word >> 6] >> (word & 63)) & 1ULL))
+            return;
+        for (uint64_t slot = Hash(word) & slotMask; slots[slot].key != kEmpty; slot = (slot + 1) & slotMask)
+        {
+            if (slots[slot].key == word)
+            {
+                for (int i = slots[slot].head; i >= 0; i = next[i])
+                    f(i);
+                return;
+            }
+        }
+    }
+};
+
+// -------------------- Edit-ball enumeration --------------------
+
+/**
+ * @class EditBallEnumerator
+ * @brief Enumerates the fixed-length strings within a given edit distance of a packed single-word string.
+ * @details Walks the source left to right and, at each position, matches, substitutes, deletes or inserts, like the
+ * rows of an alignment with at most `radius` edits; every alignment that ends at length `len` is reported. Branches
+ * that can no longer end at `len` are pruned, and a few local rules drop redundant alignments (no insertion next to a
+ * deletion, which a substitution already covers; no insertion of the symbol that follows, which matching first
+ * covers). Some strings are still reached by more than one alignment, so callers deduplicate what they find.
+ */
+class EditBallEnumerator
+{
+  private:
+    int len;
+    int radius;
+    int alphabet;
+
+    enum LastOp
+    {
+        kMatch,
+        kInsert,
+        kDelete
+    };
+
+    // pos: next source symbol; out/outLen: the output built so far; edits: edits spent.
+    template <typename F>
+    void Expand(uint64_t src, int pos, uint64_t out, int outLen, int edits, LastOp last, F &visit) const
+    {
+        const int left = radius - edits;
+        // Length the output ends at if the rest is matched; the remaining edits must close the gap
+        const int gap = outLen + (len - pos) - len;
+        if (gap > left || -gap > left)
+            return;
+        if (left == 0)
+        {
+            // No edits left: the rest of the source is copied as is
+            visit(out | ((src >> (2 * pos)) << (2 * outLen)));
+            return;
+        }
+
+        if (pos == len)
+        {
+            if (outLen == len)
+                visit(out);
+        }
+        else
+        {
+            const uint64_t cur = (src >> (2 * pos)) & 3ULL;
+            Expand(src, pos + 1, out | (cur << (2 * outLen)), outLen + 1, edits, kMatch, visit);
+            for (uint64_t s = 0; s < (uint64_t)alphabet; ++s)
+            {
+                if (s != cur)
+                    Expand(src, pos + 1, out | (s << (2 * outLen)), outLen + 1, edits + 1, kMatch, visit);
+            }
+            if (last != kInsert)
+                Expand(src, pos + 1, out, outLen, edits + 1, kDelete, visit);
+        }
+
+        if (last != kDelete)
+        {
+            const uint64_t nextSym = (pos < len) ? ((src >> (2 * pos)) & 3ULL) : 4;
+            for (uint64_t s = 0; s < (uint64_t)alphabet; ++s)
+            {
+                if (s != nextSym)
+                    Expand(src, pos, out | (s << (2 * outLen)), outLen + 1, edits + 1, kInsert, visit);
+            }
+        }
+    }
+
+  public:
+    /**
+     * @param len The length of the strings (and of every reported neighbour).
+     * @param radius The maximal edit distance (minED - 1 for conflict enumeration).
+     * @param alphabet 2 or 4.
+     */
+    EditBallEnumerator(int len, int radius, int alphabet) : len(len), radius(radius), alphabet(alphabet)
+    {
+    }
+
+    /** @brief Whether packed words of this length plus `radius` insertions still fit one 64-bit word. */
+    static bool Applicable(int len, int radius)
+    {
+        return len > 0 && radius >= 0 && len + radius <= 31;
+    }
+
+    /** @brief Calls visit(neighbour) for every length-`len` word within `radius` edits of `word` (with repeats). */
+    template <typename F>
+    void ForEach(uint64_t word, F &&visit) const
+    {
+        Expand(word, 0, 0ULL, 0, 0, kMatch, visit);
+    }
+
+    /** @brief Number of distinct strings in the ball around `word`. */
+    size_t DistinctSize(uint64_t word) const;
+};
+
+// -------------------- Pigeonhole segment index --------------------
+
+/**
+ * @class SegmentIndex
+ * @brief PASS-JOIN style partition index: finds every candidate that may lie within `segments - 1` edits of a string.
+ * @details Each candidate is cut into `segments` = tau + 1 contiguous segments (the last `len % segments` one symbol
+ * longer), and every segment position has an inverted list from segment content to the candidates holding it. If
+ * ED(x, y) <= tau, some segment of y is untouched by the alignment and occurs in x shifted by the insertions minus
+ * deletions in front of it. For equal lengths that shift is bounded by the edits on either side of the segment, so by
+ * floor(tau / 2); taking the first untouched segment s, the s segments in front each hold an edit, which bounds it by
+ * tau - s as well. Probing x's substrings at those shifts reports every y within tau edits, plus false positives the
+ * caller verifies.
+ * Lists keep each candidate's word next to its index, so a query reads them sequentially, and a candidate is only
+ * reported for the first (segment, shift) it matches at, which is checked on the two words without any lookup.
+ */
+class SegmentIndex
+{
+  private:
+    struct Segment
+    {
+        int start;                    // first symbol
+        int maxShift;                 // min(tau / 2, tau - s)
+        uint64_t mask;                // low 2 * length bits
+        std::vector<uint64_t> keys;   // distinct contents, sorted; empty when `offset` is indexed by content
+        std::vector<uint32_t> offset; // list of keys[k] (or of content k) is [offset[k], offset[k + 1])
+        std::vector<int> ids;         // candidate indices, increasing within each list
+        std::vector<uint64_t> words;  // ids[k]'s packed word
+        int first;                    // lowest probed position
+        int last;                     // highest probed position
+    };
+
+    int len;
+    std::vector<Segment> segments;
+
+    // One (segment, position) probe of a query: the query's content there and where the segment sits in a candidate
+    struct Probe
+    {
+        uint64_t content;
+        uint64_t mask;
+        int segStart;
+    };
+
+    // Whether candidate word y also matches one of the first `count` probes (branch-free, the lists are short)
+    static bool MatchedEarlier(const Probe *probes, int count, uint64_t y)
+    {
+        bool hit = false;
+        for (int r = 0; r < count; ++r)
+            hit |= ((y >> (2 * probes[r].segStart)) & probes[r].mask) == probes[r].content;
+        return hit;
+    }
+
+  public:
+    /** @brief Content tables up to this many entries are addressed directly; longer segments are binary searched. */
+    static constexpr size_t kMaxDirectKeys = size_t(1) << 20;
+
+    /** @brief Bound on the probes of one query; a segment is probed at most `segments` times. */
+    static constexpr int kMaxProbes = 64;
+
+    /**
+     * @param candidates Single-word candidates; `Applicable(candidates.Length(), segments)` must hold.
+     * @param segments Number of segments: minED for conflict search.
+     */
+    SegmentIndex(const PackedCandidateSet &candidates, int segments);
+
+    /** @brief Whether single-word candidates of this length can be split into `segments` non-empty segments. */
+    static bool Applicable(int len, int segments)
+    {
+        return segments > 0 && segments * segments <= kMaxProbes && len >= segments &&
+               len <= PackedCandidateSet::kSymbolsPerWord;
+    }
+
+    /** @brief Number of list lookups per query. */
+    int ProbesPerQuery() const;
+
+    /**
+     * @brief Expected share of a uniformly random candidate set that a query reports.
+     * @param alphabet 2 or 4.
+     */
+    double ExpectedHitFraction(int alphabet) const;
+
+    /**
+     * @brief Calls f(index, word) once for every candidate with index >= minIndex that shares a segment with `word`
+     * at a compatible shift.
+     */
+    template <typename F>
+    void ForEachCandidate(uint64_t word, int minIndex, F &&f) const
+    {
+        Probe probes[kMaxProbes];
+        int probeNum = 0;
+        for (size_t s = 0; s < segments.size(); ++s)
+        {
+            const Segment &seg = segments[s];
+            for (int p = seg.first; p <= seg.last; ++p)
+            {
+                const uint64_t content = (word >> (2 * p)) & seg.mask;
+                const int earlier = probeNum;
+                probes[probeNum++] = Probe{content, seg.mask, seg.start};
+                size_t k;
+                if (seg.keys.empty())
+                    k = (size_t)content;
+                else
+                {
+                    k = (size_t)(std::lower_bound(seg.keys.begin(), seg.keys.end(), content) - seg.keys.begin());
+                    if (k == seg.keys.size() || seg.keys[k] != content)
+                        continue;
+                }
+                const int *begin = seg.ids.data() + seg.offset[k];
+                const int *end = seg.ids.data() + seg.offset[k + 1];
+                for (const int *it = std::lower_bound(begin, end, minIndex); it != end; ++it)
+                {
+                    const uint64_t other = seg.words[it - seg.ids.data()];
+                    if (!MatchedEarlier(probes, earlier, other))
+                        f(*it, other);
+                }
+            }
+        }
+    }
+};
+
+// -------------------- Symmetric-deletion index --------------------
+
+/**
+ * @class DeletionIndex
+ * @brief Symmetric-deletion join (SymSpell style): maps every string obtained by deleting `depth` symbols from a
+ * candidate to the candidates it came from.
+ * @details For equal-length x, y with ED(x, y) <= depth, an alignment with s substitutions and i insertion/deletion
+ * pairs has s + 2i <= depth edits; deleting the substituted symbols plus the i unmatched ones on each side, and then
+ * as many further matched symbols from both, leaves the same string of length len - depth. So every conflicting pair
+ * shares a depth-`depth` deletion variant; pairs that share one may still be compatible and are verified by the caller.
+ * The (variant, candidate) entries are packed into one word each and radix sorted into an inverted list per distinct
+ * variant, which an open-addressing table locates.
+ */
+class DeletionIndex
+{
+  private:
+    static constexpr uint64_t kEmpty = ~0ULL; // never a valid variant (at most 31 symbols)
+
+    struct Slot
+    {
+        uint64_t key = kEmpty;
+        uint32_t list = 0; // index into offset
+    };
+
+    int len;
+    int depth;
+    std::vector<Slot> slots;
+    uint64_t slotMask = 0;
+    std::vector<uint32_t> offset; // list k is ids[offset[k], offset[k + 1])
+    std::vector<int> ids;         // candidate indices, increasing within each list
+
+    static uint64_t Hash(uint64_t word)
+    {
+        word ^= word >> 33;
+        word *= 0xff51afd7ed558ccdULL;
+        word ^= word >> 33;
+        return word;
+    }
+
+    // Deletes `left` more symbols below position `below`, highest first, so lower positions do not move
+    template <typename F>
+    static void Delete(uint64_t word, int below, int left, F &visit)
+    {
+        if (left == 0)
+        {
+            visit(word);
+            return;
+        }
+        for (int p = below - 1; p >= left - 1; --p)
+        {
+            const uint64_t low = (1ULL << (2 * p)) - 1;
+            Delete((word & low) | ((word >> 2) & ~low), p, left - 1, visit);
+        }
+    }
+
+  public:
+    /** @brief Bound on the memory the (variant, candidate) entries may take while the index is built. */
+    static constexpr size_t kMaxBuildBytes = size_t(1) << 30;
+
+    /** @brief Bytes per (variant, candidate) entry while the index is built (the entries and the sort buffer). */
+    static constexpr size_t kBuildBytesPerEntry = 2 * sizeof(uint64_t);
+
+    /** @brief Bits needed for the indices of `candNum` candidates. */
+    static int IndexBits(size_t candNum);
+
+    /**
+     * @param candidates Single-word candidates; `Applicable(candidates.Length(), depth, candidates.size())` must hold.
+     * @param depth Number of deleted symbols: minED - 1 for conflict search.
+     * @param threadNum Threads that enumerate the variants.
+     */
+    DeletionIndex(const PackedCandidateSet &candidates, int depth, int threadNum);
+
+    /**
+     * @brief Whether `candNum` candidates of this length keep at least one symbol after `depth` deletions and a
+     * variant plus a candidate index fit one 64-bit entry.
+     */
+    static bool Applicable(int len, int depth, size_t candNum)
+    {
+        return depth >= 0 && len > depth && len < PackedCandidateSet::kSymbolsPerWord &&
+               2 * (len - depth) + IndexBits(candNum) <= 64;
+    }
+
+    /** @brief Upper bound on the variants of one candidate: len choose depth. */
+    static size_t MaxVariants(int len, int depth);
+
+    /**
+     * @brief Writes the distinct depth-`depth` deletion variants of a length-`len` word into `out`.
+     * @param out Reused buffer; it is cleared first.
+     */
+    static void Variants(uint64_t word, int len, int depth, std::vector<uint64_t> &out);
+
+    /** @brief Number of distinct variants in the index. */
+    size_t VariantCount() const
+    {
+        return offset.empty() ? 0 : offset.size() - 1;
+    }
+
+    /** @brief Number of (variant, candidate) entries in the index. */
+    size_t EntryCount() const
+    {
+        return ids.size();
+    }
+
+    /** @brief Hints the cache about the slot `variant` hashes to, ahead of a `ForEachHolder` on it. */
+    void Prefetch(uint64_t variant) const
+    {
+        __builtin_prefetch(&slots[Hash(variant) & slotMask]);
+    }
+
+    /** @brief Calls f(index) for every candidate with index >= minIndex that has `variant` among its variants. */
+    template <typename F>
+    void ForEachHolder(uint64_t variant, int minIndex, F &&f) const
+    {
+        for (uint64_t slot = Hash(variant) & slotMask; slots[slot].key != kEmpty; slot = (slot + 1) & slotMask)
+        {
+            if (slots[slot].key == variant)
+            {
+                const int *begin = ids.data() + offset[slots[slot].list];
+                const int *end = ids.data() + offset[slots[slot].list + 1];
+                for (const int *it = std::lower_bound(begin, end, minIndex); it != end; ++it)
+                    f(*it);
+                return;
+            }
+        }
+    }
+};
+
+#endif /* CONFLICTJOINS_HPP_ */
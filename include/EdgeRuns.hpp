@@ -0,0 +1,95 @@
+/**
+ * @file EdgeRuns.hpp
+ * @brief External-memory construction of the conflict graph: sorted edge runs on disk, merged into a CSR file.
+ *
+ * When the edge set does not fit in RAM, the graph builders hand their pair buffers to an `EdgeRunWriter` whenever
+ * they reach the memory budget. Each spill is written as one sorted run holding both directions of every edge.
+ * `MergeEdgeRuns` then k-way merges the runs into a CSR file that `AdjList::MapFile` maps read-only, so the neighbour
+ * lists live in the page cache and only the per-node greedy state stays in RAM.
+ */
+
+#ifndef EDGERUNS_HPP_
+#define EDGERUNS_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct CsrFileHeader
+ * @brief Header of a CSR graph file, followed by `nodeNum + 1` uint64 offsets and `entryNum` int32 neighbours.
+ * @details Node i's neighbours, sorted ascending, are entries offsets[i] .. offsets[i + 1] - 1.
+ */
+struct CsrFileHeader
+{
+    static constexpr char kMagic[4] = {'I', 'G', 'C', 'S'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[4];
+    uint32_t version;
+    uint64_t nodeNum;
+    uint64_t entryNum;
+};
+
+/**
+ * @class EdgeRunWriter
+ * @brief Spills pair buffers to sorted run files named `<prefix>_<k>.bin` (in the working directory unless the prefix
+ * names one).
+ * @details A run is the sorted, deduplicated uint64 keys (u << 32 | v) of both directions of every spilled pair.
+ * Runs are written aside and renamed into place, so a run file is always complete. `Spill` may be called from
+ * several threads at once.
+ */
+class EdgeRunWriter
+{
+  private:
+    std::string prefix;
+    size_t spillPairs; // pairs per thread buffer that trigger a spill
+    std::atomic<int> nextRun;
+    std::mutex runsMutex;
+    std::vector<std::string> runs;
+
+  public:
+    /**
+     * @brief Sets up the writer for `threadNum` buffers sharing `budgetBytes`.
+     * @param resume Keep the runs a previous attempt left under `prefix` (they are part of the graph); otherwise they
+     * are deleted.
+     */
+    EdgeRunWriter(const std::string &prefix, size_t budgetBytes, int threadNum, bool resume);
+
+    /** @brief The number of pairs in one thread's share of the budget. */
+    size_t SpillPairs() const
+    {
+        return spillPairs;
+    }
+
+    /** @brief Whether a thread's buffer has reached its share of the budget. */
+    bool Full(const std::vector<std::pair<int, int>> &pairs) const
+    {
+        return pairs.size() >= spillPairs;
+    }
+
+    /** @brief Writes `pairs` as one run and empties the buffer (keeping its capacity). */
+    void Spill(std::vector<std::pair<int, int>> &pairs);
+
+    /** @brief Every run written so far, including the ones found on resume. */
+    std::vector<std::string> Runs();
+};
+
+/**
+ * @brief Merges sorted runs into a CSR file for `nodeNum` nodes and deletes the runs.
+ * @details Keys naming a node outside the graph and repeated keys are dropped. More runs than one merge can keep open
+ * are first merged in groups into intermediate runs, which take as much disk again as the input runs. The CSR file is
+ * written aside and renamed into place, and the input runs are deleted only after that, so a build interrupted
+ * anywhere in the merge still finds all its runs on resume.
+ * @param budgetBytes Memory for the read buffers.
+ * @param keepRuns Leave the input runs in place (the intermediate runs are still deleted).
+ * @return The number of entries written.
+ */
+size_t MergeEdgeRuns(std::vector<std::string> runs, size_t nodeNum, const std::string &csrFile, size_t budgetBytes,
+                     bool keepRuns = false);
+
+#endif /* EDGERUNS_HPP_ */
@@ -4,7 +4,11 @@
 #include <cstdint>
 #include <numeric>
 #include <string>
+#include <type_traits>
 #include <vector>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 
 // -------------------- Reusable precompute --------------------
 struct PeqIndex
@@ -46,6 +50,7 @@ struct PatternHandle
     uint64_t lastMask = ~0ULL; // mask for last block (exact Myers)
     uint64_t highestBit = 0;   // 1ULL << ((m-1) & 63)
     int highestShift = 0;      // ((m-1) & 63) — for branchless bit extraction
+    bool dna4 = false;         // pattern uses only '0'..'3' (enables the batched kernel)
 
     PatternHandle() = default;
     explicit PatternHandle(const std::string &p)
@@ -59,6 +64,7 @@ struct PatternHandle
         peq.build(p);
         m = peq.m;
         B = peq.B;
+        dna4 = std::all_of(p.begin(), p.end(), [](char ch) { return ch >= '0' && ch <= '3'; });
         if (m == 0)
         {
             lastMask = ~0ULL;
@@ -369,4 +375,276 @@ inline bool EditDistanceBandedAtLeast(const std::string &text, const PatternHand
 {
     int ed = EditDistanceBanded(text, H, minED - 1); // compute up to minED - 1
     return ed >= minED;
-}
\ No newline at end of file
+}
+// -------------------- Inter-sequence SIMD Myers (one pattern, many texts) --------------------
+// Every vector lane carries the Myers state of a different text; all lanes advance in lockstep against the same
+// pattern. The lane width follows the pattern length (16/32/64 bits), so a 256-bit register holds 16/8/4 texts and a
+// 512-bit register 32/16/8. The default build emits SSE2 for these vectors; AVX2/AVX-512 needs the opt-in
+// ARCH_FLAGS=-march=native (see the Makefile).
+#if defined(__AVX512BW__)
+constexpr int kBatchBytes = 64;
+#else
+constexpr int kBatchBytes = 32;
+#endif
+
+// Number of texts a single batched call can take for this pattern; 0 if the batched kernel does not apply.
+inline int BatchLanes(const PatternHandle &H)
+{
+    if (!H.dna4 || H.m == 0 || H.m > 64)
+        return 0;
+    if (H.m <= 16)
+        return kBatchBytes / 2;
+    if (H.m <= 32)
+        return kBatchBytes / 4;
+    return kBatchBytes / 8;
+}
+
+// Bit l of the result is set iff ED(text_l, pattern) < minED for count texts of length n. symbolAt(l, j) returns the
+// j-th symbol of text l as 0..3 (anything else never matches); the pattern is guaranteed to be over '0'..'3'.
+template <typename Lane, typename SymbolAt>
+inline uint64_t MyersBatchConflictMask(const PatternHandle &H, int n, int count, int minED, SymbolAt &&symbolAt)
+{
+    typedef Lane V __attribute__((vector_size(kBatchBytes)));
+    constexpr int L = kBatchBytes / (int)sizeof(Lane);
+    assert(count > 0 && count <= L);
+
+    // Pad unused lanes with the last text; their results are masked out below.
+    int lane[L];
+    for (int l = 0; l < L; ++l)
+        lane[l] = (l < count) ? l : count - 1;
+
+    const int top = H.highestShift;
+
+    V P0 = V{} + (Lane)H.peq.blocks('0')[0];
+    V P1 = V{} + (Lane)H.peq.blocks('1')[0];
+    V P2 = V{} + (Lane)H.peq.blocks('2')[0];
+    V P3 = V{} + (Lane)H.peq.blocks('3')[0];
+
+    V PV = ~V{}, MV = V{};
+    V score = V{} + (Lane)H.m;
+
+    for (int j = 0; j < n; ++j)
+    {
+        V sym = V{};
+        for (int l = 0; l < L; ++l)
+            sym[l] = (Lane)symbolAt(lane[l], j);
+
+        V Eq = ((V)(sym == 0) & P0) | ((V)(sym == 1) & P1) | ((V)(sym == 2) & P2) | ((V)(sym == 3) & P3);
+
+        V X = Eq | MV;
+        V D0 = (((X & PV) + PV) ^ PV) | X;
+        V HN = PV & D0;
+        V HP = MV | ~(PV | D0);
+
+        V X2 = (HP << 1) | 1;
+        MV = X2 & D0;
+        PV = (HN << 1) | ~(X2 | D0);
+
+        score += ((HP >> top) & 1);
+        score -= ((HN >> top) & 1);
+
+        // Each remaining column moves the score by at most one: stop once no lane can drop below minED.
+        V alive = (V)(score < (Lane)(minED + (n - 1 - j)));
+        Lane any = 0;
+        for (int l = 0; l < L; ++l)
+            any |= alive[l];
+        if (!any)
+            return 0;
+    }
+
+    uint64_t mask = 0;
+    for (int l = 0; l < count; ++l)
+        mask |= (uint64_t)(score[l] < (Lane)minED) << l;
+    return mask;
+}
+
+// Dispatches the batched kernel on the lane width matching the pattern length. Requires BatchLanes(H) >= count.
+template <typename SymbolAt>
+inline uint64_t MyersBatchConflictMask(const PatternHandle &H, int n, int count, int minED, SymbolAt &&symbolAt)
+{
+    if (H.m <= 16)
+        return MyersBatchConflictMask<uint16_t>(H, n, count, minED, symbolAt);
+    if (H.m <= 32)
+        return MyersBatchConflictMask<uint32_t>(H, n, count, minED, symbolAt);
+    return MyersBatchConflictMask<uint64_t>(H, n, count, minED, symbolAt);
+}
+
+// Batched conflict test: bit l is set iff ED(*texts[l], H) < minED. Falls back to the banded scalar kernel when the
+// batch kernel does not apply (pattern outside '0'..'3', m > 64, or mixed text lengths).
+inline uint64_t EditDistanceBatchConflictMask(const PatternHandle &H, const std::string *const *texts, int count,
+                                              int minED)
+{
+    assert(count > 0 && count <= 64);
+    const int lanes = BatchLanes(H);
+    bool uniform = (lanes > 0 && count <= lanes);
+    for (int l = 1; uniform && l < count; ++l)
+        uniform = (texts[l]->size() == texts[0]->size());
+
+    if (!uniform)
+    {
+        uint64_t mask = 0;
+        for (int l = 0; l < count; ++l)
+            mask |= (uint64_t)(!EditDistanceBandedAtLeast(*texts[l], H, minED)) << l;
+        return mask;
+    }
+    return MyersBatchConflictMask(H, (int)texts[0]->size(), count, minED,
+                                  [texts](int l, int j) { return (unsigned char)(*texts[l])[j] - (unsigned char)'0'; });
+}
+
+// Calls onConflict(j) in increasing order for every j in [first, last) with ED(texts[j], H) < minED.
+template <typename F>
+inline void ForEachConflict(const PatternHandle &H, const std::vector<std::string> &texts, size_t first, size_t last,
+                            int minED, F &&onConflict)
+{
+    const size_t lanes = (size_t)std::max(1, BatchLanes(H));
+    const std::string *batch[64];
+    for (size_t j = first; j < last; j += lanes)
+    {
+        const int count = (int)std::min(lanes, last - j);
+        for (int l = 0; l < count; ++l)
+            batch[l] = &texts[j + l];
+        uint64_t mask = EditDistanceBatchConflictMask(H, batch, count, minED);
+        while (mask)
+        {
+            onConflict(j + (size_t)__builtin_ctzll(mask));
+            mask &= mask - 1;
+        }
+    }
+}
+
+// -------------------- Compact 4-symbol Peq and fixed-length kernels (packed candidates) --------------------
+// Packed layout: 2 bits per symbol, 32 symbols per 64-bit word, symbol p in bits 2(p%32)..2(p%32)+1 of word p/32.
+// Only '0'..'3' ever occur, so the Peq collapses from a 256 x B table to four words built with a few bit operations.
+struct Peq4
+{
+    uint64_t eq[4] = {0, 0, 0, 0}; // bit p of eq[s] set iff pattern[p] == s
+};
+
+// Gathers the even bits of x (bit 2i -> bit i) into the low 32 bits.
+inline uint64_t CompressEvenBits(uint64_t x)
+{
+#if defined(__BMI2__)
+    return _pext_u64(x, 0x5555555555555555ULL);
+#else
+    x &= 0x5555555555555555ULL;
+    x = (x | (x >> 1)) & 0x3333333333333333ULL;
+    x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+    return x;
+#endif
+}
+
+// Builds the Peq of a packed pattern of length m <= 64 (one or two words).
+inline Peq4 MakePeq4(const uint64_t *words, int m)
+{
+    assert(m > 0 && m <= 64);
+    Peq4 P;
+    for (int w = 0; w * 32 < m; ++w)
+    {
+        const uint64_t lo = CompressEvenBits(words[w]);
+        const uint64_t hi = CompressEvenBits(words[w] >> 1);
+        const int used = std::min(32, m - w * 32);
+        const uint64_t valid = (used == 32) ? 0xFFFFFFFFULL : ((1ULL << used) - 1ULL);
+        P.eq[0] |= (~lo & ~hi & valid) << (32 * w);
+        P.eq[1] |= (lo & ~hi & valid) << (32 * w);
+        P.eq[2] |= (~lo & hi & valid) << (32 * w);
+        P.eq[3] |= (lo & hi & valid) << (32 * w);
+    }
+    return P;
+}
+
+// Narrowest lane that holds an N-bit Myers column.
+template <int N>
+using FixedLane = typename std::conditional<(N <= 16), uint16_t, uint32_t>::type;
+
+// Batched conflict test for single-word packed candidates of compile-time length N (pattern and texts alike): bit l of
+// the result is set iff ED(text_l, pattern) < minED. With N known the column loop fully unrolls and the top-bit shift
+// and early-exit bounds become immediates. Each text is split once into its low and high symbol-bit planes, so a column
+// costs a few lane-wide selects instead of a per-lane symbol gather.
+template <int N>
+inline uint64_t MyersBatchConflictMaskN(const Peq4 &P, const uint64_t *const *texts, int count, int minED)
+{
+    static_assert(N >= 1 && N <= 32, "fixed-length kernel covers single-word packed candidates");
+    using Lane = FixedLane<N>;
+    typedef Lane V __attribute__((vector_size(kBatchBytes)));
+    constexpr int L = kBatchBytes / (int)sizeof(Lane);
+    assert(count > 0 && count <= L);
+
+    // Pad unused lanes with the last text; their results are masked out below.
+    V lo = V{}, hi = V{};
+    for (int l = 0; l < L; ++l)
+    {
+        const uint64_t word = texts[(l < count) ? l : count - 1][0];
+        lo[l] = (Lane)CompressEvenBits(word);
+        hi[l] = (Lane)CompressEvenBits(word >> 1);
+    }
+
+    // Eq = hi ? (lo ? P3 : P2) : (lo ? P1 : P0), written as xor-selects on the broadcast Peq words.
+    const V P0 = V{} + (Lane)P.eq[0];
+    const V P2 = V{} + (Lane)P.eq[2];
+    const V P01 = V{} + (Lane)(P.eq[0] ^ P.eq[1]);
+    const V P23 = V{} + (Lane)(P.eq[2] ^ P.eq[3]);
+
+    V PV = ~V{}, MV = V{};
+    V score = V{} + (Lane)N;
+
+#pragma GCC unroll 32
+    for (int j = 0; j < N; ++j)
+    {
+        const V loMask = V{} - ((lo >> j) & 1);
+        const V hiMask = V{} - ((hi >> j) & 1);
+        const V A = P0 ^ (P01 & loMask);
+        const V B = P2 ^ (P23 & loMask);
+        V Eq = A ^ ((A ^ B) & hiMask);
+
+        V X = Eq | MV;
+        V D0 = (((X & PV) + PV) ^ PV) | X;
+        V HN = PV & D0;
+        V HP = MV | ~(PV | D0);
+
+        V X2 = (HP << 1) | 1;
+        MV = X2 & D0;
+        PV = (HN << 1) | ~(X2 | D0);
+
+        score += ((HP >> (N - 1)) & 1);
+        score -= ((HN >> (N - 1)) & 1);
+
+        V alive = (V)(score < (Lane)(minED + (N - 1 - j)));
+        Lane any = 0;
+        for (int l = 0; l < L; ++l)
+            any |= alive[l];
+        if (!any)
+            return 0;
+    }
+
+    uint64_t mask = 0;
+    for (int l = 0; l < count; ++l)
+        mask |= (uint64_t)(score[l] < (Lane)minED) << l;
+    return mask;
+}
+
+// Code lengths that get a compile-time specialised kernel.
+constexpr int kFixedLenMin = 8;
+constexpr int kFixedLenMax = 32;
+
+// Calls f(std::integral_constant<int, N>{}) for N == n when kFixedLenMin <= n <= kFixedLenMax and returns true;
+// returns false (without calling f) for any other length.
+template <int N = kFixedLenMin, typename F>
+inline bool DispatchCodeLen(int n, F &&f)
+{
+    if constexpr (N > kFixedLenMax)
+    {
+        return false;
+    }
+    else
+    {
+        if (n == N)
+        {
+            f(std::integral_constant<int, N>{});
+            return true;
+        }
+        return DispatchCodeLen<N + 1>(n, f);
+    }
+}
@@ -0,0 +1,147 @@
+/**
+ * @file GraphBackend.hpp
+ * @brief Binary hand-off between IndexGen and an external conflict-graph backend process.
+ *
+ * The backend (the CUDA scripts, or the CPU stand-in built into IndexGen) receives the packed candidates in an
+ * anonymous memory file that it inherits and maps, and streams the conflict edges back through a pipe as int32 (u, v)
+ * records with u < v, the record format of the old edges file. Nothing goes through the file system, and the edges are
+ * handed to the caller in chunks while the backend is still producing them.
+ *
+ * A backend is started with its own arguments followed by `--candidates-fd <n> --edges-fd <m>`. The candidate file
+ * holds a `CandidateSegmentHeader` followed by the `PackedCandidateSet` words; the backend writes the edge records to
+ * fd m and exits with status 0 once they are all written.
+ *
+ * A backend can also run as a persistent worker (`GraphWorker`), started once with `--worker-fd <n>` instead. Fd n is
+ * a Unix stream socket that carries a sequence of job batches: a `JobBatchHeader`, one uint64 candidate count per job
+ * and then the packed words of every job's candidates back to back. The worker answers each batch with one reply per
+ * job in order, a uint64 edge count followed by that many (u, v) records in the job's own numbering, and exits with
+ * status 0 when IndexGen shuts the socket down.
+ */
+
+#ifndef GRAPHBACKEND_HPP_
+#define GRAPHBACKEND_HPP_
+
+#include "PackedCandidates.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct CandidateSegmentHeader
+ * @brief Header of the candidate memory file, followed by `candidateNum * wordsPerSeq` uint64 packed words.
+ * @details Symbol p of candidate i is bits 2 * (p % 32) .. 2 * (p % 32) + 1 of word i * wordsPerSeq + p / 32.
+ */
+struct CandidateSegmentHeader
+{
+    static constexpr char kMagic[4] = {'I', 'G', 'P', 'K'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[4];
+    uint32_t version;
+    uint64_t candidateNum;
+    uint32_t codeLen;
+    uint32_t wordsPerSeq;
+};
+
+/**
+ * @brief Writes `candidates` to a new anonymous memory file.
+ * @return Its file descriptor (close-on-exec; `RunGraphBackend` hands it to the backend). Throws `std::runtime_error`
+ * on failure.
+ */
+int CreateCandidateSegment(const PackedCandidateSet &candidates);
+
+/**
+ * @brief Reads the candidates of the memory file `fd` (the backend side of `CreateCandidateSegment`).
+ * @details Throws `std::runtime_error` on a malformed file.
+ */
+PackedCandidateSet ReadCandidateSegment(int fd);
+
+/**
+ * @brief Writes `count` edge records to `fd`, retrying partial writes. Throws `std::runtime_error` on failure.
+ */
+void WriteEdgeRecords(int fd, const std::pair<int, int> *records, size_t count);
+
+/**
+ * @brief Runs a backend over `candidates` and hands its edges to `onChunk` as they arrive.
+ * @param argv The backend command; `argv[0]` is looked up in PATH.
+ * @param chunkPairs Records per chunk; `onChunk` may keep the vector (it gets a fresh one for the next chunk).
+ * @param silent Send the backend's output to /dev/null.
+ * @return The number of records received. Throws `std::runtime_error` when the backend cannot be started, fails, or
+ * sends a partial record.
+ */
+size_t RunGraphBackend(const std::vector<std::string> &argv, const PackedCandidateSet &candidates, size_t chunkPairs,
+                       bool silent, const std::function<void(std::vector<std::pair<int, int>> &)> &onChunk);
+
+/**
+ * @struct JobBatchHeader
+ * @brief Header of one job batch sent to a persistent worker, followed by `jobNum` uint64 candidate counts and the
+ * packed words of all the jobs' candidates.
+ */
+struct JobBatchHeader
+{
+    static constexpr char kMagic[4] = {'I', 'G', 'J', 'B'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[4];
+    uint32_t version;
+    uint32_t jobNum;
+    uint32_t codeLen;
+    uint32_t wordsPerSeq;
+    uint32_t reserved;
+};
+
+/**
+ * @class GraphWorker
+ * @brief A backend process that stays up and builds the conflict edges of many candidate sets, batch by batch.
+ * @details Saves the process start-up (interpreter, CUDA context, JIT) that `RunGraphBackend` pays per graph. `Run`
+ * may be called from several threads; the batches are served one at a time.
+ */
+class GraphWorker
+{
+  private:
+    std::string name;
+    pid_t pid;
+    int socketFd;
+    bool broken;
+    std::mutex mutex;
+
+    void Stop(bool force);
+
+  public:
+    /**
+     * @brief Starts the worker; `--worker-fd <n>` is appended to `argv`, whose `argv[0]` is looked up in PATH.
+     * @param silent Send the worker's output to /dev/null.
+     */
+    GraphWorker(const std::vector<std::string> &argv, bool silent);
+
+    /** @brief Shuts the worker down (see `Close`), ignoring a failed exit. */
+    ~GraphWorker();
+
+    GraphWorker(const GraphWorker &) = delete;
+    GraphWorker &operator=(const GraphWorker &) = delete;
+
+    /**
+     * @brief Sends `jobs` as one batch and returns the edges of each job, as (u, v) with u < v in the job's numbering.
+     * @details Throws `std::runtime_error` when the worker fails or has failed before; the worker is then stopped.
+     */
+    std::vector<std::vector<std::pair<int, int>>> Run(const std::vector<const PackedCandidateSet *> &jobs);
+
+    /** @brief Shuts the worker's socket down and waits for it. Throws `std::runtime_error` if it did not exit cleanly. */
+    void Close();
+};
+
+/**
+ * @brief Reads the next job batch of a persistent worker's socket (the worker side of `GraphWorker::Run`).
+ * @return False at the end of the stream. Throws `std::runtime_error` on a malformed or truncated batch.
+ */
+bool ReadJobBatch(int fd, std::vector<PackedCandidateSet> &jobs);
+
+/** @brief Writes one job's reply: the edge count and the records. Throws `std::runtime_error` on failure. */
+void WriteJobEdges(int fd, const std::vector<std::pair<int, int>> &edges);
+
+#endif /* GRAPHBACKEND_HPP_ */
@@ -0,0 +1,128 @@
+/**
+ * @file GraphCache.hpp
+ * @brief On-disk cache of conflict graphs, keyed by a digest of the candidate set and the minimum distance.
+ *
+ * Repeated runs over the same candidate set (a sweep over seeds or solver settings) rebuild the same conflict graph
+ * every time. A built graph is stored in the cache directory as an `.igraph` file: an `IGraphHeader` naming the
+ * candidate set, minED and metric it was built for, followed by a CSR section (see `CsrFileHeader`). A later run with
+ * the same key maps the file read-only instead of building the graph. Files are written under a temporary name and
+ * renamed into place, so jobs sharing a cache directory only ever see complete files.
+ *
+ * A graph too large for one machine is built in shards: process i of S scans every S-th work item of the all-pairs
+ * triangle and leaves its edges in the cache directory as sorted runs (`<graph>.shard-i-of-S_<k>.bin`) plus a
+ * `GraphShardHeader` manifest, written last. `MergeGraphShards` merges the S shards into the graph's `.igraph` file,
+ * which the solver then maps like any other cached graph.
+ */
+
+#ifndef GRAPHCACHE_HPP_
+#define GRAPHCACHE_HPP_
+
+#include "PackedCandidates.hpp"
+#include "SparseMat.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct IGraphHeader
+ * @brief Header of an `.igraph` file and the cache key of the graph it holds.
+ */
+struct IGraphHeader
+{
+    static constexpr char kMagic[4] = {'I', 'G', 'G', 'R'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kMetricEdit = 1; // edges join candidates at Levenshtein distance below minED
+
+    char magic[4];
+    uint32_t version;
+    uint64_t digest[2]; // 128-bit digest of the candidates, in order
+    uint64_t candidateNum;
+    uint32_t codeLen;
+    uint32_t minED;
+    uint32_t metric;
+    uint32_t reserved;
+
+    /** @brief The key of the graph over `candidates` with threshold `minED`. */
+    static IGraphHeader ForCandidates(const PackedCandidateSet &candidates, int minED);
+
+    /** @brief Whether both headers name the same graph. */
+    bool SameGraph(const IGraphHeader &other) const;
+
+    /** @brief The file name of this graph inside a cache directory. */
+    std::string FileName() const;
+};
+
+/**
+ * @brief Maps the cached graph for `key` from `cacheDir` into `adjList`.
+ * @return False, leaving `adjList` untouched, when the cache has no complete, matching file for the key.
+ */
+bool LoadCachedGraph(AdjList &adjList, const std::string &cacheDir, const IGraphHeader &key);
+
+/**
+ * @brief Stores `adjList` (before the greedy has deleted anything) in `cacheDir` under `key`, creating the directory
+ * if needed.
+ * @return The path written. Throws `std::runtime_error` on I/O failure.
+ */
+std::string StoreCachedGraph(const AdjList &adjList, const std::string &cacheDir, const IGraphHeader &key);
+
+/**
+ * @struct GraphShardHeader
+ * @brief Manifest of one finished shard of a graph: its runs are `<prefix>_0.bin` .. `<prefix>_<runNum - 1>.bin`.
+ */
+struct GraphShardHeader
+{
+    static constexpr char kMagic[4] = {'I', 'G', 'S', 'H'};
+    static constexpr uint32_t kVersion = 2;
+
+    char magic[4];
+    uint32_t version;
+    IGraphHeader graph;
+    uint32_t shardIndex;
+    uint32_t shardCount;
+    uint32_t runNum;
+    uint32_t itemNum;          // work items of the all-pairs triangle the shards are cut from
+    uint32_t compositionTiles; // 1 when the triangle was tiled by composition, 0 for fixed blocks
+    uint32_t reserved;
+    uint64_t keyNum; // run entries over all runs (two per edge)
+};
+
+/**
+ * @struct GraphShardCut
+ * @brief How the all-pairs triangle was cut into the work items that shard i of S takes every S-th of. Every shard of
+ * a graph must be cut the same way, or the shards do not cover the triangle exactly once.
+ */
+struct GraphShardCut
+{
+    uint32_t itemNum;
+    bool compositionTiles;
+};
+
+/** @brief The path prefix of shard `shardIndex` of `shardCount` of the graph `key` in `cacheDir`. */
+std::string GraphShardPrefix(const std::string &cacheDir, const IGraphHeader &key, int shardIndex, int shardCount);
+
+/**
+ * @brief Whether the shard has a complete manifest whose runs are all in place, cut with the same `compositionTiles`
+ * (a shard cut otherwise has to be rebuilt).
+ */
+bool GraphShardDone(const std::string &cacheDir, const IGraphHeader &key, int shardIndex, int shardCount,
+                    bool compositionTiles);
+
+/**
+ * @brief Renames `runs` to the shard's run names and writes its manifest, which marks the shard complete.
+ * @details Throws `std::runtime_error` on I/O failure.
+ */
+void CommitGraphShard(const std::string &cacheDir, const IGraphHeader &key, int shardIndex, int shardCount,
+                      const GraphShardCut &cut, const std::vector<std::string> &runs);
+
+/**
+ * @brief Merges the shards of the graph `key` found in `cacheDir` into its `.igraph` file and deletes them.
+ * @details The shards are only deleted once the `.igraph` file is in place, so a failed merge can be run again.
+ * Throws `std::runtime_error` when shards are missing, disagree on the shard count or on how the triangle was cut
+ * (`GraphShardCut`), or cannot be read.
+ * @param budgetBytes Memory for the merge's read buffers.
+ * @return The path of the `.igraph` file.
+ */
+std::string MergeGraphShards(const std::string &cacheDir, const IGraphHeader &key, size_t budgetBytes);
+
+#endif /* GRAPHCACHE_HPP_ */
@@ -0,0 +1,138 @@
+/**
+ * @file GraphKernel.hpp
+ * @brief Exact reductions of the conflict graph applied before the min-degree greedy.
+ *
+ * Several local patterns decide part of a maximum independent set outright: an isolated node is always taken; a
+ * pendant (degree-1) node can be taken in place of its neighbour; a node whose closed neighbourhood contains that of a
+ * neighbour can be dropped (domination); and a degree-2 node with non-adjacent neighbours a and b can be folded with
+ * them into one node adjacent to N(a) | N(b), the larger set containing either a and b or the middle node. Applying
+ * them before the greedy shrinks the graph it works on, and the decisions they make are the optimal ones, which the
+ * greedy would not always make. Sparse graphs (ED3, short codes) reduce the most.
+ */
+
+#ifndef GRAPHKERNEL_HPP_
+#define GRAPHKERNEL_HPP_
+
+#include "SparseMat.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class GraphKernel
+ * @brief Reduces the active subgraph of an `AdjList` with worklists and keeps the reconstruction stack.
+ * @details The input graph is only read. Folded nodes get new ids after the original ones and inherit the neighbour
+ * lists of the nodes they absorb through a union-find over the original ids, so a fold costs the two merged lists and
+ * nothing is copied out of the CSR. A node is put on the worklist whenever its degree drops to `kDominationDegree` or
+ * less. A visit reads the lists of the node and, for the domination test, of its neighbours of degree at most
+ * `kDominatorDegree`, so a hub is never read on behalf of the many small nodes around it. The remaining nodes and
+ * edges form `Reduced()`, which the greedy solves; `Lift` maps its result back through the stack.
+ */
+class GraphKernel
+{
+  public:
+    /**
+     * @brief Largest degree of a node that is tested for being dominated by one of its neighbours.
+     * @details The test walks the neighbour list of every neighbour of equal or larger degree (up to
+     * `kDominatorDegree`), so it is kept to nodes whose neighbourhoods are small enough to be contained in another.
+     */
+    static constexpr int kDominationDegree = 8;
+
+    /**
+     * @brief Largest degree of a neighbour that is tested for dominating a node.
+     * @details The test reads the neighbour's whole list, so without a cap a hub next to many low-degree nodes would
+     * be read again for each of them, every time their degree drops.
+     */
+    static constexpr int kDominatorDegree = 64;
+
+    /**
+     * @brief Reduces the active nodes of `graph` and builds the reduced graph on `threadNum` threads.
+     * @details `graph` must outlive the kernel; its deletion state is not changed.
+     */
+    explicit GraphKernel(const AdjList &graph, int threadNum = 1);
+
+    /** @brief The reduced graph, with its buckets built; its node k is kernel node k of `Lift`. */
+    AdjList &Reduced()
+    {
+        return reduced;
+    }
+
+    /**
+     * @brief Maps an independent set of the reduced graph to one of the input graph.
+     * @details Undoes the reductions in reverse order, then adds every active node none of whose neighbours is in the
+     * set, so the result is maximal. For a maximum set of the reduced graph the result is a maximum set of the input.
+     * @return The chosen nodes of the input graph, ascending.
+     */
+    std::vector<int> Lift(const std::vector<int> &kernelNodes) const;
+
+    /** @brief Number of nodes taken by the isolated, pendant and triangle rules. */
+    size_t TakenNum() const
+    {
+        return takenNum;
+    }
+
+    /** @brief Number of nodes removed as a neighbour of a taken node or as dominated. */
+    size_t RemovedNum() const
+    {
+        return removedNum;
+    }
+
+    /** @brief Number of dominated nodes among `RemovedNum`. */
+    size_t DominatedNum() const
+    {
+        return dominatedNum;
+    }
+
+    /** @brief Number of degree-2 folds. */
+    size_t FoldNum() const
+    {
+        return foldNum;
+    }
+
+  private:
+    /**
+     * @brief One reduction: node v taken (a < 0), or v folded with its neighbours a and b into node w.
+     */
+    struct Record
+    {
+        int v, a, b, w;
+    };
+
+    const AdjList &graph;
+    int nodeNum;
+
+    // Per node, original ids first and folded ones after: whether it is still in the graph, its degree among the
+    // nodes still in it, its union-find parent (a folded node points to the node it was folded into), and whether it
+    // is on the worklist
+    std::vector<uint8_t> alive;
+    std::vector<int> degree;
+    std::vector<int> parent;
+    std::vector<uint8_t> queued;
+
+    // members[w - nodeNum] = the original nodes whose neighbour lists folded node w inherits
+    std::vector<std::vector<int>> members;
+
+    // Visit stamps that de-duplicate neighbours in `Collect`, and marks for the neighbourhood compares
+    std::vector<int> stamp, mark;
+    int stampNum = 0, markNum = 0;
+
+    std::vector<int> worklist;
+    std::vector<Record> stack;
+    size_t takenNum = 0, removedNum = 0, dominatedNum = 0, foldNum = 0;
+
+    // Kernel node k of the reduced graph is node kernelIds[k]
+    std::vector<int> kernelIds;
+    AdjList reduced;
+
+    int Find(int node);
+
+    // Fills out with the distinct nodes still in the graph adjacent to node x
+    void Collect(int x, std::vector<int> &out);
+
+    void Push(int x);
+    void Take(int u);
+    void Remove(int x);
+    void Fold(int v, int a, int b);
+    bool Dominate(int u);
+};
+
+#endif /* GRAPHKERNEL_HPP_ */
@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 // Forward declarations for functions defined in other files
@@ -264,6 +265,127 @@ struct ClusteringParams
     ClusteringParams() : enabled(false), k(500), verbose(false), convergenceIterations(3), method("hierarchical_kmeans") {}
 };
 
+/**
+ * @struct GraphParams
+ * @brief Parameters controlling how the conflict graph is built on the CPU.
+ * @details None of these change the resulting graph or codebook; they only trade memory and preprocessing for speed.
+ */
+struct GraphParams
+{
+    /**
+     * @brief Whether to sort candidates by composition and skip whole tile pairs.
+     * @details Candidates are reordered by their (0,1,2,3) symbol counts and cut into tiles with per-symbol count
+     * bounds. A tile pair is skipped without reading a single candidate when the bounds prove L1 / 2 >= minED for
+     * every pair in it.
+     */
+    bool compositionTiles;
+
+    /**
+     * @brief Which CPU engine builds the conflict graph.
+     * @details "allpairs" tests every pair with the edit-distance kernels. "ball" enumerates each candidate's
+     * radius-(minED - 1) edit ball and probes a hash index of the candidates; it falls back to "allpairs" when the
+     * ball is too large relative to the candidate set or the codewords are too long to enumerate in one machine word.
+     * "segment" splits every candidate into minED segments and only verifies pairs sharing a segment at a compatible
+     * shift (PASS-JOIN); it falls back to "allpairs" when the segments are too short to filter. "deletion" indexes
+     * every candidate's (minED - 1)-deletion variants and only verifies pairs sharing one; it falls back when the
+     * variants would not fit the index memory budget or outnumber the candidates.
+     */
+    std::string builder;
+
+    /**
+     * @brief Whether the conflict graph keeps its neighbour lists delta + varint encoded.
+     * @details Sorted lists are stored as the gaps between consecutive neighbours in one byte arena, typically one to
+     * two bytes per entry instead of four (at most three below 2^21 nodes), and decoded on the fly while the greedy
+     * deletes balls. The codebook is the same either way.
+     */
+    bool compressGraph;
+
+    /**
+     * @brief Memory budget in MB for building the conflict graph out of core; 0 builds it in RAM.
+     * @details The builder threads spill their edges to sorted run files in the working directory whenever their
+     * buffers reach the budget, the runs are merged into one CSR file, and the greedy reads the neighbour lists from a
+     * read-only memory mapping of it, so they live in the page cache instead of the heap. Also applies to the edges
+     * loaded from the GPU script. Takes precedence over compressGraph. The codebook is the same either way.
+     */
+    int graphMemoryMB;
+
+    /**
+     * @brief Directory of the conflict-graph cache; empty disables it.
+     * @details A graph is cached as an `.igraph` file keyed by a digest of the candidate set (in order), minED and the
+     * metric. A run that finds its key maps the file read-only instead of building the graph; otherwise it stores the
+     * graph it built. Writes are atomic, so concurrent jobs can share the directory.
+     */
+    std::string cacheDir;
+
+    /**
+     * @brief Order the conflict graph's rows are stored in for the greedy: "none", "degree", "rcm" or "bfs".
+     * @details After construction the rows and per-node state are permuted so that a node and its neighbours lie close
+     * in memory (see `AdjList::Relabel`), which cuts the cache misses of the ball deletions; node ids are translated
+     * back when the codebook is written. Skipped for compressed and out-of-core graphs. The codebook is the same
+     * either way.
+     */
+    std::string vertexOrder;
+
+    /**
+     * @brief Largest bit matrix in MB that an in-RAM graph may be stored as instead of neighbour lists; 0 disables it.
+     * @details A graph of n nodes takes n^2 / 8 bytes as a bit matrix. It is chosen automatically when that fits this
+     * budget and is no larger than the plain lists, i.e. for small dense graphs such as the clusters of the clustered
+     * solver, where the greedy then finds a ball's active neighbours with word-wide ANDs. Not used with compressGraph
+     * or graphMemoryMB. The codebook is the same either way.
+     */
+    int bitsetMemoryMB;
+
+    GraphParams()
+        : compositionTiles(true), builder("allpairs"), compressGraph(false), graphMemoryMB(0), cacheDir(""),
+          vertexOrder("none"), bitsetMemoryMB(64)
+    {
+    }
+};
+
+/**
+ * @struct SolverParams
+ * @brief Parameters of the greedy independent-set solver that turns the conflict graph into a codebook.
+ */
+struct SolverParams
+{
+    /**
+     * @brief Which greedy runs the Codebook stage: "sequential" or "parallel".
+     * @details "sequential" takes one minimum-degree node per step and deletes its ball. "parallel" works in rounds
+     * (see `AdjList::ParallelGreedy`): every round takes all nodes of near-minimum degree that are local minima among
+     * their equally eligible neighbours, which are pairwise non-adjacent, and deletes their balls on all threads at
+     * once. The codebook is deterministic for any thread count but not the same as the sequential one. The
+     * clustered solver always runs the sequential greedy per cluster.
+     */
+    std::string method;
+
+    /**
+     * @brief Degree window of a parallel round, relative to the minimum degree.
+     * @details A round considers the nodes of degree at most `dmin + degreeWindow * dmin`; 0 only takes minimum-degree
+     * nodes. Larger values take more nodes per round, so there are fewer rounds. The window only limits which nodes a
+     * round may take: no value bounds how far the codebook size falls from the sequential greedy's.
+     */
+    double degreeWindow;
+
+    /**
+     * @brief Number of sequential greedy passes over the one graph; the largest codebook is kept.
+     * @details Pass 0 is the plain sequential greedy and the others break the minimum-degree ties at random (see
+     * `AdjList::GreedyPass`), so more passes never give a smaller codebook. The passes run concurrently on up to
+     * `threadNum` threads, each with its own degrees and buckets. 1 runs the plain greedy alone; the parallel method
+     * takes a single pass.
+     */
+    int restarts;
+
+    /**
+     * @brief Whether to reduce the graph exactly before the greedy.
+     * @details Isolated and pendant nodes are taken, dominated nodes dropped and degree-2 nodes folded with their
+     * neighbours (see `GraphKernel`); the greedy then runs on what is left, and its result is mapped back through the
+     * reductions. Applies to every method.
+     */
+    bool kernel;
+
+    SolverParams() : method("sequential"), degreeWindow(0.0), restarts(1), kernel(false) {}
+};
+
 /**
  * @struct Params
  * @brief A structure to hold all configuration parameters for the codebook generation process.
@@ -284,6 +406,14 @@ struct Params
      */
     int codeMinED;
 
+    /**
+     * @brief Several minimum edit distances to produce codebooks for in one run, from one distance-labelled graph.
+     * @details Empty (the default) or a single value runs `codeMinED` alone. With more values, the conflict graph is
+     * built once at the largest distance with the exact distance stored per edge, and a codebook is written for every
+     * value; see `GenerateCodebooksAdjLabelled`.
+     */
+    std::vector<int> editDists;
+
     // --- Generation Method & Constraints ---
     GenerationMethod method;
     std::unique_ptr<GenerationConstraints> constraints; // Holds the method-specific parameters
@@ -311,6 +441,21 @@ struct Params
      */
     double maxGCCont;
 
+    /**
+     * @brief Homopolymer-run limits to sweep over (0 disables the filter, as in `maxRun`).
+     * @details Together with `gcSweep` this enables the filter sweep: the conflict graph is built once over the
+     * unfiltered candidates, and one codebook is written for every (GC range, run limit) cell from the subgraph induced
+     * by the candidates passing that cell's filters; see `GenerateCodebooksAdjSweep`. An empty list sweeps `maxRun`
+     * alone.
+     */
+    std::vector<int> maxRunSweep;
+
+    /**
+     * @brief GC-content ranges (min, max) to sweep over, with the same conventions as `minGCCont` and `maxGCCont`.
+     * @details An empty list sweeps the single range (`minGCCont`, `maxGCCont`); see `maxRunSweep`.
+     */
+    std::vector<std::pair<double, double>> gcSweep;
+
     // --- Performance & Execution Parameters ---
 
     /** @brief The number of threads to use for parallelizable tasks. */
@@ -334,10 +479,35 @@ struct Params
     /** @brief Clustering configuration. */
     ClusteringParams clustering;
 
+    /** @brief Conflict graph construction options. */
+    GraphParams graph;
+
+    /** @brief Greedy solver options. */
+    SolverParams solver;
+
+    // --- Sharded Graph Build ---
+
+    /**
+     * @brief Which shard of the conflict graph this process builds, out of `graphShardCount`.
+     * @details With `graphShardCount` > 0 the run only builds its shard into the graph cache and writes no codebook;
+     * see `GenerateGraphShard`.
+     */
+    int graphShardIndex;
+
+    /** @brief The number of shards the conflict graph is split into; 0 (the default) builds it in one process. */
+    int graphShardCount;
+
+    /**
+     * @brief Merge the finished shards into the cached graph instead of generating a codebook.
+     * @details See `GenerateGraphMerge`.
+     */
+    bool graphMerge;
+
     /** @brief Default constructor. Initializes all members to zero/default values. */
     Params()
         : codeLen(), codeMinED(), method(), constraints(), maxRun(), minGCCont(), maxGCCont(), threadNum(),
-          saveInterval(), verify(false), useGPU(true), maxGPUMemoryGB(10.0), clustering() {};
+          saveInterval(), verify(false), useGPU(true), maxGPUMemoryGB(10.0), clustering(), graph(),
+          solver(), graphShardIndex(0), graphShardCount(0), graphMerge(false) {};
 
     /**
      * @brief Parameterized constructor for easy initialization.
@@ -347,7 +517,7 @@ struct Params
            std::unique_ptr<GenerationConstraints> &&constraints, bool verify = false, bool useGPU = true, double maxGPUMemoryGB = 10.0)
         : codeLen(codeLen), codeMinED(minED), method(gen_method), constraints(std::move(constraints)), maxRun(maxRun),
           minGCCont(minGCCont), maxGCCont(maxGCCont), threadNum(threadNum), saveInterval(saveInterval), verify(verify),
-          useGPU(useGPU), maxGPUMemoryGB(maxGPUMemoryGB)
+          useGPU(useGPU), maxGPUMemoryGB(maxGPUMemoryGB), graphShardIndex(0), graphShardCount(0), graphMerge(false)
     {
     }
 };
@@ -0,0 +1,114 @@
+/**
+ * @file MetricIndex.hpp
+ * @brief Pivot-table metric index over packed codewords for edit-distance radius and k-nearest-neighbour queries.
+ *
+ * Answers "which words lie within distance r of this one" and "which word is closest" without running the
+ * edit-distance kernel on every word: the distances from every word to a few pivot words are stored, and by the
+ * triangle inequality |d(q, p) - d(w, p)| <= d(q, w), so one byte compare per pivot rules most words out before any
+ * kernel call. Decoding uses it for its nearest-codeword search. Codebook verification and conflict-graph
+ * construction keep the batched row scanners: their queries sit at distance ~minED from almost every word, where the
+ * pivot bounds prune little and the batched kernel is several times faster than per-word banded calls.
+ */
+
+#ifndef METRICINDEX_HPP_
+#define METRICINDEX_HPP_
+
+#include "EditDistance.hpp"
+#include "PackedCandidates.hpp"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class MetricIndex
+ * @brief LAESA-style index: a flat pivot-major table of word-to-pivot distances next to the packed words.
+ * @details A query computes its exact distance to each pivot, then one vectorisable pass per pivot raises a per-word
+ * lower bound. Radius queries verify the words whose bound is within the radius with the banded kernel capped at the
+ * radius; k-NN queries verify words in increasing bound order and stop once the bound exceeds the k-th best distance.
+ * Pivots are picked farthest-first from a sample, so they spread over the space. Vantage-point and BK trees prune
+ * poorly here: edit distances between codewords concentrate around a few values, so nearly every subtree overlaps
+ * the query ball, while the table keeps the filter a linear, branch-free scan.
+ */
+class MetricIndex
+{
+  private:
+    int len = 0;
+    PackedCandidateSet words;           // the indexed words, in input order
+    std::vector<int> pivots;            // indices of the pivot words
+    std::vector<std::string> pivotText; // the pivot words, unpacked once for the per-query distances
+    std::vector<uint8_t> table;         // table[p * size() + i] = ED(word i, pivot p), saturated at 255
+
+    // bound[i - first] = lower bound on the distance from the query to word i >= first; returns the query's pattern
+    PatternHandle LowerBounds(const std::string &query, size_t first, std::vector<uint8_t> &bound) const;
+
+  public:
+    static constexpr int kDefaultPivots = 16;
+
+    MetricIndex() = default;
+
+    /**
+     * @brief Builds the index over `candidates` (all of one length).
+     * @param threadNum Threads computing the pivot table.
+     * @param pivotNum Number of pivots (at most the number of words).
+     */
+    explicit MetricIndex(const PackedCandidateSet &candidates, int threadNum = 1, int pivotNum = kDefaultPivots);
+
+    /** @brief The number of indexed words. */
+    size_t size() const
+    {
+        return words.size();
+    }
+
+    bool empty() const
+    {
+        return words.empty();
+    }
+
+    /** @brief The number of pivots. */
+    int PivotCount() const
+    {
+        return (int)pivots.size();
+    }
+
+    /**
+     * @brief Calls f(index, distance) for every word with index >= first within `radius` of `query`, in increasing
+     * index order.
+     * @param bound Scratch buffer, reused across calls.
+     */
+    template <typename F>
+    void ForEachWithin(const std::string &query, int radius, size_t first, std::vector<uint8_t> &bound, F &&f) const
+    {
+        if (first >= size() || radius < 0)
+            return;
+        const PatternHandle H = LowerBounds(query, first, bound);
+        std::string text;
+        for (size_t k = 0; k < bound.size(); ++k)
+        {
+            if (bound[k] > radius)
+                continue;
+            words.Unpack(first + k, text);
+            const int d = EditDistanceBanded(text, H, radius);
+            if (d <= radius)
+                f((int)(first + k), d);
+        }
+    }
+
+    /** @brief All (index, distance) pairs within `radius` of `query`, sorted by distance, then index. */
+    std::vector<std::pair<int, int>> Within(const std::string &query, int radius) const;
+
+    /**
+     * @brief The `k` words closest to `query` as (index, distance), sorted by distance, then index.
+     * @details Ties at the k-th distance are broken towards the lower index, as a linear scan keeping the first
+     * strictly better word would.
+     */
+    std::vector<std::pair<int, int>> Nearest(const std::string &query, int k) const;
+
+    /** @brief Writes the index to a binary file. Throws `std::runtime_error` on I/O failure. */
+    void Save(const std::string &filename) const;
+
+    /** @brief Reads an index written by `Save`. Throws `std::runtime_error` on I/O failure or a malformed file. */
+    static MetricIndex Load(const std::string &filename);
+};
+
+#endif /* METRICINDEX_HPP_ */
@@ -0,0 +1,543 @@
+/**
+ * @file PackedCandidates.hpp
+ * @brief Defines a compact, 2-bit-per-symbol container for fixed-length candidate strings.
+ *
+ * Candidates are strings over {0, 1, 2, 3} (binary candidates use {0, 1}) that all share the same length. Storing
+ * them as `std::vector<std::string>` costs 32 bytes per object plus a heap block once the length exceeds the small
+ * string buffer. `PackedCandidateSet` stores every candidate as a fixed number of 64-bit words (32 symbols per word)
+ * in one flat array, so a 16-symbol candidate costs 8 bytes. Generators fill the set directly, the conflict-graph
+ * kernels read symbols straight from the words, and conversion back to text happens only when writing files.
+ */
+
+#ifndef PACKEDCANDIDATES_HPP_
+#define PACKEDCANDIDATES_HPP_
+
+#include "EditDistance.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class PackedCandidateSet
+ * @brief A flat array of fixed-length strings over {0, 1, 2, 3}, packed two bits per symbol.
+ *
+ * Symbol `p` of candidate `i` lives in word `i * WordsPerSeq() + p / 32`, at bit offset `2 * (p % 32)`.
+ * The length is fixed by the first candidate added (or by the constructor) and enforced for every later one.
+ */
+class PackedCandidateSet
+{
+  private:
+    int len;                     // symbols per candidate
+    int wordsPerSeq;             // 64-bit words per candidate
+    std::vector<uint64_t> words; // flat: size() * wordsPerSeq
+
+  public:
+    static constexpr int kSymbolsPerWord = 32;
+
+    PackedCandidateSet() : len(0), wordsPerSeq(0)
+    {
+    }
+
+    /**
+     * @brief Creates an empty set for candidates of the given length.
+     * @param length The number of symbols per candidate.
+     */
+    explicit PackedCandidateSet(int length);
+
+    /** @brief The number of symbols per candidate (0 while the set has no length yet). */
+    int Length() const
+    {
+        return len;
+    }
+
+    /** @brief The number of 64-bit words each candidate occupies. */
+    int WordsPerSeq() const
+    {
+        return wordsPerSeq;
+    }
+
+    /** @brief The number of candidates in the set. */
+    size_t size() const
+    {
+        return wordsPerSeq ? words.size() / wordsPerSeq : 0;
+    }
+
+    bool empty() const
+    {
+        return words.empty();
+    }
+
+    void reserve(size_t n)
+    {
+        words.reserve(n * (size_t)wordsPerSeq);
+    }
+
+    void clear()
+    {
+        words.clear();
+    }
+
+    /** @brief Bytes held by the packed payload (excluding the object header). */
+    size_t MemoryBytes() const
+    {
+        return words.capacity() * sizeof(uint64_t);
+    }
+
+    /** @brief Pointer to the `WordsPerSeq()` words of candidate `i`. */
+    const uint64_t *Words(size_t i) const
+    {
+        return &words[i * (size_t)wordsPerSeq];
+    }
+
+    /** @brief Symbol (0..3) at position `pos` of candidate `i`. */
+    int Symbol(size_t i, int pos) const
+    {
+        return (int)((Words(i)[pos / kSymbolsPerWord] >> (2 * (pos % kSymbolsPerWord))) & 3ULL);
+    }
+
+    /**
+     * @brief Appends a candidate given as text over '0'..'3'.
+     * @details The first candidate fixes the length of a default-constructed set. Throws `std::runtime_error`
+     * if the length differs from the set's length.
+     */
+    void PushBack(const std::string &str);
+
+    /** @brief Appends candidate `i` of `other`, which must have the same length. */
+    void Append(const PackedCandidateSet &other, size_t i);
+
+    /** @brief Appends a candidate already packed into `WordsPerSeq()` words (the set's length must be set). */
+    void PushBackWords(const uint64_t *src)
+    {
+        for (int w = 0; w < wordsPerSeq; ++w)
+            words.push_back(src[w]);
+    }
+
+    /** @brief Appends every candidate of `other`, which must have the same length (or this set be empty). */
+    void AppendAll(const PackedCandidateSet &other);
+
+    /** @brief Writes candidate `i` as text over '0'..'3' into `out`, reusing its buffer. */
+    void Unpack(size_t i, std::string &out) const;
+
+    /** @brief Returns candidate `i` as text over '0'..'3'. */
+    std::string Get(size_t i) const;
+
+    /** @brief Unpacks the whole set into text form (only for interfaces that require strings). */
+    std::vector<std::string> ToStrings() const;
+
+    /** @brief Packs a vector of equal-length strings. */
+    static PackedCandidateSet FromStrings(const std::vector<std::string> &strs);
+};
+
+/**
+ * @brief Writes the set as text, one candidate per line (same format as `StrVecToFile`).
+ * @param data The set to write.
+ * @param fileName The name of the output file.
+ */
+void PackedToFile(const PackedCandidateSet &data, const std::string &fileName);
+
+/**
+ * @brief Reads a text file written by `PackedToFile` / `StrVecToFile` into a packed set.
+ * @param data The set to populate; its previous content is discarded.
+ * @param fileName The name of the input file.
+ */
+void FileToPacked(PackedCandidateSet &data, const std::string &fileName);
+
+// -------------------- Batched conflict test on packed candidates --------------------
+
+/**
+ * @brief Calls onConflict(j) in increasing order for every j in [first, last) with ED(texts[j], H) < minED.
+ * @details Packed counterpart of the `std::vector<std::string>` overload in EditDistance.hpp: the SIMD kernel reads
+ * the 2-bit symbols directly from the packed words. Patterns the batch kernel cannot take (m > 64) fall back to the
+ * banded scalar kernel on unpacked text.
+ */
+template <typename F>
+inline void ForEachConflict(const PatternHandle &H, const PackedCandidateSet &texts, size_t first, size_t last,
+                            int minED, F &&onConflict)
+{
+    const int lanes = BatchLanes(H);
+    if (lanes == 0 || texts.Length() != H.m)
+    {
+        std::string text;
+        for (size_t j = first; j < last; ++j)
+        {
+            texts.Unpack(j, text);
+            if (!EditDistanceBandedAtLeast(text, H, minED))
+                onConflict(j);
+        }
+        return;
+    }
+
+    const int n = texts.Length();
+    const uint64_t *batch[64];
+    for (size_t j = first; j < last; j += (size_t)lanes)
+    {
+        const int count = (int)std::min((size_t)lanes, last - j);
+        for (int l = 0; l < count; ++l)
+            batch[l] = texts.Words(j + l);
+        uint64_t mask = MyersBatchConflictMask(H, n, count, minED, [&batch](int l, int p) {
+            constexpr int W = PackedCandidateSet::kSymbolsPerWord;
+            return (unsigned)(batch[l][p / W] >> (2 * (p % W))) & 3U;
+        });
+        while (mask)
+        {
+            onConflict(j + (size_t)__builtin_ctzll(mask));
+            mask &= mask - 1;
+        }
+    }
+}
+
+// -------------------- Hamming distance on packed words --------------------
+
+/** @brief Number of differing symbols between two packed candidates of `words` words each. */
+inline int PackedHammingDist(const uint64_t *a, const uint64_t *b, int words)
+{
+    int dist = 0;
+    for (int w = 0; w < words; ++w)
+    {
+        const uint64_t x = a[w] ^ b[w];
+        dist += __builtin_popcountll((x | (x >> 1)) & 0x5555555555555555ULL);
+    }
+    return dist;
+}
+
+// -------------------- Composition (symbol counts) on packed words --------------------
+
+/**
+ * @brief Symbol counts of a packed candidate of length `len`: the count of symbol s sits in bits 16s..16s+15.
+ * @details For equal-length words every substitution changes the L1 distance of the count vectors by at most 2 and
+ * every insertion/deletion pair by at most 2 as well, so ED >= L1 / 2.
+ */
+inline uint64_t PackedComposition(const uint64_t *w, int len)
+{
+    uint64_t c1 = 0, c2 = 0, c3 = 0;
+    for (int word = 0; word * PackedCandidateSet::kSymbolsPerWord < len; ++word)
+    {
+        const uint64_t lo = CompressEvenBits(w[word]);
+        const uint64_t hi = CompressEvenBits(w[word] >> 1);
+        c1 += (uint64_t)__builtin_popcountll(lo & ~hi);
+        c2 += (uint64_t)__builtin_popcountll(~lo & hi);
+        c3 += (uint64_t)__builtin_popcountll(lo & hi);
+    }
+    const uint64_t c0 = (uint64_t)len - c1 - c2 - c3;
+    return c0 | (c1 << 16) | (c2 << 32) | (c3 << 48);
+}
+
+/** @brief `PackedComposition` of every candidate of the set, in index order. */
+std::vector<uint64_t> PackedCompositions(const PackedCandidateSet &texts);
+
+/** @brief L1 distance between two `PackedComposition` count vectors. */
+inline int CompositionL1(uint64_t a, uint64_t b)
+{
+    int sum = 0;
+    for (int s = 0; s < 4; ++s)
+    {
+        const int d = (int)((a >> (16 * s)) & 0xFFFF) - (int)((b >> (16 * s)) & 0xFFFF);
+        sum += (d < 0) ? -d : d;
+    }
+    return sum;
+}
+
+// -------------------- Composition-sorted tiles --------------------
+
+/**
+ * @class CompositionTiles
+ * @brief A copy of a candidate set sorted by composition and cut into fixed-size tiles with per-symbol count bounds.
+ * @details Sorting groups candidates with equal symbol counts. Tiles hold at most `tileSize` candidates and end at a
+ * composition change once they hold an eighth of that, so each tile spans a narrow box of compositions (often a single
+ * point). For two tiles the per-symbol gaps between their boxes lower-bound the composition L1 of every pair across
+ * them; when that bound reaches 2 * minED the whole tile pair is compatible and can be skipped. `Original(k)` maps a
+ * sorted position back to the index in the set the tiles were built from.
+ */
+class CompositionTiles
+{
+  private:
+    PackedCandidateSet sorted;
+    std::vector<uint64_t> compositions; // PackedComposition of sorted[k]
+    std::vector<int> order;             // sorted position -> original index
+    std::vector<size_t> tileStart; // tile t covers sorted positions [tileStart[t], tileStart[t + 1])
+    std::vector<uint64_t> tileMin, tileMax;
+
+  public:
+    static constexpr int kDefaultTileSize = 256;
+
+    /**
+     * @brief Sorts `candidates` by composition (stable, so equal compositions keep their order) and builds the tiles.
+     * @param candidates The set to index.
+     * @param tileSize Maximum number of candidates per tile.
+     */
+    explicit CompositionTiles(const PackedCandidateSet &candidates, int tileSize = kDefaultTileSize);
+
+    /** @brief The candidates in sorted order. */
+    const PackedCandidateSet &Sorted() const
+    {
+        return sorted;
+    }
+
+    /** @brief `PackedComposition` of every sorted candidate. */
+    const std::vector<uint64_t> &Compositions() const
+    {
+        return compositions;
+    }
+
+    /** @brief Original index of the candidate at sorted position `k`. */
+    int Original(size_t k) const
+    {
+        return order[k];
+    }
+
+    size_t TileCount() const
+    {
+        return tileMin.size();
+    }
+
+    /** @brief Sorted position of the first candidate of tile `t`. */
+    size_t TileBegin(size_t t) const
+    {
+        return tileStart[t];
+    }
+
+    /** @brief Sorted position one past the last candidate of tile `t`. */
+    size_t TileEnd(size_t t) const
+    {
+        return tileStart[t + 1];
+    }
+
+    /** @brief Lower bound on `CompositionL1` over every pair with one candidate in tile `a` and one in tile `b`. */
+    int TileGapL1(size_t a, size_t b) const;
+};
+
+// -------------------- Row scanners (one candidate against a range of candidates) --------------------
+
+/**
+ * @struct ConflictScanStats
+ * @brief Per-stage pair counts of the row scanners.
+ * @details For equal-length words ED <= HD, so a pair with Hamming distance below minED is a conflict without running
+ * the DP, and ED >= L1 / 2 of the symbol-count vectors, so a pair whose composition bound reaches minED is compatible.
+ * Only the remaining pairs reach the banded/batched edit-distance kernel.
+ */
+struct ConflictScanStats
+{
+    long long hammingConflicts = 0;   ///< Pairs settled as conflicts by the Hamming stage
+    long long compositionRejects = 0; ///< Pairs settled as compatible by the composition bound
+    long long dpPairs = 0;            ///< Pairs passed on to the edit-distance kernel
+    long long dpConflicts = 0;        ///< Of those, pairs the kernel found in conflict
+
+    /** @brief Share (in percent) of the pairs that survived the Hamming stage which the composition bound removed. */
+    double CompositionHitRate() const
+    {
+        const long long tested = compositionRejects + dpPairs;
+        return tested ? 100.0 * (double)compositionRejects / (double)tested : 0.0;
+    }
+
+    void Add(const ConflictScanStats &other)
+    {
+        hammingConflicts += other.hammingConflicts;
+        compositionRejects += other.compositionRejects;
+        dpPairs += other.dpPairs;
+        dpConflicts += other.dpConflicts;
+    }
+};
+
+/**
+ * @brief Staged scan of row i against [first, last): Hamming pre-stage, composition filter, then `dpMask`.
+ * @details `comp` holds the `PackedComposition` of every candidate, or is null to skip the composition filter.
+ * Survivors of both filters are compacted into full batches of `lanes` candidates before `dpMask(batch, idx, count)` is
+ * called (`batch[l]` = packed words of candidate `idx[l]`); it returns the conflict bitmask of the batch.
+ * Hamming and DP conflicts are merged so onConflict(j) still sees j in increasing order.
+ */
+template <typename DPMask, typename F>
+inline void ScanRowStaged(const PackedCandidateSet &texts, const uint64_t *comp, size_t i, size_t first, size_t last,
+                          int minED, int lanes, DPMask &&dpMask, ConflictScanStats &stats,
+                          std::vector<size_t> &hammingHits, std::vector<size_t> &dpHits, F &&onConflict)
+{
+    const int words = texts.WordsPerSeq();
+    const uint64_t *pattern = texts.Words(i);
+    const uint64_t *batch[64];
+    size_t batchIdx[64];
+    int pending = 0;
+    long long rejects = 0;
+    hammingHits.clear();
+    dpHits.clear();
+
+    auto flush = [&]() {
+        uint64_t mask = dpMask(batch, batchIdx, pending);
+        stats.dpPairs += pending;
+        while (mask)
+        {
+            dpHits.push_back(batchIdx[__builtin_ctzll(mask)]);
+            mask &= mask - 1;
+        }
+        pending = 0;
+    };
+
+    // Windows of 64 candidates: both filters are evaluated in branch-free (vectorisable) loops, then the undecided
+    // candidates are compacted into the DP batch. stage[t]: 1 = Hamming conflict, 2 = composition-compatible, 0 = DP.
+    uint8_t stage[64];
+    const uint64_t rowComp = comp ? comp[i] : 0;
+    const int farL1 = 2 * minED;
+    for (size_t base = first; base < last; base += 64)
+    {
+        const int cnt = (int)std::min((size_t)64, last - base);
+        const uint64_t *window = texts.Words(base);
+        const uint64_t *windowComp = comp ? comp + base : nullptr;
+        if (words == 1 && comp)
+        {
+            for (int t = 0; t < cnt; ++t)
+            {
+                const uint64_t x = pattern[0] ^ window[t];
+                stage[t] = (uint8_t)((__builtin_popcountll((x | (x >> 1)) & 0x5555555555555555ULL) < minED) |
+                                     ((CompositionL1(rowComp, windowComp[t]) >= farL1) << 1));
+            }
+        }
+        else
+        {
+            for (int t = 0; t < cnt; ++t)
+                stage[t] = (uint8_t)(PackedHammingDist(pattern, window + (size_t)t * words, words) < minED);
+            if (comp)
+            {
+                for (int t = 0; t < cnt; ++t)
+                    stage[t] |= (uint8_t)((CompositionL1(rowComp, windowComp[t]) >= farL1) << 1);
+            }
+        }
+        // A Hamming conflict never also passes the composition bound (L1 / 2 <= ED <= HD < minED). Rejections are
+        // frequent and unpredictable, so the slot is written unconditionally and only claimed for undecided pairs.
+        for (int t = 0; t < cnt; ++t)
+        {
+            const int st = stage[t];
+            if (st == 1)
+            {
+                hammingHits.push_back(base + t);
+                continue;
+            }
+            rejects += st >> 1;
+            batch[pending] = window + (size_t)t * words;
+            batchIdx[pending] = base + t;
+            pending += (st == 0);
+            if (pending == lanes)
+                flush();
+        }
+    }
+    if (pending > 0)
+        flush();
+
+    stats.hammingConflicts += (long long)hammingHits.size();
+    stats.compositionRejects += rejects;
+    stats.dpConflicts += (long long)dpHits.size();
+
+    size_t a = 0, b = 0;
+    while (a < hammingHits.size() || b < dpHits.size())
+    {
+        if (b == dpHits.size() || (a < hammingHits.size() && hammingHits[a] < dpHits[b]))
+            onConflict(hammingHits[a++]);
+        else
+            onConflict(dpHits[b++]);
+    }
+}
+
+/**
+ * @class FixedLengthConflictScanner
+ * @brief Row scanner for candidates of compile-time length N (kFixedLenMin..kFixedLenMax).
+ * @details The pattern's Peq4 is built straight from its packed word, so no 256-entry table is allocated or cleared
+ * per row, and the batched kernel runs with a fully unrolled column loop.
+ */
+template <int N>
+class FixedLengthConflictScanner
+{
+  private:
+    const PackedCandidateSet &texts;
+    const uint64_t *comp; // PackedComposition per candidate, or null
+    ConflictScanStats &stats;
+    mutable std::vector<size_t> hammingHits, dpHits; // per-row scratch, reused across rows
+
+  public:
+    FixedLengthConflictScanner(const PackedCandidateSet &texts, const uint64_t *comp, ConflictScanStats &stats)
+        : texts(texts), comp(comp), stats(stats)
+    {
+    }
+
+    /** @brief Calls onConflict(j) in increasing order for every j in [first, last) with ED(j, i) < minED. */
+    template <typename F>
+    void operator()(size_t i, size_t first, size_t last, int minED, F &&onConflict) const
+    {
+        constexpr int lanes = kBatchBytes / (int)sizeof(FixedLane<N>);
+        const Peq4 P = MakePeq4(texts.Words(i), N);
+        ScanRowStaged(
+            texts, comp, i, first, last, minED, lanes,
+            [&](const uint64_t *const *batch, const size_t *, int count) {
+                return MyersBatchConflictMaskN<N>(P, batch, count, minED);
+            },
+            stats, hammingHits, dpHits, onConflict);
+    }
+};
+
+/**
+ * @class GenericConflictScanner
+ * @brief Row scanner for any length: builds a PatternHandle per row and uses the runtime-length kernels.
+ */
+class GenericConflictScanner
+{
+  private:
+    const PackedCandidateSet &texts;
+    const uint64_t *comp; // PackedComposition per candidate, or null
+    ConflictScanStats &stats;
+    mutable std::vector<size_t> hammingHits, dpHits; // per-row scratch, reused across rows
+    mutable std::string text;
+
+  public:
+    GenericConflictScanner(const PackedCandidateSet &texts, const uint64_t *comp, ConflictScanStats &stats)
+        : texts(texts), comp(comp), stats(stats)
+    {
+    }
+
+    /** @brief Calls onConflict(j) in increasing order for every j in [first, last) with ED(j, i) < minED. */
+    template <typename F>
+    void operator()(size_t i, size_t first, size_t last, int minED, F &&onConflict) const
+    {
+        PatternHandle H = MakePattern(texts.Get(i));
+        const int n = texts.Length();
+        const int lanes = BatchLanes(H);
+        if (lanes == 0)
+        {
+            // Scalar banded kernel, one survivor at a time
+            ScanRowStaged(
+                texts, comp, i, first, last, minED, 1,
+                [&](const uint64_t *const *, const size_t *idx, int) {
+                    texts.Unpack(idx[0], text);
+                    return (uint64_t)!EditDistanceBandedAtLeast(text, H, minED);
+                },
+                stats, hammingHits, dpHits, onConflict);
+            return;
+        }
+        ScanRowStaged(
+            texts, comp, i, first, last, minED, lanes,
+            [&](const uint64_t *const *batch, const size_t *, int count) {
+                return MyersBatchConflictMask(H, n, count, minED, [batch](int l, int p) {
+                    constexpr int W = PackedCandidateSet::kSymbolsPerWord;
+                    return (unsigned)(batch[l][p / W] >> (2 * (p % W))) & 3U;
+                });
+            },
+            stats, hammingHits, dpHits, onConflict);
+    }
+};
+
+/**
+ * @brief Picks the row scanner for the set's codeword length once and runs `body(scanner)` with it.
+ * @details Lengths kFixedLenMin..kFixedLenMax get a `FixedLengthConflictScanner<N>`; anything else falls back to
+ * `GenericConflictScanner`. `body` is typically a generic lambda holding the whole row loop, so the length dispatch
+ * happens once per call rather than once per row. `compositions` is the output of `PackedCompositions(texts)` (shared
+ * by all threads), or empty to run without the composition filter. Per-stage pair counts accumulate into `stats`.
+ */
+template <typename Body>
+inline void WithConflictScanner(const PackedCandidateSet &texts, const std::vector<uint64_t> &compositions,
+                                ConflictScanStats &stats, Body &&body)
+{
+    const uint64_t *comp = compositions.empty() ? nullptr : compositions.data();
+    bool specialised = DispatchCodeLen(texts.Length(), [&](auto len) {
+        body(FixedLengthConflictScanner<decltype(len)::value>(texts, comp, stats));
+    });
+    if (!specialised)
+        body(GenericConflictScanner(texts, comp, stats));
+}
+
+#endif /* PACKEDCANDIDATES_HPP_ */
@@ -16,14 +16,18 @@
 
 #include "IndexGen.hpp" // Assumed to contain the definition for Params struct
 #include <chrono>       // Use modern C++ time library
+#include <cstdint>
+#include <iosfwd>
 #include <map>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 // Forward declaration for the Params struct defined in IndexGen.hpp
 struct Params;
+class PackedCandidateSet;
 
 // =================================================================================
 // SECTION: AdjList CLASS - Sparse Matrix Representation
@@ -43,10 +47,150 @@ class AdjList
 {
   private:
     /**
-     * @brief The primary data structure for the adjacency list using dense arrays.
+     * @brief The graph in compressed sparse row form: node i has `offsets[i + 1] - offsets[i]` neighbours, sorted
+     * ascending. Built once by `Build`; deletions are lazy.
      */
-    std::vector<std::vector<int>> m;
-    
+    std::vector<size_t> offsets;
+
+    /**
+     * @brief Plain storage: the neighbours of node i are `neighbours[offsets[i]]` .. `neighbours[offsets[i + 1] - 1]`.
+     */
+    std::vector<int> neighbours;
+
+    /**
+     * @brief The offsets and plain neighbour lists actually read: the two vectors above, or the sections of a CSR file
+     * mapped by `MapFile`.
+     */
+    const size_t *rowOffsets = nullptr;
+    const int *rowNeighbours = nullptr;
+
+    /**
+     * @brief The read-only mapping behind `rowOffsets` and `rowNeighbours`, if any.
+     */
+    void *mapping = nullptr;
+    size_t mappingBytes = 0;
+
+    /**
+     * @brief Memory budget of the out-of-core build in bytes; 0 builds in RAM.
+     */
+    size_t externalBudget = 0;
+
+    /**
+     * @brief Compressed storage: node i's list is the LEB128 varint gaps between consecutive neighbours (the first
+     * from 0) in `arena[arenaOffsets[i]]` .. `arena[arenaOffsets[i + 1] - 1]`.
+     */
+    bool compressed = false;
+    std::vector<size_t> arenaOffsets;
+    std::vector<uint8_t> arena;
+
+    /**
+     * @brief Largest bit matrix in bytes that `Build` may choose for plain storage; 0 never chooses one.
+     */
+    size_t bitsetBudget = 0;
+
+    /**
+     * @brief Bit-matrix storage (`rowWords` > 0): bit j of `bitRows[i * rowWords + j / 64]` is set when j is a
+     * neighbour of node i, and `live` has bit i set while node i is not deleted, so a row AND `live` gives the active
+     * neighbours a word at a time. `offsets` still holds the row lengths.
+     */
+    size_t rowWords = 0;
+    std::vector<uint64_t> bitRows;
+    std::vector<uint64_t> live;
+
+    /**
+     * @brief Set by `Relabel`: node i is stored as row `rank[i]`, and row r holds node `order[r]`. Both are empty while
+     * the rows are in node order.
+     * @details Every member below that is indexed per node (the CSR rows, `deleted`, `degree`, the buckets) is indexed
+     * by row, and neighbour lists hold rows. The public functions take and return node ids.
+     */
+    std::vector<int> order;
+    std::vector<int> rank;
+
+    int Row(int node) const
+    {
+        return rank.empty() ? node : rank[node];
+    }
+
+    int Node(int row) const
+    {
+        return order.empty() ? row : order[row];
+    }
+
+    /**
+     * @brief Calls f(j) for every neighbour row j of row i (deleted ones included), in ascending node order.
+     */
+    template <typename F>
+    void ForEachNeighbour(int i, F &&f) const
+    {
+        if (rowWords > 0)
+        {
+            const uint64_t *row = bitRows.data() + (size_t)i * rowWords;
+            for (size_t w = 0; w < rowWords; ++w)
+                for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1)
+                    f((int)(w * 64 + __builtin_ctzll(bits)));
+            return;
+        }
+        if (!compressed)
+        {
+            for (size_t k = rowOffsets[i]; k < rowOffsets[i + 1]; ++k)
+                f(rowNeighbours[k]);
+            return;
+        }
+        const uint8_t *p = arena.data() + arenaOffsets[i];
+        const uint8_t *end = arena.data() + arenaOffsets[i + 1];
+        int j = 0;
+        while (p < end)
+        {
+            uint32_t gap = 0;
+            for (int shift = 0;; shift += 7)
+            {
+                const uint8_t byte = *p++;
+                gap |= (uint32_t)(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                    break;
+            }
+            j += (int)gap;
+            f(j);
+        }
+    }
+
+    /**
+     * @brief Calls f(j) for every neighbour row j of row i that is not deleted, in the order of `ForEachNeighbour`.
+     */
+    template <typename F>
+    void ForEachLiveNeighbour(int i, F &&f) const
+    {
+        if (rowWords > 0)
+        {
+            const uint64_t *row = bitRows.data() + (size_t)i * rowWords;
+            for (size_t w = 0; w < rowWords; ++w)
+                for (uint64_t bits = row[w] & live[w]; bits != 0; bits &= bits - 1)
+                    f((int)(w * 64 + __builtin_ctzll(bits)));
+            return;
+        }
+        ForEachNeighbour(i, [&](int j) {
+            if (!deleted[j])
+                f(j);
+        });
+    }
+
+    void Unmap();
+
+    /**
+     * @brief Marks row i deleted.
+     */
+    void SetDeleted(int i)
+    {
+        deleted[i] = true;
+        if (rowWords > 0)
+            live[i / 64] &= ~(uint64_t(1) << (i % 64));
+    }
+
+    /**
+     * @brief `DelRowCol` for a row.
+     */
+    void DelRow(int row);
+
     /**
      * @brief Lazy deletion markers and degree tracker for O(1) MIS extraction.
      */
@@ -67,10 +211,20 @@ class AdjList
     int min_degree_tracker; // Tracks the minimum populated bucket
     int num_active_nodes; // Tracks remaining nodes
 
+    /**
+     * @brief Whether `MaskNodes` has set the degrees, which `RowsBySum` then keeps.
+     */
+    bool masked = false;
+
   public:
     // --- Public Member Functions ---
 
     AdjList() : min_degree_tracker(-1), num_active_nodes(0) {}
+    ~AdjList();
+
+    // A mapped graph owns its mapping
+    AdjList(const AdjList &) = delete;
+    AdjList &operator=(const AdjList &) = delete;
 
     /**
      * @brief Allocates all memory to perfectly fit the node bounds.
@@ -83,6 +237,46 @@ class AdjList
      */
     void RowsBySum();
 
+    /**
+     * @brief Restricts the graph to the subgraph induced by the nodes with `active[i]` set, for the next `RowsBySum`.
+     * @details Resets the deletion state from `active` and counts each active node's active neighbours as its degree,
+     * so the greedy runs on the induced subgraph exactly as on a graph built over the active nodes alone. The neighbour
+     * lists are not touched, so one built graph serves any number of masks.
+     * @return The number of neighbour entries in the induced subgraph.
+     */
+    size_t MaskNodes(const std::vector<bool> &active);
+
+    /**
+     * @brief Whether node i has not been deleted (or masked out).
+     */
+    bool Active(int i) const
+    {
+        return !deleted[Row(i)];
+    }
+
+    /**
+     * @brief Calls f(j) for every active neighbour j of node i, in the order of the row; both in node ids.
+     */
+    template <typename F>
+    void ForEachActiveNeighbour(int i, F &&f) const
+    {
+        ForEachLiveNeighbour(Row(i), [&](int j) { f(Node(j)); });
+    }
+
+    /**
+     * @brief Stores the rows in a cache-friendlier order for the greedy: "degree" (ascending degree), "rcm" (reverse
+     * Cuthill-McKee) or "bfs" (breadth-first from the lowest node of every component); "none" keeps node order.
+     * @details Permutes the CSR rows and the per-node state so that the rows the greedy touches together (a node and
+     * its neighbours) lie close together in memory. Node ids are translated at the public interface and each row keeps
+     * its neighbours in node order, and `RowsBySum` fills the buckets in node order, so every tie is broken as before
+     * and the codebook does not change. A mapped graph (e.g. from the graph cache) is copied to RAM in the new order;
+     * call `RowsBySum` afterwards.
+     * @return False when the order is "none", the storage is compressed or a bit matrix, or the graph is kept out of
+     * core (an external budget is set); the graph is then left as it is.
+     * Throws `std::runtime_error` on an unknown order.
+     */
+    bool Relabel(const std::string &vertexOrder);
+
     /**
      * @brief Finds and returns the index of a node with the current minimum degree.
      * @return The integer index of a row/node with the minimum sum. Asserts if the graph is empty.
@@ -98,14 +292,14 @@ class AdjList
     /**
      * @brief Updates `rowsBySum` by moving a row from its current degree-group to the next lower one.
      * @param currentSum The current degree of the row.
-     * @param row The index of the row whose degree has decreased.
+     * @param row The storage row (see `Relabel`) whose degree has decreased.
      */
     void DecreaseSum(const int currentSum, const int row);
 
     /**
      * @brief Removes a row entirely from the `rowsBySum` map.
      * @param currentSum The degree of the row being removed.
-     * @param row The index of the row to remove.
+     * @param row The storage row (see `Relabel`) to remove.
      */
     void DeleteRow(const int currentSum, const int row);
 
@@ -128,12 +322,118 @@ class AdjList
     int RowNum() const;
 
     /**
-     * @brief Adds an edge to the graph by setting the matrix entry (row, col) to 1.
-     * Since the graph is symmetric, you typically call Set(row, col) and Set(col, row).
-     * @param row The index of the first node.
-     * @param col The index of the second node.
+     * @brief Selects plain or compressed neighbour storage for the next `Build` (which every in-memory builder, the GPU
+     * backend included, ends in) or `FromFile`.
+     * @details Compressed lists take typically one to two bytes per entry instead of four (a gap takes one byte per 7
+     * bits, so at most three below 2^21 nodes) and are decoded on the fly by `DelRowCol` and `DelBall`; degrees come
+     * from `offsets` in both modes.
+     */
+    void SetCompressed(bool enable)
+    {
+        compressed = enable;
+    }
+
+    /**
+     * @brief Selects out-of-core construction within `budgetBytes` (0 for in RAM) for the next `FillAdjList`, whether
+     * the CPU builders or the GPU backend fill it.
+     * @details The edges are spilled to sorted runs, merged into a CSR file and mapped with `MapFile`; this takes
+     * precedence over compressed storage.
+     */
+    void SetExternalMemory(size_t budgetBytes)
+    {
+        externalBudget = budgetBytes;
+    }
+
+    /**
+     * @brief Lets the next in-RAM plain `Build` store the graph as a bit matrix of up to `budgetBytes` (0 never).
+     * @details The matrix takes n^2 / 8 bytes and is chosen when that fits the budget and is no larger than the
+     * neighbour lists would be, i.e. for small dense graphs such as clusters. `DelBall` and the degree updates then
+     * find a row's active neighbours by ANDing it with the live-node mask a word at a time. The greedy visits the
+     * neighbours in the same ascending order, so the codebook is the same either way.
+     */
+    void SetBitsetBudget(size_t budgetBytes)
+    {
+        bitsetBudget = budgetBytes;
+    }
+
+    /** @brief Whether the graph is stored as a bit matrix. */
+    bool Bitset() const
+    {
+        return rowWords > 0;
+    }
+
+    /** @brief The out-of-core memory budget in bytes (0 when building in RAM). */
+    size_t ExternalBudget() const
+    {
+        return externalBudget;
+    }
+
+    /** @brief Whether the neighbour lists are read from a mapped CSR file. */
+    bool Mapped() const
+    {
+        return mapping != nullptr;
+    }
+
+    /**
+     * @brief Replaces the edges with those in `edgeLists`, for the node count set by `Init`.
+     * @details Two passes, both parallel over chunks of the edge sequence: each chunk counts its entries per node, a
+     * prefix sum over the nodes and then the chunks gives every chunk its own write cursor per node, and the chunks
+     * fill the neighbour array in place. Every list is then sorted, so the graph (and the greedy's tie-breaks) does
+     * not depend on how the edges were split over threads. Compressed storage fills and encodes the nodes in batches
+     * of about an eighth of the entries (at least 2^20), so the plain lists never exist in full. Edges naming a node outside the graph
+     * are skipped.
+     * @param edgeLists The edges (u, v); the lists are read one after the other.
+     * @param threadNum Threads for the count and fill passes.
+     * @param symmetric Whether every edge is inserted in both directions; otherwise (u, v) only lists v under u.
+     */
+    void Build(const std::vector<std::vector<std::pair<int, int>>> &edgeLists, int threadNum, bool symmetric = true);
+
+    /**
+     * @brief Gets the number of stored neighbour entries (twice the edge count of a symmetric graph).
+     */
+    size_t EntryCount() const
+    {
+        return deleted.empty() ? 0 : rowOffsets[deleted.size()];
+    }
+
+    /**
+     * @brief Gets the bytes held by the neighbour lists (the varint arena when compressed, the mapped section when
+     * mapped, the bit matrix when stored as one).
+     */
+    size_t NeighbourBytes() const
+    {
+        if (rowWords > 0)
+            return bitRows.size() * sizeof(uint64_t);
+        return compressed ? arena.size() : EntryCount() * sizeof(int);
+    }
+
+    /**
+     * @brief Gets the number of nodes, deleted ones included.
+     */
+    size_t NodeCount() const
+    {
+        return deleted.size();
+    }
+
+    /**
+     * @brief Replaces the graph with the CSR section (see `CsrFileHeader`) starting `offset` bytes into `filename`,
+     * mapped read-only.
+     * @details Only the degree, bucket and deletion state is allocated; the neighbour lists are paged in from the file
+     * as the greedy reads them. The file may be removed once mapped. Throws `std::runtime_error` on I/O failure or a
+     * malformed file.
+     */
+    void MapFile(const std::string &filename, size_t offset = 0);
+
+    /**
+     * @brief Writes the graph as built (deletions ignored) as a CSR section that `MapFile` reads back.
      */
-    void Set(int row, int col);
+    void WriteCsr(std::ostream &output) const;
+
+    /**
+     * @brief Merges the sorted edge runs (see `EdgeRunWriter`) into the CSR file `csrFile`, maps it and removes it,
+     * for the node count set by `Init`.
+     */
+    void BuildFromRuns(const std::vector<std::string> &runs, const std::string &csrFile);
 
     /**
      * @brief Removes a node and all its incident edges from the graph.
@@ -174,6 +474,32 @@ class AdjList
      */
     int FindMaxDel(std::vector<bool> &remaining, double &maxSumRowTime, double &delRowColTime);
 
+    /**
+     * @brief Runs the min-degree greedy in parallel rounds on `threadNum` threads, starting from the degrees set by
+     * `RowsBySum`; the graph itself is left as it is.
+     * @details Each round takes the minimum degree dmin over the active nodes and calls a node eligible when its
+     * degree is at most `dmin + degreeWindow * dmin`. An eligible node is chosen when it precedes all its eligible
+     * neighbours in (degree, hashed node id, node id) order, so the chosen nodes are pairwise non-adjacent and the
+     * first eligible node is always among them. The threads then delete the chosen nodes' balls, each neighbour
+     * claimed by one of them, and decrement the degrees of the surviving neighbours atomically; the touched nodes are
+     * put back into lazy degree buckets. Since the choice only depends on the exact degrees at the start of a round,
+     * the result is the same for any thread count.
+     * @param roundNum Set to the number of rounds.
+     * @return The chosen nodes, round by round and in ascending order within a round.
+     */
+    std::vector<int> ParallelGreedy(int threadNum, double degreeWindow, int &roundNum) const;
+
+    /**
+     * @brief Runs the sequential min-degree greedy on a private copy of the degrees and buckets set by `RowsBySum`, so
+     * that several passes can share the graph from different threads; the graph itself is left as it is.
+     * @details Pass 0 breaks ties as `FindMinDel` does (the last row of the minimum bucket) and gives the same nodes
+     * in the same order. Every other pass takes a uniformly random row of the minimum bucket, drawn from a generator
+     * seeded with the pass number. A pass holds one degree and one bucket position per node plus the buckets, about
+     * 12 bytes per node.
+     * @return The chosen nodes in the order they were chosen.
+     */
+    std::vector<int> GreedyPass(int pass) const;
+
     /**
      * @brief Serializes the adjacency list to a file.
      * @param filename The name of the file to save to.
@@ -185,14 +511,58 @@ class AdjList
      * @param filename The name of the file to load from.
      */
     void FromFile(const std::string &filename);
-
-    /**
-     * @brief Deserializes the adjacency list from a BINARY file (generated by Python GPU script).
-     * @param filename The name of the file to load from.
-     */
-    void FromBinaryFile(const std::string &filename, long long int &matrixOnesNum, bool silent = false);
 };
 
+// =================================================================================
+// SECTION: CONFLICT GRAPH CONSTRUCTION
+// =================================================================================
+
+/**
+ * @brief Builds the conflict graph of `candidates` on the CPU: an edge joins every pair closer than `minED`.
+ * @details `graph.builder` selects the engine ("allpairs", "ball", "segment" or "deletion"); an engine that does not
+ * apply to the candidates, or would be slower than the all-pairs scan, falls back to it, so every builder gives the
+ * same graph. Builds out of core when `adjList` has an external memory budget (see `AdjList::SetExternalMemory`).
+ * @param saveInterval Seconds between progress checkpoints (0 for none).
+ * @param resume Whether to continue from the checkpoints of an interrupted build.
+ * @param matrixOnesNum Receives the number of stored neighbour entries (twice the edge count).
+ */
+void FillAdjList(AdjList &adjList, const PackedCandidateSet &candidates, const int minED, const int threadNum,
+                 const int saveInterval, const bool resume, long long int &matrixOnesNum,
+                 const GraphParams &graph = GraphParams(), bool silent = false);
+
+/**
+ * @brief The command that starts the distance backend: the CUDA script, or this executable (`--graphWorker`) as its
+ * CPU stand-in when `INDEXGEN_BACKEND=cpu`. `RunGraphBackend` and `GraphWorker` append the descriptor arguments.
+ */
+std::vector<std::string> GraphBackendCommand(const int minED, const int threadNum, double maxGPUMemoryGB,
+                                             bool isBinary);
+
+/**
+ * @brief Builds the conflict graph of `candidates` with the distance backend (see GraphBackend.hpp).
+ * @details The edges stream in while the backend computes them; in RAM they are built once the stream ends, out of
+ * core (see `AdjList::SetExternalMemory`) every chunk is sorted and spilled as a run as soon as it arrives.
+ * @param matrixOnesNum Receives the number of stored neighbour entries (twice the edge count).
+ */
+void FillAdjListGPU(AdjList &adjList, const PackedCandidateSet &candidates, const int minED, const int threadNum,
+                    long long int &matrixOnesNum, double maxGPUMemoryGB = 10.0, bool silent = false,
+                    bool isBinary = false);
+
+/**
+ * @brief Builds the conflict graph of one cluster and returns the codebook the greedy extracts from it.
+ * @param useGPU Build the graph with the distance backend (`FillAdjListGPU`) rather than `FillAdjList`.
+ */
+PackedCandidateSet SolveIndependentSet(const PackedCandidateSet &candidates, const int minED, const int threadNum,
+                                       const bool useGPU, double maxGPUMemoryGB, const GraphParams &graph,
+                                       bool isBinary = false);
+
+/**
+ * @brief As `SolveIndependentSet`, for a cluster whose conflict edges a persistent worker already built.
+ * @param edges The (u, v) records in the cluster's own numbering; consumed.
+ */
+PackedCandidateSet SolveIndependentSetFromEdges(const PackedCandidateSet &candidates,
+                                                std::vector<std::pair<int, int>> &edges, const int threadNum,
+                                                const GraphParams &graph);
+
 // =================================================================================
 // SECTION: CODEBOOK GENERATION WORKFLOW
 // =================================================================================
@@ -209,6 +579,46 @@ class AdjList
  */
 void GenerateCodebookAdj(const Params &params);
 
+/**
+ * @brief Generates one codebook per minimum distance in `params.editDists` from a single distance-labelled graph.
+ * @details The all-pairs scan runs once at the largest distance and labels every conflict with its exact edit distance
+ * (one byte per edge). The graph for each smaller distance is derived by dropping the edges labelled at or above it,
+ * and each codebook is written to its own file, as a separate run with that `editDist` would write it. CPU only and
+ * not resumable; `params.codeMinED` is left at the largest distance. With a filter sweep set as well, every distance
+ * writes one codebook per filter cell (see `GenerateCodebooksAdjSweep`).
+ * @param params Generation parameters; `editDists` must not be empty.
+ */
+void GenerateCodebooksAdjLabelled(Params &params);
+
+/**
+ * @brief Generates one codebook per filter cell of `params.gcSweep` x `params.maxRunSweep` from a single graph.
+ * @details The conflict graph is built (or loaded from the graph cache) once over the unfiltered candidates, and every
+ * candidate's GC count and longest run are kept as its constraint signature. Each cell then masks out the candidates
+ * failing its filters and runs the greedy on the induced subgraph, which gives the codebook a separate run with the
+ * cell's filters would (for the deterministic generators, whose filtered candidates are the unfiltered ones in the
+ * same order). Each codebook is written to a subdirectory named after the cell, e.g. `GC0.3-0.7-RUN3`. CPU only and
+ * not resumable.
+ * @param params Generation parameters; at least one of the sweep lists must be set.
+ */
+void GenerateCodebooksAdjSweep(Params &params);
+
+/**
+ * @brief Builds shard `params.graphShardIndex` of `params.graphShardCount` of the conflict graph into the graph cache.
+ * @details Generates the candidates, scans every `graphShardCount`-th work item of the all-pairs triangle starting at
+ * the shard index, and commits the edges as sorted runs plus a manifest in `params.graph.cacheDir` (see
+ * GraphCache.hpp). A shard whose manifest is already there is skipped, and a shard that was interrupted is rebuilt
+ * from scratch, so every shard can be (re)started on its own. Runs within `graph.graphMemoryMB` when it is set.
+ * @param params Generation parameters; the graph cache directory must be set.
+ */
+void GenerateGraphShard(const Params &params);
+
+/**
+ * @brief Merges the finished shards of the conflict graph into its `.igraph` file in the graph cache.
+ * @details A later run with the same parameters and graph cache maps the merged graph instead of building it.
+ * @param params Generation parameters; the graph cache directory must be set.
+ */
+void GenerateGraphMerge(const Params &params);
+
 /**
  * @brief Resumes a previously interrupted codebook generation process from saved progress files.
  * @details It reads files like "progress_params.txt", "progress_stage.txt", etc.,
@@ -216,4 +626,21 @@ void GenerateCodebookAdj(const Params &params);
  */
 void GenerateCodebookAdjResumeFromFile();
 
+/**
+ * @brief Runs IndexGen as the CPU stand-in of the distance backend (`--graphWorker`; see GraphBackend.hpp).
+ * @details Reads the candidates from the inherited memory file `candidateFd`, builds the conflict pairs with the
+ * all-pairs engine and writes them to the pipe `edgeFd`. Selected over the CUDA scripts with `INDEXGEN_BACKEND=cpu`,
+ * so the binary hand-off can be exercised without a GPU.
+ * @return The process exit status.
+ */
+int RunCpuGraphBackend(int candidateFd, int edgeFd, int minED, int threadNum);
+
+/**
+ * @brief Runs IndexGen as the CPU stand-in of a persistent backend worker (`--graphWorker --worker-fd`).
+ * @details Serves the job batches of `GraphWorker` from the socket `workerFd` until IndexGen shuts it down, building
+ * the jobs of a batch side by side on the `threadNum` threads.
+ * @return The process exit status.
+ */
+int RunCpuGraphWorker(int workerFd, int minED, int threadNum);
+
 #endif /* SPARSEMAT_HPP_ */
\ No newline at end of file
@@ -0,0 +1,69 @@
+/**
+ * @file TileScheduler.hpp
+ * @brief Lock-free work queue with stealing for handing out tiles of the pair triangle to the graph-building threads.
+ *
+ * Striding rows over threads (row i goes to thread i % threadNum) balances the number of rows, not the work: rows
+ * scan a shrinking suffix, and dense regions emit more pairs. The all-pairs engine instead cuts the upper triangle
+ * into fixed-size tiles and lets every thread pull tiles from a shared queue, so a thread only idles once the whole
+ * triangle is handed out.
+ */
+
+#ifndef TILESCHEDULER_HPP_
+#define TILESCHEDULER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @class TileQueue
+ * @brief Hands out a fixed list of work items to a fixed set of threads without locks.
+ * @details The items are dealt to the threads as contiguous ranges, so a thread first works through neighbouring
+ * tiles. Each range is one 64-bit atomic (begin << 32 | end): the owner pops from the front with a compare-and-swap,
+ * and a thread whose range is empty steals the back half of another thread's range with a compare-and-swap on the
+ * same word. Items are never put back, so a range value never repeats and the swaps are free of ABA.
+ */
+class TileQueue
+{
+  private:
+    struct alignas(64) Slot // one cache line per thread, so pops do not contend with the neighbours' pops
+    {
+        std::atomic<uint64_t> range;
+        std::atomic<long long int> steals;
+    };
+
+    std::vector<uint32_t> items;
+    std::unique_ptr<Slot[]> slots;
+    int threadNum;
+
+    static uint64_t Pack(uint64_t begin, uint64_t end)
+    {
+        return (begin << 32) | end;
+    }
+
+  public:
+    /**
+     * @brief Deals `items` to `threadNum` threads in contiguous, equally sized ranges.
+     * @param items The work items in the order they should preferably be processed.
+     * @param threadNum The number of threads that will call `Next`.
+     */
+    TileQueue(std::vector<uint32_t> items, int threadNum);
+
+    /**
+     * @brief Takes the next item for thread `threadIdx`: its own next item, or else one stolen from another thread.
+     * @return False once every item has been handed out.
+     */
+    bool Next(int threadIdx, uint32_t &item);
+
+    /** @brief The number of items the queue was built with. */
+    size_t size() const
+    {
+        return items.size();
+    }
+
+    /** @brief The number of successful steals so far, over all threads. */
+    long long int Steals() const;
+};
+
+#endif /* TILESCHEDULER_HPP_ */
@@ -14,6 +14,7 @@
 #define UTILS_HPP_
 
 #include "IndexGen.hpp"
+#include "PackedCandidates.hpp"
 #include <atomic>
 #include <chrono>
 #include <random>
@@ -104,11 +105,11 @@ int HammingDist(const string &str1, const string &str2);
 /**
  * @brief Verifies that all pairs of strings in a vector have at least a minimum edit distance.
  * @details This function is multi-threaded to speed up the verification process.
- * @param vecs A vector of strings to check.
+ * @param vecs The packed codewords to check.
  * @param minED The minimum required edit distance between any two strings.
  * @param threadNum The number of threads to use for the computation.
  */
-void VerifyDist(vector<string> &vecs, const int minED, const int threadNum, bool useGPU = false, double maxGPUMemoryGB = 10.0, bool isBinary = false);
+void VerifyDist(const PackedCandidateSet &vecs, const int minED, const int threadNum, bool useGPU = false, double maxGPUMemoryGB = 10.0, bool isBinary = false);
 
 /**
  * @brief Verifies that all pairs of strings in a vector have at least a minimum Hamming distance.
@@ -244,15 +245,18 @@ void PrintTestResults(const int candidateNum, const long long int matrixOnesNum,
 
 /**
  * @brief Writes a vector of codewords and test parameters to a formatted output file.
- * @param codeWords The vector of strings to write.
+ * @param codeWords The packed codewords to write (unpacked to text here).
  * @param params The parameters used to generate the codewords.
  * @param candidateNum The number of candidate strings.
  * @param matrixOnesNum The number of ones in the generation matrix.
+ * @param directory Subdirectory of the working directory to write the file to (created if needed); empty for the
+ * working directory itself.
  */
-void ToFile(const vector<string> &codeWords, const Params &params, const int candidateNum,
+void ToFile(const PackedCandidateSet &codeWords, const Params &params, const int candidateNum,
             const long long int matrixOnesNum, const chrono::duration<double> &candidatesTime,
             const chrono::duration<double> &fillAdjListTime, const chrono::duration<double> &processMatrixTime,
-            const chrono::duration<double> &overAllTime, int clusterK = -1, int clusterIterations = -1);
+            const chrono::duration<double> &overAllTime, int clusterK = -1, int clusterIterations = -1,
+            const string &directory = "");
 
 /**
  * @brief Serializes a `Params` struct to a file.
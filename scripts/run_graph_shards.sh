@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# Builds one conflict graph with several local IndexGen processes, merges the shards and solves.
+#
+# Usage: scripts/run_graph_shards.sh <shards> <graph cache dir> <output dir> [IndexGen arguments...]
+#   e.g. scripts/run_graph_shards.sh 8 /scratch/graphs Test/N16 --config configs/N16.json --threads 4
+#
+# Every shard process runs `IndexGen ... --graphCache <dir> --graph-shard i/S` and leaves its edges in the graph
+# cache. Shards that already finished are skipped, so the script can simply be run again after a failure. On a
+# cluster, submit one job per shard with the same arguments (e.g. through scripts/submit_job.sh) and run the merge
+# and solve steps below once they have all finished; the cache directory must be on a shared file system.
+
+# Note: INDEXGEN_ROOT is auto-detected by the binary from its executable location.
+
+if [ "$#" -lt 3 ]; then
+    echo "Usage: $0 <shards> <graph cache dir> <output dir> [IndexGen arguments...]"
+    exit 1
+fi
+
+EXECUTABLE="./IndexGen"
+SHARDS="$1"
+CACHE_DIR="$(realpath -m "$2")"
+OUTPUT_DIR="$3"
+shift 3
+
+mkdir -p "$OUTPUT_DIR"
+
+# --- 1. Build the shards side by side ---
+PIDS=()
+for ((i = 0; i < SHARDS; i++)); do
+    "$EXECUTABLE" "$@" --graphCache "$CACHE_DIR" --graph-shard "$i/$SHARDS" -d "$OUTPUT_DIR/shard-$i" \
+        > "$OUTPUT_DIR/shard-$i.log" 2>&1 &
+    PIDS+=($!)
+done
+
+FAILED=0
+for ((i = 0; i < SHARDS; i++)); do
+    if ! wait "${PIDS[$i]}"; then
+        echo "Shard $i/$SHARDS failed, see $OUTPUT_DIR/shard-$i.log"
+        FAILED=1
+    fi
+done
+if [ "$FAILED" -ne 0 ]; then
+    echo "Run the script again to rebuild the failed shards."
+    exit 1
+fi
+
+# --- 2. Merge the shards into the cached graph ---
+"$EXECUTABLE" "$@" --graphCache "$CACHE_DIR" --graph-merge -d "$OUTPUT_DIR/merge" > "$OUTPUT_DIR/merge.log" 2>&1 || {
+    echo "Merge failed, see $OUTPUT_DIR/merge.log"
+    exit 1
+}
+
+# --- 3. Solve on the merged graph ---
+"$EXECUTABLE" "$@" --graphCache "$CACHE_DIR" -d "$OUTPUT_DIR"
@@ -14,6 +14,8 @@ import argparse
 CONFIG_TEMPLATE = "random_bias_config.json"
 BASE_OUTPUT_DIR = "Test/Combinations_Len15"
 SUBMIT_SCRIPT = "submit_job.sh"
+# Conflict graphs shared by the runs; combinations that differ only in solver settings reuse each other's graph
+GRAPH_CACHE_DIR = "Test/GraphCache"
 TOPIC = "IndexGen-Newton"
 
 # Parameters
@@ -144,6 +146,9 @@ def main():
                     config['method']['linearCode']['biasMode'] = bias_mode
                     config['method']['linearCode']['rowPermMode'] = row_perm
                     config['method']['linearCode']['colPermMode'] = col_perm
+
+                    config['performance'] = dict(config.get('performance', {}))
+                    config['performance']['graph_cache_dir'] = os.path.abspath(GRAPH_CACHE_DIR)
                     
                     # Write run-specific config file
                     config_file_path = os.path.join(iteration_dir, "config.json")
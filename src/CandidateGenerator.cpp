@@ -21,6 +21,16 @@ using namespace std;
 // Base Class Implementation
 // ============================================================================
 
+bool CandidateGenerator::passesFilters(const std::string &str) const
+{
+    bool useMaxRunFilter = (params.maxRun > 0);
+    bool useGCFilter = (params.minGCCont > 0 || params.maxGCCont > 0);
+
+    bool passMaxRun = !useMaxRunFilter || (MaxRun(str) <= params.maxRun);
+    bool passGC = !useGCFilter || TestGCCont(str, params.minGCCont, params.maxGCCont);
+    return passMaxRun && passGC;
+}
+
 std::vector<std::string> CandidateGenerator::applyFilters(const std::vector<std::string> &unfiltered) const
 {
     std::vector<std::string> filtered;
@@ -37,10 +47,7 @@ std::vector<std::string> CandidateGenerator::applyFilters(const std::vector<std:
     // Apply filters
     for (const std::string &str : unfiltered)
     {
-        bool passMaxRun = !useMaxRunFilter || (MaxRun(str) <= params.maxRun);
-        bool passGC = !useGCFilter || TestGCCont(str, params.minGCCont, params.maxGCCont);
-
-        if (passMaxRun && passGC)
+        if (passesFilters(str))
         {
             filtered.push_back(str);
         }
@@ -49,6 +56,11 @@ std::vector<std::string> CandidateGenerator::applyFilters(const std::vector<std:
     return filtered;
 }
 
+PackedCandidateSet CandidateGenerator::generatePacked()
+{
+    return PackedCandidateSet::FromStrings(applyFilters(generate()));
+}
+
 // ============================================================================
 // LinearCodeGenerator Implementation
 // ============================================================================
@@ -169,6 +181,25 @@ std::vector<std::string> LinearCodeGenerator::generate()
     return codeWords;
 }
 
+PackedCandidateSet LinearCodeGenerator::generatePacked()
+{
+    initializeVectors(params.codeLen);
+
+    // Encode, filter and pack one codeword at a time; only the surviving candidates are ever stored
+    PackedCandidateSet codeWords(params.codeLen);
+    string word;
+    ForEachCodedVec(params.codeLen, candMinHD, bias, row_perm, col_perm,
+                    [&](const vector<int> &vec)
+                    {
+                        word.resize(vec.size());
+                        for (size_t i = 0; i < vec.size(); i++)
+                            word[i] = (char)('0' + vec[i]);
+                        if (passesFilters(word))
+                            codeWords.PushBack(word);
+                    });
+    return codeWords;
+}
+
 void LinearCodeGenerator::printInfo(std::ostream &output_stream) const
 {
     output_stream << "Using Generation Method: LinearCode (minHD=" << candMinHD << ")" << endl;
@@ -365,6 +396,28 @@ std::vector<std::string> AllStringsGenerator::generate()
     return result;
 }
 
+PackedCandidateSet AllStringsGenerator::generatePacked()
+{
+    PackedCandidateSet result(params.codeLen);
+    string word(params.codeLen, '0');
+    // Iterate through all base-4 numbers of length n, in the same order as generate()
+    while (true)
+    {
+        if (passesFilters(word))
+            result.PushBack(word);
+        int pos = params.codeLen - 1;
+        while (pos >= 0 && word[pos] == '3')
+        {
+            word[pos] = '0';
+            pos--;
+        }
+        if (pos < 0)
+            break;
+        word[pos]++;
+    }
+    return result;
+}
+
 void AllStringsGenerator::printInfo(std::ostream &output_stream) const
 {
     output_stream << "Using Generation Method: AllStrings" << endl;
@@ -11,6 +11,7 @@
 #include "Utils.hpp"
 #include <cassert>
 #include <iostream>
+#include <sstream>
 #include <thread>
 
 // --- Internal Generation and Filtering Functions ---
@@ -175,16 +176,76 @@ void FilterGCMaxRun(const vector<string> &strs, vector<string> &filteredStrs, co
 // --- Public Function Implementations ---
 
 // See Candidates.hpp for function documentation.
-std::vector<std::string> Candidates(const Params &params)
+PackedCandidateSet Candidates(const Params &params)
 {
     // Step 1: Create the appropriate generator using the factory function
     std::shared_ptr<CandidateGenerator> generator = CreateGenerator(params);
 
-    // Step 2: Generate candidates
-    std::vector<std::string> unfiltered = generator->generate();
+    // Step 2: Generate, filter and pack the candidates
+    return generator->generatePacked();
+}
 
-    // Step 3: Apply filters and return
-    return generator->applyFilters(unfiltered);
+// See Candidates.hpp for function documentation.
+vector<ConstraintSignature> ConstraintSignatures(const PackedCandidateSet &candidates, bool binary)
+{
+    vector<ConstraintSignature> signatures(candidates.size());
+    string word;
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        candidates.Unpack(i, word);
+        int content = 0;
+        for (char letter : word)
+        {
+            if (letter == '1' or (!binary and letter == '2'))
+                content++;
+        }
+        signatures[i].content = (uint16_t)content;
+        signatures[i].maxRun = (uint16_t)MaxRun(word);
+    }
+    return signatures;
+}
+
+// See Candidates.hpp for function documentation.
+string FilterCell::Label() const
+{
+    ostringstream label;
+    label << "GC" << minGCCont << "-" << maxGCCont << "-RUN" << maxRun;
+    return label.str();
+}
+
+// See Candidates.hpp for function documentation.
+vector<FilterCell> FilterCells(const Params &params)
+{
+    vector<FilterCell> cells;
+    if (params.maxRunSweep.empty() && params.gcSweep.empty())
+        return cells;
+    vector<pair<double, double>> ranges = params.gcSweep;
+    if (ranges.empty())
+        ranges.push_back(make_pair(params.minGCCont, params.maxGCCont));
+    vector<int> runs = params.maxRunSweep;
+    if (runs.empty())
+        runs.push_back(params.maxRun);
+    for (const pair<double, double> &range : ranges)
+    {
+        for (int run : runs)
+            cells.push_back(FilterCell{run, range.first, range.second});
+    }
+    return cells;
+}
+
+// See Candidates.hpp for function documentation.
+PackedCandidateSet UnfilteredCandidates(Params &params)
+{
+    // The generator keeps a reference to params, so the filters are switched off in place for the call
+    const int maxRun = params.maxRun;
+    const double minGCCont = params.minGCCont, maxGCCont = params.maxGCCont;
+    params.maxRun = 0;
+    params.minGCCont = params.maxGCCont = 0;
+    PackedCandidateSet candidates = Candidates(params);
+    params.maxRun = maxRun;
+    params.minGCCont = minGCCont;
+    params.maxGCCont = maxGCCont;
+    return candidates;
 }
 
 // See Candidates.hpp for function documentation.
@@ -192,21 +192,21 @@ vector<vector<int>> GenMat5(const int n)
 }
 
 /**
- * @brief Encodes a set of raw data vectors into codewords with a specific Hamming distance.
- * @param rawVecs The input data vectors.
- * @param codedVecs The output vector to store the resulting codewords.
- * @param n The length of the output codewords.
- * @param minHammDist The target minimum Hamming distance.
- * @param bias The bias vector to add to each codeword.
+ * @brief Builds the permuted generator matrix for a code of length n and prints the encoding setup.
+ * @param n The codeword length.
+ * @param minHammDist The minimum Hamming distance (from 2 to 5).
+ * @param bias The bias vector (only printed here; added by the caller).
  * @param row_perm The row permutation for the generator matrix.
  * @param col_perm The column permutation for the generator matrix.
+ * @param k Output: the dimension of the code (length of raw data vectors).
+ * @return The k x n generator matrix.
  */
-void CodeVecs(const vector<vector<int>> &rawVecs, vector<vector<int>> &codedVecs, const int n, const int minHammDist,
-              const vector<int> &bias, const vector<int> &row_perm, const vector<int> &col_perm)
+vector<vector<int>> PreparedGenMat(const int n, const int minHammDist, const vector<int> &bias,
+                                   const vector<int> &row_perm, const vector<int> &col_perm, int &k)
 {
     assert((minHammDist >= 2) && (minHammDist <= 5));
     vector<vector<int>> genMat;
-    int k = 0; // The dimension of the code (length of raw vectors)
+    k = 0;
 
     switch (minHammDist)
     {
@@ -235,8 +235,7 @@ void CodeVecs(const vector<vector<int>> &rawVecs, vector<vector<int>> &codedVecs
     genMat = PermuteRows(genMat, row_perm);
 
     // Determine if bias should be applied
-    bool useBias = !bias.empty();
-    if (useBias)
+    if (!bias.empty())
     {
         std::cout << "Using bias: ";
         for (const int &b : bias)
@@ -248,6 +247,25 @@ void CodeVecs(const vector<vector<int>> &rawVecs, vector<vector<int>> &codedVecs
         std::cout << "Not using bias addition." << std::endl;
     }
     std::cout << std::endl;
+    return genMat;
+}
+
+/**
+ * @brief Encodes a set of raw data vectors into codewords with a specific Hamming distance.
+ * @param rawVecs The input data vectors.
+ * @param codedVecs The output vector to store the resulting codewords.
+ * @param n The length of the output codewords.
+ * @param minHammDist The target minimum Hamming distance.
+ * @param bias The bias vector to add to each codeword.
+ * @param row_perm The row permutation for the generator matrix.
+ * @param col_perm The column permutation for the generator matrix.
+ */
+void CodeVecs(const vector<vector<int>> &rawVecs, vector<vector<int>> &codedVecs, const int n, const int minHammDist,
+              const vector<int> &bias, const vector<int> &row_perm, const vector<int> &col_perm)
+{
+    int k = 0; // The dimension of the code (length of raw vectors)
+    vector<vector<int>> genMat = PreparedGenMat(n, minHammDist, bias, row_perm, col_perm, k);
+    bool useBias = !bias.empty();
 
     // Multiply each raw data vector by the generator matrix to get the codeword
     for (const vector<int> &rawVec : rawVecs)
@@ -327,6 +345,42 @@ vector<vector<int>> CodedVecs(const int n, const int minHammDist, const vector<i
     return codedVecs;
 }
 
+// See LinearCodes.hpp for function documentation.
+void ForEachCodedVec(const int n, const int minHammDist, const vector<int> &bias, const vector<int> &row_perm,
+                     const vector<int> &col_perm, const function<void(const vector<int> &)> &visit)
+{
+    int k = 0;
+    vector<vector<int>> genMat = PreparedGenMat(n, minHammDist, bias, row_perm, col_perm, k);
+    bool useBias = !bias.empty();
+    if (k <= 0)
+        return;
+
+    // Same order as DataVecs(): base-4 counting with the last digit changing fastest, without materializing 4^k rows.
+    vector<int> rawVec(k, 0);
+    while (true)
+    {
+        vector<int> codedVec = MatMulGF4(rawVec, genMat, k, n);
+        if (useBias)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                codedVec[i] = AddGF4(codedVec[i], bias[i]);
+            }
+        }
+        visit(codedVec);
+
+        int pos = k - 1;
+        while (pos >= 0 && rawVec[pos] == 3)
+        {
+            rawVec[pos] = 0;
+            pos--;
+        }
+        if (pos < 0)
+            break;
+        rawVec[pos]++;
+    }
+}
+
 // Backward compatibility overload with default parameters
 vector<vector<int>> CodedVecs(const int n, const int minHammDist)
 {
@@ -0,0 +1,256 @@
+/**
+ * @file ConflictJoins.cpp
+ * @brief Implements the index structures used by the sub-quadratic conflict-graph builders.
+ */
+
+#include "ConflictJoins.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+int PackedAlphabetSize(const PackedCandidateSet &candidates)
+{
+    const size_t words = candidates.size() * (size_t)candidates.WordsPerSeq();
+    const uint64_t *data = candidates.empty() ? nullptr : candidates.Words(0);
+    uint64_t highBits = 0;
+    for (size_t w = 0; w < words; ++w)
+    {
+        highBits |= data[w] & 0xAAAAAAAAAAAAAAAAULL;
+    }
+    return highBits ? 4 : 2;
+}
+
+PackedWordIndex::PackedWordIndex(const PackedCandidateSet &candidates)
+{
+    if (!candidates.empty() && candidates.Length() >= PackedCandidateSet::kSymbolsPerWord)
+    {
+        throw std::invalid_argument("PackedWordIndex: candidates must be shorter than 32 symbols");
+    }
+    size_t slotNum = 16;
+    while (slotNum < 2 * candidates.size())
+        slotNum <<= 1;
+    slotMask = slotNum - 1;
+    slots.assign(slotNum, Slot());
+    next.assign(candidates.size(), -1);
+    const int bits = 2 * candidates.Length();
+    if (!candidates.empty() && bits <= 40 && ((1ULL << bits) / 8) <= kMaxPresenceBytes)
+        presence.assign(std::max((size_t)1, (size_t)((1ULL << bits) / 64)), 0ULL);
+
+    // Insert in reverse so every chain lists its indices in increasing order
+    for (size_t k = candidates.size(); k-- > 0;)
+    {
+        const uint64_t word = candidates.Words(k)[0];
+        uint64_t slot = Hash(word) & slotMask;
+        while (slots[slot].key != kEmpty && slots[slot].key != word)
+            slot = (slot + 1) & slotMask;
+        if (!presence.empty())
+            presence[word >> 6] |= 1ULL << (word & 63);
+        slots[slot].key = word;
+        next[k] = slots[slot].head;
+        slots[slot].head = (int)k;
+    }
+}
+
+size_t EditBallEnumerator::DistinctSize(uint64_t word) const
+{
+    std::vector<uint64_t> ball;
+    ForEach(word, [&](uint64_t neighbour) { ball.push_back(neighbour); });
+    std::sort(ball.begin(), ball.end());
+    return (size_t)(std::unique(ball.begin(), ball.end()) - ball.begin());
+}
+
+SegmentIndex::SegmentIndex(const PackedCandidateSet &candidates, int segmentNum) : len(candidates.Length())
+{
+    if (!Applicable(len, segmentNum))
+    {
+        throw std::invalid_argument("SegmentIndex: cannot split length " + std::to_string(len) + " into " +
+                                    std::to_string(segmentNum) + " segments");
+    }
+    const int tau = segmentNum - 1;
+    // PASS-JOIN layout: the first segments get floor(len / segments) symbols, the last len % segments one more
+    const int shortLen = len / segmentNum;
+    const int shortNum = segmentNum - len % segmentNum;
+    std::vector<std::pair<uint64_t, int>> entries(candidates.size());
+    int start = 0;
+    for (int s = 0; s < segmentNum; ++s)
+    {
+        const int segLen = shortLen + (s >= shortNum ? 1 : 0);
+        Segment seg;
+        seg.start = start;
+        seg.maxShift = std::min(tau / 2, tau - s);
+        seg.mask = (segLen == PackedCandidateSet::kSymbolsPerWord) ? ~0ULL : (1ULL << (2 * segLen)) - 1;
+        seg.first = std::max(0, start - seg.maxShift);
+        seg.last = std::min(len - segLen, start + seg.maxShift);
+        start += segLen;
+
+        for (size_t k = 0; k < entries.size(); ++k)
+            entries[k] = std::make_pair((candidates.Words(k)[0] >> (2 * seg.start)) & seg.mask, (int)k);
+        std::sort(entries.begin(), entries.end());
+        seg.ids.resize(entries.size());
+        seg.words.resize(entries.size());
+        for (size_t k = 0; k < entries.size(); ++k)
+        {
+            seg.ids[k] = entries[k].second;
+            seg.words[k] = candidates.Words(entries[k].second)[0];
+        }
+
+        const bool direct = 2 * segLen < 64 && (1ULL << (2 * segLen)) <= kMaxDirectKeys;
+        if (direct)
+        {
+            // offset[c] = first entry with content >= c
+            seg.offset.assign((1ULL << (2 * segLen)) + 1, 0);
+            size_t k = 0;
+            for (uint64_t c = 0; c < seg.offset.size(); ++c)
+            {
+                while (k < entries.size() && entries[k].first < c)
+                    ++k;
+                seg.offset[c] = (uint32_t)k;
+            }
+        }
+        else
+        {
+            for (size_t k = 0; k < entries.size(); ++k)
+            {
+                if (k == 0 || entries[k].first != entries[k - 1].first)
+                {
+                    seg.keys.push_back(entries[k].first);
+                    seg.offset.push_back((uint32_t)k);
+                }
+            }
+            seg.offset.push_back((uint32_t)entries.size());
+        }
+        segments.push_back(std::move(seg));
+    }
+}
+
+int SegmentIndex::ProbesPerQuery() const
+{
+    int probes = 0;
+    for (const Segment &seg : segments)
+        probes += seg.last - seg.first + 1;
+    return probes;
+}
+
+double SegmentIndex::ExpectedHitFraction(int alphabet) const
+{
+    double fraction = 0.0;
+    for (size_t s = 0; s < segments.size(); ++s)
+    {
+        const int segLen = ((s + 1 < segments.size()) ? segments[s + 1].start : len) - segments[s].start;
+        fraction += (segments[s].last - segments[s].first + 1) * std::pow((double)alphabet, -segLen);
+    }
+    return fraction;
+}
+
+int DeletionIndex::IndexBits(size_t candNum)
+{
+    int bits = 1;
+    while (bits < 32 && (1ULL << bits) < candNum)
+        ++bits;
+    return bits;
+}
+
+size_t DeletionIndex::MaxVariants(int len, int depth)
+{
+    size_t count = 1;
+    for (int k = 1; k <= depth; ++k)
+        count = count * (size_t)(len - depth + k) / (size_t)k;
+    return count;
+}
+
+void DeletionIndex::Variants(uint64_t word, int len, int depth, std::vector<uint64_t> &out)
+{
+    out.clear();
+    auto visit = [&](uint64_t variant) { out.push_back(variant); };
+    Delete(word, len, depth, visit);
+    // Deleting any symbol of a run gives the same string, so the same variant is reached several times
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+DeletionIndex::DeletionIndex(const PackedCandidateSet &candidates, int depth, int threadNum)
+    : len(candidates.Length()), depth(depth)
+{
+    if (!candidates.empty() && !Applicable(len, depth, candidates.size()))
+    {
+        throw std::invalid_argument("DeletionIndex: cannot index " + std::to_string(candidates.size()) +
+                                    " candidates of length " + std::to_string(len) + " at depth " +
+                                    std::to_string(depth));
+    }
+
+    // Every thread enumerates the variants of a contiguous block of candidates as (variant << idBits | index) keys
+    threadNum = std::max(1, threadNum);
+    const size_t candNum = candidates.size();
+    const int idBits = IndexBits(candNum);
+    std::vector<std::vector<uint64_t>> blocks(threadNum);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadNum; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            std::vector<uint64_t> variants;
+            for (size_t k = candNum * t / threadNum; k < candNum * (t + 1) / threadNum; ++k)
+            {
+                Variants(candidates.Words(k)[0], len, depth, variants);
+                for (uint64_t variant : variants)
+                    blocks[t].push_back((variant << idBits) | k);
+            }
+        });
+    }
+    for (std::thread &th : threads)
+        th.join();
+
+    std::vector<uint64_t> entries;
+    size_t total = 0;
+    for (const auto &block : blocks)
+        total += block.size();
+    entries.reserve(total);
+    for (auto &block : blocks)
+    {
+        entries.insert(entries.end(), block.begin(), block.end());
+        std::vector<uint64_t>().swap(block);
+    }
+
+    // LSD radix sort on the used key bits, 11 at a time
+    const int keyBits = 2 * (len - depth) + idBits;
+    std::vector<uint64_t> buffer(entries.size());
+    for (int shift = 0; shift < keyBits; shift += 11)
+    {
+        std::vector<size_t> count(2049, 0);
+        for (uint64_t e : entries)
+            ++count[((e >> shift) & 2047) + 1];
+        for (size_t d = 1; d < count.size(); ++d)
+            count[d] += count[d - 1];
+        for (uint64_t e : entries)
+            buffer[count[(e >> shift) & 2047]++] = e;
+        entries.swap(buffer);
+    }
+    std::vector<uint64_t>().swap(buffer);
+
+    const uint64_t idMask = (1ULL << idBits) - 1;
+    ids.resize(entries.size());
+    for (size_t k = 0; k < entries.size(); ++k)
+    {
+        ids[k] = (int)(entries[k] & idMask);
+        if (k == 0 || (entries[k] >> idBits) != (entries[k - 1] >> idBits))
+            offset.push_back((uint32_t)k);
+    }
+    offset.push_back((uint32_t)entries.size());
+
+    size_t slotNum = 16;
+    while (slotNum < 2 * VariantCount())
+        slotNum <<= 1;
+    slotMask = slotNum - 1;
+    slots.assign(slotNum, Slot());
+    for (size_t list = 0; list < VariantCount(); ++list)
+    {
+        const uint64_t key = entries[offset[list]] >> idBits;
+        uint64_t slot = Hash(key) & slotMask;
+        while (slots[slot].key != kEmpty)
+            slot = (slot + 1) & slotMask;
+        slots[slot].key = key;
+        slots[slot].list = (uint32_t)list;
+    }
+}
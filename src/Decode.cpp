@@ -4,6 +4,7 @@
  */
 
 #include "Decode.hpp" // Use the new documented header
+#include "MetricIndex.hpp"
 #include "Utils.hpp"
 #include <fstream>
 #include <iostream>
@@ -50,62 +51,39 @@ void CodebookFromFile(const string &filename, vector<string> &codebook)
 
 /**
  * @brief Finds the single closest codeword in the codebook to a given received word.
- * @details This is the core nearest-neighbor search. It iterates through the entire codebook,
- * calculating the edit distance for each entry and keeping track of the minimum distance found.
- * It uses an optimized edit distance function (`FastEditDistance0123ForSearch`) that can
- * terminate early if the distance is guaranteed to be greater than the current minimum.
+ * @details This is the core nearest-neighbor search. The metric index rules most codewords out with its pivot
+ * lower bounds and runs the banded edit distance, capped at the best distance so far, on the rest.
+ * Ties are broken towards the codeword listed first in the codebook.
  * @param codebook The vector of all valid codewords.
- * @param cont0123Code Pre-computed character counts for each codeword to speed up distance calculation.
+ * @param index The metric index built over `codebook`, in the same order.
  * @param receivedWord The word to find the closest match for.
- * @param cont0123Rec Pre-computed character counts for the received word.
- * @param codeLen The length of the codewords.
  * @return The codeword from the codebook that has the minimum edit distance to `receivedWord`.
  */
-string ClosestWord(const vector<string> &codebook, const vector<vector<char>> &cont0123Code,
-				   const string &receivedWord, const vector<char> &cont0123Rec, const int codeLen)
+string ClosestWord(const vector<string> &codebook, const MetricIndex &index, const string &receivedWord)
 {
-	int codeSize = codebook.size();
-	int minED = codeLen + 1;
-	int closestCodewordIdx = -1;
-	for (int i = 0; i < codeSize; i++)
-	{
-		// Use the optimized search that exits early if ED will be >= minED
-		int currED = FastEditDistance0123ForSearch(receivedWord, codebook[i], minED, cont0123Rec, cont0123Code[i]);
-		if (currED != -1)
-		{ // A new minimum distance was found
-			minED = currED;
-			closestCodewordIdx = i;
-			if (minED <= 1)
-			{ // Optimization: if distance is 1 or 0, we can't do better.
-				break;
-			}
-		}
-	}
-	assert(closestCodewordIdx != -1); // Should always find at least one match
-	return codebook[closestCodewordIdx];
+	vector<pair<int, int>> nearest = index.Nearest(receivedWord, 1);
+	assert(!nearest.empty()); // Should always find at least one match
+	return codebook[nearest[0].first];
 }
 
 /**
  * @brief A wrapper function that first checks for an exact match before performing a full search.
  * @param codebook The vector of all valid codewords.
- * @param cont0123Code Pre-computed character counts for the codebook.
+ * @param index The metric index built over `codebook`.
  * @param codebookSet An unordered_set of the codebook for fast O(1) average time lookups.
  * @param receivedWord The word to decode.
- * @param cont0123Rec Pre-computed character counts for the received word.
- * @param codeLen The length of the codewords.
  * @return The decoded codeword. Returns the `receivedWord` itself if it's an exact match, otherwise
  * calls `ClosestWord` to perform a full search.
  */
-string NearestCodeword(const vector<string> &codebook, const vector<vector<char>> &cont0123Code,
-					   const unordered_set<string> &codebookSet, const string &receivedWord, const vector<char> &cont0123Rec,
-					   const int codeLen)
+string NearestCodeword(const vector<string> &codebook, const MetricIndex &index,
+					   const unordered_set<string> &codebookSet, const string &receivedWord)
 {
 	// Optimization: If the received word is already a valid codeword, return it immediately.
 	if (codebookSet.count(receivedWord))
 	{
 		return receivedWord;
 	}
-	return ClosestWord(codebook, cont0123Code, receivedWord, cont0123Rec, codeLen);
+	return ClosestWord(codebook, index, receivedWord);
 }
 
 /**
@@ -117,21 +95,18 @@ string NearestCodeword(const vector<string> &codebook, const vector<vector<char>
  * @param receivedWords The main list of received words (read-only).
  * @param decodedWords The main output list (write target).
  * @param codebookSet The hash set of the codebook (read-only).
- * @param cont0123Code Pre-computed character counts (read-only).
- * @param cont0123Received Pre-computed character counts (read-only).
- * @param codeLen Length of codewords.
+ * @param index The metric index over the codebook (read-only).
  * @param threadNum Total number of threads.
  * @param threadId The ID of the current thread (from 0 to threadNum-1).
  */
 void DecodeThread(const vector<string> &codebook, const vector<string> &receivedWords, vector<string> &decodedWords,
-				  const unordered_set<string> &codebookSet, const vector<vector<char>> &cont0123Code,
-				  const vector<vector<char>> &cont0123Received, const int codeLen, const int threadNum, const int threadId)
+				  const unordered_set<string> &codebookSet, const MetricIndex &index, const int threadNum,
+				  const int threadId)
 {
 	int receivedWordsNum = receivedWords.size();
 	for (int i = threadId; i < receivedWordsNum; i += threadNum)
 	{
-		decodedWords[i] = NearestCodeword(codebook, cont0123Code, codebookSet, receivedWords[i], cont0123Received[i],
-										  codeLen);
+		decodedWords[i] = NearestCodeword(codebook, index, codebookSet, receivedWords[i]);
 	}
 }
 
@@ -144,17 +119,20 @@ void Decode(const vector<string> &codebook, const vector<string> &receivedWords,
 
 	int receivedWordsNum = receivedWords.size();
 	decodedWords.resize(receivedWordsNum);
+	if (codebook.empty())
+	{
+		return;
+	}
 
 	// Pre-computation steps for optimization
-	vector<vector<char>> cont0123Code = Cont0123(codebook);
-	vector<vector<char>> cont0123Received = Cont0123(receivedWords);
+	const MetricIndex index(PackedCandidateSet::FromStrings(codebook), threadNum);
 	unordered_set<string> codebookSet(codebook.begin(), codebook.end());
 
 	if (threadNum <= 1)
 	{ // Use a single thread
 		for (int i = 0; i < receivedWordsNum; i++)
 		{
-			decodedWords[i] = NearestCodeword(codebook, cont0123Code, codebookSet, receivedWords[i], cont0123Received[i], codeLen);
+			decodedWords[i] = NearestCodeword(codebook, index, codebookSet, receivedWords[i]);
 		}
 	}
 	else
@@ -162,9 +140,8 @@ void Decode(const vector<string> &codebook, const vector<string> &receivedWords,
 		vector<thread> threads;
 		for (int threadId = 0; threadId < threadNum; threadId++)
 		{
-			threads.push_back(
-				thread(DecodeThread, ref(codebook), ref(receivedWords), ref(decodedWords), ref(codebookSet), ref(cont0123Code),
-					   ref(cont0123Received), codeLen, threadNum, threadId));
+			threads.push_back(thread(DecodeThread, ref(codebook), ref(receivedWords), ref(decodedWords),
+									 ref(codebookSet), ref(index), threadNum, threadId));
 		}
 		for (thread &th : threads)
 		{
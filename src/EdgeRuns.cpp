@@ -0,0 +1,268 @@
+/**
+ * @file EdgeRuns.cpp
+ * @brief Implements run spilling and the k-way merge into a CSR file.
+ */
+
+#include "EdgeRuns.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <filesystem>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+
+namespace
+{
+// Runs one merge keeps open; more runs are merged in groups of this size first
+constexpr size_t kMaxFanIn = 256;
+
+// Smallest read buffer per run, in keys
+constexpr size_t kMinReadKeys = 1 << 13;
+
+// Output buffer of the CSR writer, in neighbours
+constexpr size_t kWriteInts = 1 << 20;
+
+// A pair buffer entry costs 8 bytes, and its two keys another 16 while the run is sorted
+constexpr size_t kSpillBytesPerPair = 24;
+
+uint64_t Key(int u, int v)
+{
+    return ((uint64_t)(uint32_t)u << 32) | (uint32_t)v;
+}
+
+void WriteRun(const std::vector<uint64_t> &keys, const std::string &filename)
+{
+    const std::string tmp = filename + ".tmp";
+    {
+        std::ofstream output(tmp, std::ios::binary);
+        output.write(reinterpret_cast<const char *>(keys.data()), keys.size() * sizeof(uint64_t));
+        if (!output)
+            throw std::runtime_error("EdgeRuns: failed writing " + tmp);
+    }
+    if (std::rename(tmp.c_str(), filename.c_str()) != 0)
+        throw std::runtime_error("EdgeRuns: cannot rename " + tmp);
+}
+
+// Buffered sequential reader over one run
+class RunReader
+{
+  private:
+    std::ifstream input;
+    std::vector<uint64_t> buffer;
+    size_t pos = 0, filled = 0;
+
+  public:
+    RunReader(const std::string &filename, size_t bufferKeys)
+        : input(filename, std::ios::binary), buffer(bufferKeys)
+    {
+        if (!input.is_open())
+            throw std::runtime_error("EdgeRuns: cannot open " + filename);
+    }
+
+    bool Next(uint64_t &key)
+    {
+        if (pos == filled)
+        {
+            input.read(reinterpret_cast<char *>(buffer.data()), buffer.size() * sizeof(uint64_t));
+            filled = (size_t)input.gcount() / sizeof(uint64_t);
+            pos = 0;
+            if (filled == 0)
+                return false;
+        }
+        key = buffer[pos++];
+        return true;
+    }
+};
+
+// Calls f(key) for the distinct keys of all runs in increasing order
+template <typename F> void MergeKeys(const std::vector<std::string> &runs, size_t budgetBytes, F &&f)
+{
+    const size_t bufferKeys =
+        std::max(kMinReadKeys, budgetBytes / std::max<size_t>(1, runs.size()) / sizeof(uint64_t));
+    std::vector<RunReader> readers;
+    readers.reserve(runs.size());
+    using Head = std::pair<uint64_t, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for (size_t r = 0; r < runs.size(); ++r)
+    {
+        readers.emplace_back(runs[r], bufferKeys);
+        uint64_t key;
+        if (readers[r].Next(key))
+            heads.push(Head(key, r));
+    }
+
+    bool any = false;
+    uint64_t last = 0;
+    while (!heads.empty())
+    {
+        const Head head = heads.top();
+        heads.pop();
+        if (!any || head.first != last)
+            f(head.first);
+        any = true;
+        last = head.first;
+        uint64_t key;
+        if (readers[head.second].Next(key))
+            heads.push(Head(key, head.second));
+    }
+}
+
+void RemoveRuns(const std::vector<std::string> &runs)
+{
+    for (const std::string &run : runs)
+        std::remove(run.c_str());
+}
+} // namespace
+
+EdgeRunWriter::EdgeRunWriter(const std::string &prefix_, size_t budgetBytes, int threadNum, bool resume)
+    : prefix(prefix_), spillPairs(std::max<size_t>(1, budgetBytes / std::max(1, threadNum) / kSpillBytesPerPair)),
+      nextRun(0)
+{
+    // Pick up (or clear away) the runs a previous attempt left behind; half-written .tmp files are never runs. A prefix
+    // with a directory part keeps its runs in that directory
+    const std::filesystem::path prefixPath(prefix);
+    const std::string dirName = prefixPath.has_parent_path() ? prefixPath.parent_path().string() : ".";
+    const std::string head = prefixPath.filename().string() + "_", tail = ".bin";
+    DIR *dir = opendir(dirName.c_str());
+    if (dir == nullptr)
+        return;
+    int maxRun = -1;
+    while (const dirent *entry = readdir(dir))
+    {
+        const std::string name = entry->d_name;
+        if (name.size() <= head.size() + tail.size() || name.compare(0, head.size(), head) != 0 ||
+            name.compare(name.size() - tail.size(), tail.size(), tail) != 0)
+            continue;
+        const std::string number = name.substr(head.size(), name.size() - head.size() - tail.size());
+        if (number.find_first_not_of("0123456789") != std::string::npos)
+            continue;
+        const std::string path = prefixPath.has_parent_path() ? (prefixPath.parent_path() / name).string() : name;
+        if (resume)
+        {
+            runs.push_back(path);
+            maxRun = std::max(maxRun, std::stoi(number));
+        }
+        else
+            std::remove(path.c_str());
+    }
+    closedir(dir);
+    nextRun.store(maxRun + 1);
+}
+
+void EdgeRunWriter::Spill(std::vector<std::pair<int, int>> &pairs)
+{
+    if (pairs.empty())
+        return;
+    std::vector<uint64_t> keys;
+    keys.reserve(2 * pairs.size());
+    for (const std::pair<int, int> &p : pairs)
+    {
+        keys.push_back(Key(p.first, p.second));
+        keys.push_back(Key(p.second, p.first));
+    }
+    pairs.clear();
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    const std::string filename = prefix + "_" + std::to_string(nextRun.fetch_add(1)) + ".bin";
+    WriteRun(keys, filename);
+    std::lock_guard<std::mutex> lock(runsMutex);
+    runs.push_back(filename);
+}
+
+std::vector<std::string> EdgeRunWriter::Runs()
+{
+    std::lock_guard<std::mutex> lock(runsMutex);
+    return runs;
+}
+
+size_t MergeEdgeRuns(std::vector<std::string> runs, size_t nodeNum, const std::string &csrFile, size_t budgetBytes,
+                     bool keepRuns)
+{
+    // The input runs are only removed once the CSR file is in place: a resumed build picks up `<prefix>_<k>.bin` runs
+    // alone, so a run dropped earlier would be lost to it. The intermediate runs of the cascade are only read by the
+    // next pass and are removed as soon as it has merged them
+    const std::vector<std::string> inputs = runs;
+    for (int pass = 0; runs.size() > kMaxFanIn; ++pass)
+    {
+        std::vector<std::string> merged;
+        for (size_t g = 0; g < runs.size(); g += kMaxFanIn)
+        {
+            const std::vector<std::string> group(runs.begin() + g, runs.begin() + std::min(runs.size(), g + kMaxFanIn));
+            const std::string filename = csrFile + ".merge" + std::to_string(pass) + "_" +
+                                         std::to_string(g / kMaxFanIn) + ".bin";
+            std::ofstream output(filename, std::ios::binary);
+            if (!output.is_open())
+                throw std::runtime_error("EdgeRuns: cannot open " + filename + " for writing");
+            std::vector<uint64_t> buffer;
+            buffer.reserve(kWriteInts);
+            MergeKeys(group, budgetBytes, [&](uint64_t key) {
+                buffer.push_back(key);
+                if (buffer.size() == kWriteInts)
+                {
+                    output.write(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(uint64_t));
+                    buffer.clear();
+                }
+            });
+            output.write(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(uint64_t));
+            if (!output)
+                throw std::runtime_error("EdgeRuns: failed writing " + filename);
+            if (pass > 0)
+                RemoveRuns(group);
+            merged.push_back(filename);
+        }
+        runs.swap(merged);
+    }
+
+    // Header and offsets go in front of the neighbours; the offsets are only known once the merge is done. The file is
+    // written aside and renamed into place, so `csrFile` is always complete
+    const std::string tmp = csrFile + ".tmp";
+    CsrFileHeader header;
+    {
+        std::ofstream output(tmp, std::ios::binary);
+        if (!output.is_open())
+            throw std::runtime_error("EdgeRuns: cannot open " + tmp + " for writing");
+        std::memcpy(header.magic, CsrFileHeader::kMagic, sizeof(header.magic));
+        header.version = CsrFileHeader::kVersion;
+        header.nodeNum = nodeNum;
+        header.entryNum = 0;
+        std::vector<uint64_t> offsets(nodeNum + 1, 0);
+        output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        output.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(uint64_t));
+
+        std::vector<int32_t> buffer;
+        buffer.reserve(kWriteInts);
+        MergeKeys(runs, budgetBytes, [&](uint64_t key) {
+            const uint64_t u = key >> 32, v = key & 0xFFFFFFFFULL;
+            if (u >= nodeNum || v >= nodeNum)
+                return;
+            ++offsets[u + 1];
+            buffer.push_back((int32_t)v);
+            if (buffer.size() == kWriteInts)
+            {
+                output.write(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(int32_t));
+                buffer.clear();
+            }
+        });
+        output.write(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(int32_t));
+
+        for (size_t i = 0; i < nodeNum; ++i)
+            offsets[i + 1] += offsets[i];
+        header.entryNum = offsets[nodeNum];
+        output.seekp(0);
+        output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        output.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(uint64_t));
+        if (!output)
+            throw std::runtime_error("EdgeRuns: failed writing " + tmp);
+    }
+    if (std::rename(tmp.c_str(), csrFile.c_str()) != 0)
+        throw std::runtime_error("EdgeRuns: cannot rename " + tmp);
+
+    if (runs != inputs)
+        RemoveRuns(runs);
+    if (!keepRuns)
+        RemoveRuns(inputs);
+    return header.entryNum;
+}
@@ -0,0 +1,408 @@
+/**
+ * @file GraphBackend.cpp
+ * @brief Implements the candidate memory file, the edge pipe, the backend process and the persistent worker.
+ */
+
+#include "GraphBackend.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+// Writes all of `bytes`, retrying partial writes and interrupts
+void WriteAll(int fd, const void *data, size_t bytes, const char *what)
+{
+    const char *p = static_cast<const char *>(data);
+    while (bytes > 0)
+    {
+        const ssize_t n = write(fd, p, bytes);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw std::runtime_error(std::string("GraphBackend: failed writing ") + what + ": " + strerror(errno));
+        p += n;
+        bytes -= (size_t)n;
+    }
+}
+
+// Sends all of `bytes` to a socket; a peer that went away is an error rather than a SIGPIPE
+void SendAll(int fd, const void *data, size_t bytes, const char *what)
+{
+    const char *p = static_cast<const char *>(data);
+    while (bytes > 0)
+    {
+        const ssize_t n = send(fd, p, bytes, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw std::runtime_error(std::string("GraphBackend: failed sending ") + what + ": " + strerror(errno));
+        p += n;
+        bytes -= (size_t)n;
+    }
+}
+
+// Reads up to `bytes`, stopping early only at end of file
+size_t ReadFull(int fd, void *data, size_t bytes)
+{
+    char *p = static_cast<char *>(data);
+    size_t done = 0;
+    while (done < bytes)
+    {
+        const ssize_t n = read(fd, p + done, bytes - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            throw std::runtime_error(std::string("GraphBackend: failed reading from the backend: ") + strerror(errno));
+        if (n == 0)
+            break;
+        done += (size_t)n;
+    }
+    return done;
+}
+
+// Reads exactly `bytes`; the stream ending first is an error
+void ReadExact(int fd, void *data, size_t bytes, const char *what)
+{
+    if (ReadFull(fd, data, bytes) != bytes)
+        throw std::runtime_error(std::string("GraphBackend: the stream ended inside ") + what);
+}
+
+// Starts `args` with only `keepFds` of the close-on-exec descriptors inherited. Everything the child needs is prepared
+// before the fork: only async-signal-safe calls run between fork and exec
+pid_t StartBackend(std::vector<std::string> args, const std::vector<int> &keepFds, bool silent)
+{
+    std::vector<char *> cargs;
+    for (std::string &arg : args)
+        cargs.push_back(&arg[0]);
+    cargs.push_back(nullptr);
+
+    std::cout.flush();
+    const pid_t pid = fork();
+    if (pid < 0)
+        throw std::runtime_error(std::string("GraphBackend: fork failed: ") + strerror(errno));
+    if (pid == 0)
+    {
+        // Only this backend's descriptors survive the exec; the ones other threads hold are close-on-exec
+        for (int fd : keepFds)
+            fcntl(fd, F_SETFD, 0);
+        if (silent)
+        {
+            const int devNull = open("/dev/null", O_WRONLY);
+            if (devNull >= 0)
+            {
+                dup2(devNull, STDOUT_FILENO);
+                dup2(devNull, STDERR_FILENO);
+            }
+        }
+        execvp(cargs[0], cargs.data());
+        _exit(127);
+    }
+    return pid;
+}
+
+// Waits for the backend and throws unless it exited with status 0
+void WaitBackend(pid_t pid, const std::string &name)
+{
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+    {
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        throw std::runtime_error("GraphBackend: backend '" + name + "' failed (exit status " +
+                                 std::to_string(WIFEXITED(status) ? WEXITSTATUS(status) : -1) + ")");
+}
+} // namespace
+
+int CreateCandidateSegment(const PackedCandidateSet &candidates)
+{
+    const int fd = memfd_create("indexgen_candidates", MFD_CLOEXEC);
+    if (fd < 0)
+        throw std::runtime_error(std::string("GraphBackend: memfd_create failed: ") + strerror(errno));
+    CandidateSegmentHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CandidateSegmentHeader::kMagic, sizeof(header.magic));
+    header.version = CandidateSegmentHeader::kVersion;
+    header.candidateNum = candidates.size();
+    header.codeLen = (uint32_t)candidates.Length();
+    header.wordsPerSeq = (uint32_t)candidates.WordsPerSeq();
+    try
+    {
+        WriteAll(fd, &header, sizeof(header), "the candidate segment");
+        if (!candidates.empty())
+            WriteAll(fd, candidates.Words(0), candidates.size() * candidates.WordsPerSeq() * sizeof(uint64_t),
+                     "the candidate segment");
+    }
+    catch (...)
+    {
+        close(fd);
+        throw;
+    }
+    return fd;
+}
+
+PackedCandidateSet ReadCandidateSegment(int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CandidateSegmentHeader))
+        throw std::runtime_error("GraphBackend: candidate segment is missing or truncated");
+    const size_t bytes = (size_t)st.st_size;
+    void *mapping = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error(std::string("GraphBackend: cannot map the candidate segment: ") + strerror(errno));
+
+    CandidateSegmentHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    const size_t wordNum = header.candidateNum * header.wordsPerSeq;
+    if (std::memcmp(header.magic, CandidateSegmentHeader::kMagic, sizeof(header.magic)) != 0 ||
+        header.version != CandidateSegmentHeader::kVersion ||
+        header.wordsPerSeq != (header.codeLen + PackedCandidateSet::kSymbolsPerWord - 1) /
+                                  PackedCandidateSet::kSymbolsPerWord ||
+        bytes < sizeof(header) + wordNum * sizeof(uint64_t))
+    {
+        munmap(mapping, bytes);
+        throw std::runtime_error("GraphBackend: malformed candidate segment");
+    }
+
+    PackedCandidateSet candidates((int)header.codeLen);
+    candidates.reserve(header.candidateNum);
+    const uint64_t *words = reinterpret_cast<const uint64_t *>(static_cast<const char *>(mapping) + sizeof(header));
+    for (size_t i = 0; i < header.candidateNum; ++i)
+        candidates.PushBackWords(words + i * header.wordsPerSeq);
+    munmap(mapping, bytes);
+    return candidates;
+}
+
+void WriteEdgeRecords(int fd, const std::pair<int, int> *records, size_t count)
+{
+    static_assert(sizeof(std::pair<int, int>) == 2 * sizeof(int32_t), "edge records are written straight from pairs");
+    WriteAll(fd, records, count * sizeof(std::pair<int, int>), "edge records");
+}
+
+size_t RunGraphBackend(const std::vector<std::string> &argv, const PackedCandidateSet &candidates, size_t chunkPairs,
+                       bool silent, const std::function<void(std::vector<std::pair<int, int>> &)> &onChunk)
+{
+    const int candidateFd = CreateCandidateSegment(candidates);
+    int edgePipe[2];
+    if (pipe2(edgePipe, O_CLOEXEC) != 0)
+    {
+        close(candidateFd);
+        throw std::runtime_error(std::string("GraphBackend: pipe failed: ") + strerror(errno));
+    }
+
+    std::vector<std::string> args = argv;
+    args.push_back("--candidates-fd");
+    args.push_back(std::to_string(candidateFd));
+    args.push_back("--edges-fd");
+    args.push_back(std::to_string(edgePipe[1]));
+    pid_t pid;
+    try
+    {
+        pid = StartBackend(args, {candidateFd, edgePipe[1]}, silent);
+    }
+    catch (...)
+    {
+        close(candidateFd);
+        close(edgePipe[0]);
+        close(edgePipe[1]);
+        throw;
+    }
+    close(candidateFd);
+    close(edgePipe[1]);
+
+    size_t received = 0;
+    try
+    {
+        const size_t recordBytes = sizeof(std::pair<int, int>);
+        chunkPairs = std::max<size_t>(1, chunkPairs);
+        for (;;)
+        {
+            std::vector<std::pair<int, int>> chunk(chunkPairs);
+            const size_t bytes = ReadFull(edgePipe[0], chunk.data(), chunk.size() * recordBytes);
+            if (bytes % recordBytes != 0)
+                throw std::runtime_error("GraphBackend: the backend sent a partial edge record");
+            chunk.resize(bytes / recordBytes);
+            received += chunk.size();
+            if (!chunk.empty())
+                onChunk(chunk);
+            if (bytes < chunkPairs * recordBytes)
+                break;
+        }
+    }
+    catch (...)
+    {
+        kill(pid, SIGTERM);
+        close(edgePipe[0]);
+        waitpid(pid, nullptr, 0);
+        throw;
+    }
+    close(edgePipe[0]);
+    WaitBackend(pid, argv[0]);
+    return received;
+}
+
+GraphWorker::GraphWorker(const std::vector<std::string> &argv, bool silent)
+    : name(argv[0]), pid(-1), socketFd(-1), broken(false)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+        throw std::runtime_error(std::string("GraphBackend: socketpair failed: ") + strerror(errno));
+    std::vector<std::string> args = argv;
+    args.push_back("--worker-fd");
+    args.push_back(std::to_string(fds[1]));
+    try
+    {
+        pid = StartBackend(args, {fds[1]}, silent);
+    }
+    catch (...)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        throw;
+    }
+    close(fds[1]);
+    socketFd = fds[0];
+}
+
+GraphWorker::~GraphWorker()
+{
+    try
+    {
+        Stop(false);
+    }
+    catch (const std::exception &)
+    {
+    }
+}
+
+// Ends the conversation and reaps the process; `force` kills a worker that may be stuck inside a batch
+void GraphWorker::Stop(bool force)
+{
+    if (pid < 0)
+        return;
+    if (force)
+        kill(pid, SIGTERM);
+    shutdown(socketFd, SHUT_WR);
+    close(socketFd);
+    socketFd = -1;
+    const pid_t child = pid;
+    pid = -1;
+    if (force)
+    {
+        waitpid(child, nullptr, 0);
+        return;
+    }
+    try
+    {
+        WaitBackend(child, name);
+    }
+    catch (...)
+    {
+        broken = true;
+        throw;
+    }
+}
+
+void GraphWorker::Close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (broken)
+        throw std::runtime_error("GraphBackend: worker '" + name + "' failed");
+    Stop(false);
+}
+
+std::vector<std::vector<std::pair<int, int>>> GraphWorker::Run(const std::vector<const PackedCandidateSet *> &jobs)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (broken || pid < 0)
+        throw std::runtime_error("GraphBackend: worker '" + name + "' is not running");
+    std::vector<std::vector<std::pair<int, int>>> edges(jobs.size());
+    if (jobs.empty())
+        return edges;
+    try
+    {
+        JobBatchHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, JobBatchHeader::kMagic, sizeof(header.magic));
+        header.version = JobBatchHeader::kVersion;
+        header.jobNum = (uint32_t)jobs.size();
+        header.codeLen = (uint32_t)jobs[0]->Length();
+        header.wordsPerSeq = (uint32_t)jobs[0]->WordsPerSeq();
+        std::vector<uint64_t> counts;
+        for (const PackedCandidateSet *job : jobs)
+        {
+            if (job->Length() != (int)header.codeLen)
+                throw std::runtime_error("GraphBackend: the jobs of a batch must share one code length");
+            counts.push_back(job->size());
+        }
+        SendAll(socketFd, &header, sizeof(header), "a job batch");
+        SendAll(socketFd, counts.data(), counts.size() * sizeof(uint64_t), "a job batch");
+        for (const PackedCandidateSet *job : jobs)
+        {
+            if (!job->empty())
+                SendAll(socketFd, job->Words(0), job->size() * job->WordsPerSeq() * sizeof(uint64_t), "a job batch");
+        }
+
+        for (size_t j = 0; j < jobs.size(); ++j)
+        {
+            uint64_t edgeNum = 0;
+            ReadExact(socketFd, &edgeNum, sizeof(edgeNum), "a job reply");
+            const uint64_t n = jobs[j]->size();
+            if (edgeNum > n * (n - (n > 0)) / 2)
+                throw std::runtime_error("GraphBackend: the worker sent a malformed job reply");
+            edges[j].resize(edgeNum);
+            ReadExact(socketFd, edges[j].data(), edgeNum * sizeof(std::pair<int, int>), "a job reply");
+        }
+    }
+    catch (...)
+    {
+        broken = true;
+        Stop(true);
+        throw;
+    }
+    return edges;
+}
+
+bool ReadJobBatch(int fd, std::vector<PackedCandidateSet> &jobs)
+{
+    JobBatchHeader header;
+    const size_t got = ReadFull(fd, &header, sizeof(header));
+    if (got == 0)
+        return false;
+    if (got != sizeof(header) || std::memcmp(header.magic, JobBatchHeader::kMagic, sizeof(header.magic)) != 0 ||
+        header.version != JobBatchHeader::kVersion ||
+        header.wordsPerSeq != (header.codeLen + PackedCandidateSet::kSymbolsPerWord - 1) /
+                                  PackedCandidateSet::kSymbolsPerWord)
+        throw std::runtime_error("GraphBackend: malformed job batch");
+
+    std::vector<uint64_t> counts(header.jobNum);
+    ReadExact(fd, counts.data(), counts.size() * sizeof(uint64_t), "a job batch");
+    jobs.clear();
+    std::vector<uint64_t> words;
+    for (uint64_t count : counts)
+    {
+        words.resize(count * header.wordsPerSeq);
+        ReadExact(fd, words.data(), words.size() * sizeof(uint64_t), "a job batch");
+        jobs.emplace_back((int)header.codeLen);
+        jobs.back().reserve(count);
+        for (uint64_t i = 0; i < count; ++i)
+            jobs.back().PushBackWords(words.data() + i * header.wordsPerSeq);
+    }
+    return true;
+}
+
+void WriteJobEdges(int fd, const std::vector<std::pair<int, int>> &edges)
+{
+    const uint64_t edgeNum = edges.size();
+    SendAll(fd, &edgeNum, sizeof(edgeNum), "a job reply");
+    SendAll(fd, edges.data(), edges.size() * sizeof(std::pair<int, int>), "a job reply");
+}
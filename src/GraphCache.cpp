@@ -0,0 +1,309 @@
+/**
+ * @file GraphCache.cpp
+ * @brief Implements the candidate digest, the atomic `.igraph` reads and writes, and the graph shards.
+ */
+
+#include "GraphCache.hpp"
+#include "EdgeRuns.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace
+{
+// splitmix64 finalizer
+uint64_t Mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// The graph's file name without the .igraph extension; shard files start with it
+std::string GraphBaseName(const IGraphHeader &key)
+{
+    const std::string name = key.FileName();
+    return name.substr(0, name.size() - std::string(".igraph").size());
+}
+
+std::string ShardRunName(const std::string &prefix, uint32_t run)
+{
+    return prefix + "_" + std::to_string(run) + ".bin";
+}
+
+// Reads a shard manifest and checks that every run it names is in place with the recorded size
+bool ReadShardManifest(const std::string &path, GraphShardHeader &header)
+{
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open())
+        return false;
+    input.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!input || std::memcmp(header.magic, GraphShardHeader::kMagic, sizeof(header.magic)) != 0 ||
+        header.version != GraphShardHeader::kVersion || header.shardCount == 0 ||
+        header.shardIndex >= header.shardCount)
+        return false;
+    const std::string prefix = path.substr(0, path.size() - std::string(".manifest").size());
+    uint64_t bytes = 0;
+    std::error_code error;
+    for (uint32_t run = 0; run < header.runNum; ++run)
+    {
+        const uintmax_t size = std::filesystem::file_size(ShardRunName(prefix, run), error);
+        if (error)
+            return false;
+        bytes += size;
+    }
+    return bytes == header.keyNum * sizeof(uint64_t);
+}
+} // namespace
+
+IGraphHeader IGraphHeader::ForCandidates(const PackedCandidateSet &candidates, int minED)
+{
+    IGraphHeader key;
+    std::memset(&key, 0, sizeof(key));
+    std::memcpy(key.magic, kMagic, sizeof(key.magic));
+    key.version = kVersion;
+    key.candidateNum = candidates.size();
+    key.codeLen = (uint32_t)candidates.Length();
+    key.minED = (uint32_t)minED;
+    key.metric = kMetricEdit;
+
+    // Two independently seeded chains over every packed word, so the digest depends on the order of the candidates
+    uint64_t a = Mix(key.candidateNum ^ ((uint64_t)key.codeLen << 48));
+    uint64_t b = Mix(a ^ 0x9e3779b97f4a7c15ULL);
+    const size_t wordNum = candidates.size() * (size_t)candidates.WordsPerSeq();
+    const uint64_t *words = wordNum ? candidates.Words(0) : nullptr;
+    for (size_t w = 0; w < wordNum; ++w)
+    {
+        a = Mix(a ^ words[w]);
+        b = Mix(b + words[w] + 0x632be59bd9b4e019ULL);
+    }
+    key.digest[0] = a;
+    key.digest[1] = b;
+    return key;
+}
+
+bool IGraphHeader::SameGraph(const IGraphHeader &other) const
+{
+    return std::memcmp(magic, other.magic, sizeof(magic)) == 0 && version == other.version &&
+           digest[0] == other.digest[0] && digest[1] == other.digest[1] && candidateNum == other.candidateNum &&
+           codeLen == other.codeLen && minED == other.minED && metric == other.metric;
+}
+
+std::string IGraphHeader::FileName() const
+{
+    std::ostringstream name;
+    name << "L" << codeLen << "_ED" << minED << "_N" << candidateNum << "_" << std::hex << std::setfill('0')
+         << std::setw(16) << digest[0] << std::setw(16) << digest[1] << ".igraph";
+    return name.str();
+}
+
+bool LoadCachedGraph(AdjList &adjList, const std::string &cacheDir, const IGraphHeader &key)
+{
+    const std::string path = (std::filesystem::path(cacheDir) / key.FileName()).string();
+    IGraphHeader header;
+    {
+        std::ifstream input(path, std::ios::binary);
+        if (!input.is_open())
+            return false;
+        input.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (!input || !header.SameGraph(key))
+            return false;
+    }
+    try
+    {
+        adjList.MapFile(path, sizeof(IGraphHeader));
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << "Warning: ignoring graph cache file: " << e.what() << std::endl;
+        return false;
+    }
+    return adjList.Mapped() && adjList.NodeCount() == key.candidateNum;
+}
+
+std::string StoreCachedGraph(const AdjList &adjList, const std::string &cacheDir, const IGraphHeader &key)
+{
+    std::filesystem::create_directories(cacheDir);
+    const std::string path = (std::filesystem::path(cacheDir) / key.FileName()).string();
+    // A per-process temporary name: jobs storing the same graph at once each rename a complete file into place
+    const std::string tmp = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream output(tmp, std::ios::binary);
+        if (!output.is_open())
+            throw std::runtime_error("GraphCache: cannot open " + tmp + " for writing");
+        output.write(reinterpret_cast<const char *>(&key), sizeof(key));
+        adjList.WriteCsr(output);
+        if (!output)
+        {
+            std::remove(tmp.c_str());
+            throw std::runtime_error("GraphCache: failed writing " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("GraphCache: cannot rename " + tmp);
+    }
+    return path;
+}
+
+std::string GraphShardPrefix(const std::string &cacheDir, const IGraphHeader &key, int shardIndex, int shardCount)
+{
+    return (std::filesystem::path(cacheDir) / (GraphBaseName(key) + ".shard-" + std::to_string(shardIndex) + "-of-" +
+                                               std::to_string(shardCount)))
+        .string();
+}
+
+bool GraphShardDone(const std::string &cacheDir, const IGraphHeader &key, int shardIndex, int shardCount,
+                    bool compositionTiles)
+{
+    GraphShardHeader header;
+    return ReadShardManifest(GraphShardPrefix(cacheDir, key, shardIndex, shardCount) + ".manifest", header) &&
+           header.graph.SameGraph(key) && header.compositionTiles == (compositionTiles ? 1u : 0u);
+}
+
+void CommitGraphShard(const std::string &cacheDir, const IGraphHeader &key, int shardIndex, int shardCount,
+                      const GraphShardCut &cut, const std::vector<std::string> &runs)
+{
+    std::filesystem::create_directories(cacheDir);
+    const std::string prefix = GraphShardPrefix(cacheDir, key, shardIndex, shardCount);
+    GraphShardHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, GraphShardHeader::kMagic, sizeof(header.magic));
+    header.version = GraphShardHeader::kVersion;
+    header.graph = key;
+    header.shardIndex = (uint32_t)shardIndex;
+    header.shardCount = (uint32_t)shardCount;
+    header.runNum = (uint32_t)runs.size();
+    header.itemNum = cut.itemNum;
+    header.compositionTiles = cut.compositionTiles ? 1 : 0;
+    // Runs already under another run's name move aside first, so no rename overwrites a run still to be moved
+    std::vector<std::string> sources = runs;
+    for (uint32_t run = 0; run < header.runNum; ++run)
+    {
+        if (sources[run] == ShardRunName(prefix, run))
+            continue;
+        const std::string aside = ShardRunName(prefix, run) + ".commit";
+        if (std::rename(sources[run].c_str(), aside.c_str()) != 0)
+            throw std::runtime_error("GraphCache: cannot rename " + sources[run]);
+        sources[run] = aside;
+    }
+    for (uint32_t run = 0; run < header.runNum; ++run)
+    {
+        const std::string name = ShardRunName(prefix, run);
+        if (sources[run] != name && std::rename(sources[run].c_str(), name.c_str()) != 0)
+            throw std::runtime_error("GraphCache: cannot rename " + sources[run]);
+        header.keyNum += std::filesystem::file_size(name) / sizeof(uint64_t);
+    }
+
+    const std::string path = prefix + ".manifest";
+    const std::string tmp = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream output(tmp, std::ios::binary);
+        output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (!output)
+        {
+            std::remove(tmp.c_str());
+            throw std::runtime_error("GraphCache: failed writing " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("GraphCache: cannot rename " + tmp);
+    }
+}
+
+std::string MergeGraphShards(const std::string &cacheDir, const IGraphHeader &key, size_t budgetBytes)
+{
+    // Complete shards by shard count; leftovers of a run with another count are ignored
+    const std::string head = GraphBaseName(key) + ".shard-", tail = ".manifest";
+    std::map<uint32_t, std::map<uint32_t, std::string>> shards;
+    std::error_code error;
+    for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(cacheDir, error))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.size() <= head.size() + tail.size() || name.compare(0, head.size(), head) != 0 ||
+            name.compare(name.size() - tail.size(), tail.size(), tail) != 0)
+            continue;
+        GraphShardHeader header;
+        if (ReadShardManifest(entry.path().string(), header) && header.graph.SameGraph(key))
+            shards[header.shardCount][header.shardIndex] = entry.path().string();
+    }
+    if (error)
+        throw std::runtime_error("GraphCache: cannot read " + cacheDir + ": " + error.message());
+
+    const std::map<uint32_t, std::string> *complete = nullptr;
+    std::ostringstream missing;
+    for (const auto &count : shards)
+    {
+        if (count.second.size() == count.first)
+        {
+            complete = &count.second;
+            break;
+        }
+        missing << " " << count.first << " shards (missing";
+        for (uint32_t i = 0; i < count.first; ++i)
+        {
+            if (count.second.count(i) == 0)
+                missing << " " << i;
+        }
+        missing << ")";
+    }
+    if (complete == nullptr)
+        throw std::runtime_error("GraphCache: no complete set of shards for " + key.FileName() + " in " + cacheDir +
+                                 (shards.empty() ? std::string(": none found") : ":" + missing.str()));
+
+    // Shards cut from different triangles would leave some work items unscanned and others scanned twice
+    std::vector<std::string> runs, manifests;
+    GraphShardHeader first;
+    ReadShardManifest(complete->begin()->second, first);
+    for (const auto &shard : *complete)
+    {
+        GraphShardHeader header;
+        ReadShardManifest(shard.second, header);
+        if (header.itemNum != first.itemNum || header.compositionTiles != first.compositionTiles)
+            throw std::runtime_error("GraphCache: shards " + std::to_string(first.shardIndex) + " and " +
+                                     std::to_string(header.shardIndex) + " of " + key.FileName() +
+                                     " were cut from different triangles (" + std::to_string(first.itemNum) + " and " +
+                                     std::to_string(header.itemNum) + " work items, composition tiles " +
+                                     std::to_string(first.compositionTiles) + " and " +
+                                     std::to_string(header.compositionTiles) +
+                                     "): rebuild them with the same --compositionTiles");
+        const std::string prefix = shard.second.substr(0, shard.second.size() - tail.size());
+        for (uint32_t run = 0; run < header.runNum; ++run)
+            runs.push_back(ShardRunName(prefix, run));
+        manifests.push_back(shard.second);
+    }
+
+    const std::string igraph = (std::filesystem::path(cacheDir) / key.FileName()).string();
+    const std::string csr = igraph + ".csr.tmp." + std::to_string(getpid());
+    try
+    {
+        MergeEdgeRuns(runs, key.candidateNum, csr, budgetBytes, true);
+        AdjList adjList;
+        adjList.MapFile(csr);
+        StoreCachedGraph(adjList, cacheDir, key);
+    }
+    catch (...)
+    {
+        std::remove(csr.c_str());
+        throw;
+    }
+    std::remove(csr.c_str());
+    for (const std::string &run : runs)
+        std::remove(run.c_str());
+    for (const std::string &manifest : manifests)
+        std::remove(manifest.c_str());
+    return igraph;
+}
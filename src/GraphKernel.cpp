@@ -0,0 +1,273 @@
+/**
+ * @file GraphKernel.cpp
+ * @brief Implements the worklist reductions, the reduced-graph build and the reconstruction.
+ */
+
+#include "GraphKernel.hpp"
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+GraphKernel::GraphKernel(const AdjList &graph, int threadNum) : graph(graph), nodeNum((int)graph.NodeCount())
+{
+    alive.assign(nodeNum, 0);
+    degree.assign(nodeNum, 0);
+    parent.resize(nodeNum);
+    queued.assign(nodeNum, 0);
+    stamp.assign(nodeNum, 0);
+    mark.assign(nodeNum, 0);
+    for (int i = 0; i < nodeNum; ++i)
+    {
+        parent[i] = i;
+        alive[i] = graph.Active(i) ? 1 : 0;
+    }
+    vector<int> neighbours;
+    for (int i = 0; i < nodeNum; ++i)
+    {
+        if (!alive[i])
+            continue;
+        Collect(i, neighbours);
+        degree[i] = (int)neighbours.size();
+    }
+
+    // The worklist is a stack; pushing in descending order starts the reductions from the lowest node
+    for (int i = nodeNum - 1; i >= 0; --i)
+    {
+        if (alive[i])
+            Push(i);
+    }
+    while (!worklist.empty())
+    {
+        const int u = worklist.back();
+        worklist.pop_back();
+        queued[u] = 0;
+        if (!alive[u])
+            continue;
+        if (degree[u] <= 1)
+            Take(u);
+        else if (degree[u] == 2)
+        {
+            Collect(u, neighbours);
+            const int a = neighbours[0], b = neighbours[1];
+            // In a triangle N[u] lies inside both N[a] and N[b], so u is taken; otherwise u, a and b are folded
+            vector<int> smaller;
+            Collect(degree[a] <= degree[b] ? a : b, smaller);
+            if (find(smaller.begin(), smaller.end(), degree[a] <= degree[b] ? b : a) != smaller.end())
+                Take(u);
+            else
+                Fold(u, a, b);
+        }
+        else if (degree[u] <= kDominationDegree)
+            Dominate(u);
+    }
+
+    // The reduced graph: every node left, in id order, with the edges between them
+    const int total = (int)alive.size();
+    vector<int> kernelId(total, -1);
+    for (int x = 0; x < total; ++x)
+    {
+        if (!alive[x])
+            continue;
+        kernelId[x] = (int)kernelIds.size();
+        kernelIds.push_back(x);
+    }
+    vector<vector<pair<int, int>>> edgeLists(1);
+    for (int k = 0; k < (int)kernelIds.size(); ++k)
+    {
+        Collect(kernelIds[k], neighbours);
+        for (int z : neighbours)
+        {
+            if (kernelId[z] > k)
+                edgeLists[0].push_back(make_pair(k, kernelId[z]));
+        }
+    }
+    reduced.Init((int)kernelIds.size());
+    reduced.Build(edgeLists, threadNum);
+    reduced.RowsBySum();
+}
+
+int GraphKernel::Find(int node)
+{
+    int root = node;
+    while (parent[root] != root)
+        root = parent[root];
+    while (parent[node] != root)
+    {
+        const int next = parent[node];
+        parent[node] = root;
+        node = next;
+    }
+    return root;
+}
+
+void GraphKernel::Collect(int x, vector<int> &out)
+{
+    out.clear();
+    stamp[x] = ++stampNum;
+    auto visit = [&](int m) {
+        graph.ForEachActiveNeighbour(m, [&](int y) {
+            const int z = Find(y);
+            if (alive[z] && stamp[z] != stampNum)
+            {
+                stamp[z] = stampNum;
+                out.push_back(z);
+            }
+        });
+    };
+    if (x < nodeNum)
+        visit(x);
+    else
+    {
+        for (int m : members[x - nodeNum])
+            visit(m);
+    }
+}
+
+void GraphKernel::Push(int x)
+{
+    if (queued[x] || degree[x] > kDominationDegree)
+        return;
+    queued[x] = 1;
+    worklist.push_back(x);
+}
+
+void GraphKernel::Take(int u)
+{
+    vector<int> neighbours;
+    Collect(u, neighbours);
+    alive[u] = 0;
+    stack.push_back({u, -1, -1, -1});
+    ++takenNum;
+    for (int x : neighbours)
+        Remove(x);
+}
+
+void GraphKernel::Remove(int x)
+{
+    vector<int> neighbours;
+    Collect(x, neighbours);
+    alive[x] = 0;
+    ++removedNum;
+    for (int y : neighbours)
+    {
+        --degree[y];
+        Push(y);
+    }
+}
+
+void GraphKernel::Fold(int v, int a, int b)
+{
+    // The nodes adjacent to both a and b lose one neighbour when the two become one
+    vector<int> aNeighbours, bNeighbours, common;
+    Collect(a, aNeighbours);
+    Collect(b, bNeighbours);
+    ++markNum;
+    for (int x : aNeighbours)
+        mark[x] = markNum;
+    for (int x : bNeighbours)
+    {
+        if (x != v && mark[x] == markNum)
+            common.push_back(x);
+    }
+
+    const int w = (int)alive.size();
+    vector<int> inherited;
+    for (int y : {a, b})
+    {
+        if (y < nodeNum)
+            inherited.push_back(y);
+        else
+        {
+            vector<int> &absorbed = members[y - nodeNum];
+            inherited.insert(inherited.end(), absorbed.begin(), absorbed.end());
+            vector<int>().swap(absorbed);
+        }
+    }
+    members.push_back(move(inherited));
+    alive.push_back(1);
+    degree.push_back(0);
+    parent.push_back(w);
+    queued.push_back(0);
+    stamp.push_back(0);
+    mark.push_back(0);
+
+    alive[v] = alive[a] = alive[b] = 0;
+    parent[a] = parent[b] = w;
+    stack.push_back({v, a, b, w});
+    ++foldNum;
+
+    vector<int> neighbours;
+    Collect(w, neighbours);
+    degree[w] = (int)neighbours.size();
+    for (int x : common)
+    {
+        --degree[x];
+        Push(x);
+    }
+    Push(w);
+}
+
+bool GraphKernel::Dominate(int u)
+{
+    // v dominates u when N[u] is inside N[v]: every node of N[u] other than v, u included, is a neighbour of v
+    vector<int> neighbours, vNeighbours;
+    Collect(u, neighbours);
+    ++markNum;
+    mark[u] = markNum;
+    for (int x : neighbours)
+        mark[x] = markNum;
+    const int d = degree[u];
+    for (int v : neighbours)
+    {
+        if (degree[v] < d || degree[v] > kDominatorDegree)
+            continue;
+        Collect(v, vNeighbours);
+        int inside = 0;
+        for (int y : vNeighbours)
+            inside += mark[y] == markNum ? 1 : 0;
+        if (inside == d)
+        {
+            Remove(v);
+            ++dominatedNum;
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<int> GraphKernel::Lift(const vector<int> &kernelNodes) const
+{
+    vector<uint8_t> chosen(alive.size(), 0);
+    for (int k : kernelNodes)
+        chosen[kernelIds[k]] = 1;
+    for (auto record = stack.rbegin(); record != stack.rend(); ++record)
+    {
+        if (record->a < 0)
+            chosen[record->v] = 1;
+        else if (chosen[record->w])
+        {
+            chosen[record->w] = 0;
+            chosen[record->a] = chosen[record->b] = 1;
+        }
+        else
+            chosen[record->v] = 1;
+    }
+
+    // Every active node left without a chosen neighbour is added, in id order
+    vector<int> nodes;
+    for (int i = 0; i < nodeNum; ++i)
+    {
+        if (!graph.Active(i))
+            continue;
+        if (!chosen[i])
+        {
+            bool free = true;
+            graph.ForEachActiveNeighbour(i, [&](int j) { free = free && !chosen[j]; });
+            chosen[i] = free ? 1 : 0;
+        }
+        if (chosen[i])
+            nodes.push_back(i);
+    }
+    return nodes;
+}
@@ -8,6 +8,7 @@
  * the total execution time.
  */
 
+#include <algorithm>
 #include <chrono>
 #include <filesystem> // For directory creation
 #include <iomanip>
@@ -59,6 +60,16 @@ int main(int argc, char *argv[])
             return 0;
         }
 
+        // --- Distance backend worker (started by IndexGen itself; see GraphBackend.hpp) ---
+        if (result.count("graphWorker"))
+        {
+            if (result["worker-fd"].as<int>() >= 0)
+                return RunCpuGraphWorker(result["worker-fd"].as<int>(), result["editDist"].as<int>(),
+                                         result["threads"].as<int>());
+            return RunCpuGraphBackend(result["candidates-fd"].as<int>(), result["edges-fd"].as<int>(),
+                                      result["editDist"].as<int>(), result["threads"].as<int>());
+        }
+
         // --- Config Loading ---
         json config_json;
         string config_file_path;
@@ -177,11 +188,31 @@ int main(int argc, char *argv[])
         // Global / Core Mappings
         resolve_param("verify", params.verify, {"verify"});
         resolve_param("editDist", params.codeMinED, {"core", "editDist"});
+        resolve_param("editDists", params.editDists, {"core", "editDists"});
+        if (!params.editDists.empty())
+        {
+            // The largest distance is the one a single-distance path (clustering) falls back to
+            params.codeMinED = *max_element(params.editDists.begin(), params.editDists.end());
+            if (params.editDists.size() == 1)
+                params.editDists.clear();
+        }
 
         // Constraints
         resolve_param("maxRun", params.maxRun, {"constraints", "maxRun"});
         resolve_param("minGC", params.minGCCont, {"constraints", "minGC"});
         resolve_param("maxGC", params.maxGCCont, {"constraints", "maxGC"});
+        resolve_param("maxRunSweep", params.maxRunSweep, {"constraints", "maxRunSweep"});
+        // GC ranges come as a flat min,max,... list on the command line and as [min, max] pairs in the config
+        if (result.count("gcSweep"))
+        {
+            const vector<double> bounds = result["gcSweep"].as<vector<double>>();
+            if (bounds.size() % 2 != 0)
+                throw std::runtime_error("--gcSweep takes min,max pairs");
+            for (size_t i = 0; i < bounds.size(); i += 2)
+                params.gcSweep.push_back(make_pair(bounds[i], bounds[i + 1]));
+        }
+        else
+            get_json_val({"constraints", "gcSweep"}, params.gcSweep);
 
         // Performance
         resolve_param("threads", params.threadNum, {"performance", "threads"});
@@ -191,6 +222,56 @@ int main(int argc, char *argv[])
             params.useGPU = false;
         }
         resolve_param("maxGPUMemory", params.maxGPUMemoryGB, {"performance", "max_gpu_memory_gb"});
+        resolve_param("compositionTiles", params.graph.compositionTiles, {"performance", "composition_tiles"});
+        resolve_param("graphBuilder", params.graph.builder, {"performance", "graphBuilder"});
+        resolve_param("compressGraph", params.graph.compressGraph, {"performance", "compress_graph"});
+        resolve_param("graphMemoryMB", params.graph.graphMemoryMB, {"performance", "graph_memory_mb"});
+        resolve_param("graphCache", params.graph.cacheDir, {"performance", "graph_cache_dir"});
+        resolve_param("vertexOrder", params.graph.vertexOrder, {"performance", "vertex_order"});
+        resolve_param("bitsetMemoryMB", params.graph.bitsetMemoryMB, {"performance", "bitset_memory_mb"});
+        const string &vertexOrder = params.graph.vertexOrder;
+        if (vertexOrder != "none" && vertexOrder != "degree" && vertexOrder != "rcm" && vertexOrder != "bfs")
+            throw std::runtime_error("--vertexOrder takes none, degree, rcm or bfs");
+        if (!params.graph.cacheDir.empty() && filesystem::path(params.graph.cacheDir).is_relative())
+        {
+            // Relative to where the program was started, not the output directory it runs in
+            params.graph.cacheDir = (initial_cwd / params.graph.cacheDir).string();
+        }
+        if (result.count("graph-shard"))
+        {
+            // "i/S": this process builds shard i (counted from 0) of S
+            const string shard = result["graph-shard"].as<string>();
+            const size_t slash = shard.find('/');
+            try
+            {
+                if (slash == string::npos)
+                    throw std::invalid_argument(shard);
+                params.graphShardIndex = stoi(shard.substr(0, slash));
+                params.graphShardCount = stoi(shard.substr(slash + 1));
+            }
+            catch (const std::logic_error &)
+            {
+                throw std::runtime_error("--graph-shard takes i/S, e.g. 0/8");
+            }
+            if (params.graphShardCount < 1 || params.graphShardIndex < 0 ||
+                params.graphShardIndex >= params.graphShardCount)
+                throw std::runtime_error("--graph-shard i/S needs 0 <= i < S");
+        }
+        params.graphMerge = result["graph-merge"].as<bool>();
+        if (params.graphMerge && params.graphShardCount > 0)
+            throw std::runtime_error("--graph-shard and --graph-merge are separate steps");
+
+        // Solver
+        resolve_param("solver", params.solver.method, {"solver", "method"});
+        resolve_param("solverDegreeWindow", params.solver.degreeWindow, {"solver", "degreeWindow"});
+        resolve_param("solverRestarts", params.solver.restarts, {"solver", "restarts"});
+        resolve_param("kernelize", params.solver.kernel, {"solver", "kernelize"});
+        if (params.solver.method != "sequential" && params.solver.method != "parallel")
+            throw std::runtime_error("--solver takes sequential or parallel");
+        if (params.solver.restarts < 1)
+            throw std::runtime_error("--solverRestarts takes a positive number of passes");
+        if (params.solver.restarts > 1 && params.solver.method == "parallel")
+            throw std::runtime_error("--solverRestarts applies to the sequential solver");
 
         // Clustering
         resolve_param("cluster", params.clustering.enabled, {"clustering", "enabled"});
@@ -391,7 +472,17 @@ int main(int argc, char *argv[])
                  << " (Current Time: " << put_time(&local_tm, "%Y-%m-%d %H:%M:%S") << ") ---" << endl;
             params.codeLen = len;
 
-            GenerateCodebookAdj(params); 
+            const bool filterSweep = !params.maxRunSweep.empty() || !params.gcSweep.empty();
+            if (params.graphShardCount > 0)
+                GenerateGraphShard(params);
+            else if (params.graphMerge)
+                GenerateGraphMerge(params);
+            else if (!params.editDists.empty() && !params.clustering.enabled)
+                GenerateCodebooksAdjLabelled(params);
+            else if (filterSweep && !params.clustering.enabled)
+                GenerateCodebooksAdjSweep(params);
+            else
+                GenerateCodebookAdj(params);
             // GenerateCodebookMaxClique(params);
 
             auto finish_time = chrono::system_clock::now();
@@ -439,11 +530,17 @@ void configure_parser(cxxopts::Options &options)
         // Core Parameters
         ("s,lenStart", "Starting codeword length", cxxopts::value<int>()->default_value("10"))(
             "e,lenEnd", "Ending codeword length", cxxopts::value<int>()->default_value("10"))(
-            "D,editDist", "Minimum edit distance for the codebook", cxxopts::value<int>()->default_value("4"))
+            "D,editDist", "Minimum edit distance for the codebook", cxxopts::value<int>()->default_value("4"))(
+            "editDists", "Several minimum edit distances (e.g. 3,4,5), one codebook each from one labelled graph",
+            cxxopts::value<vector<int>>())
         // Biological Constraints
         ("maxRun", "Longest allowed homopolymer run", cxxopts::value<int>()->default_value("3"))(
             "minGC", "Minimum GC-content (0.0 to 1.0)", cxxopts::value<double>()->default_value("0.3"))(
-            "maxGC", "Maximum GC-content (0.0 to 1.0)", cxxopts::value<double>()->default_value("0.7"))
+            "maxGC", "Maximum GC-content (0.0 to 1.0)", cxxopts::value<double>()->default_value("0.7"))(
+            "maxRunSweep", "Run limits to sweep (e.g. 0,3,4), one codebook per filter cell from one graph",
+            cxxopts::value<vector<int>>())(
+            "gcSweep", "GC ranges to sweep as min,max pairs (e.g. 0,0,0.3,0.7), one codebook per filter cell",
+            cxxopts::value<vector<double>>())
         // Performance
         ("t,threads", "Number of threads to use", cxxopts::value<int>()->default_value("16"))(
             "saveInterval", "Interval in seconds to save progress", cxxopts::value<int>()->default_value("80000"))(
@@ -451,6 +548,32 @@ void configure_parser(cxxopts::Options &options)
             "gpu", "Use GPU for adjacency list generation", cxxopts::value<bool>()->default_value("true"))(
             "no-gpu", "Disable GPU for adjacency list generation", cxxopts::value<bool>()->default_value("false"))(
             "maxGPUMemory", "Maximum GPU memory to use in GB", cxxopts::value<double>()->default_value("10.0"))(
+            "compositionTiles", "Sort candidates by composition and skip provably compatible tile pairs (CPU)",
+            cxxopts::value<bool>()->default_value("true"))(
+            "graphBuilder", "CPU conflict-graph engine: allpairs, ball, segment, deletion",
+            cxxopts::value<string>()->default_value("allpairs"))(
+            "compressGraph", "Keep the conflict graph's neighbour lists delta + varint encoded",
+            cxxopts::value<bool>()->default_value("false"))(
+            "graphMemoryMB", "Build the conflict graph out of core within this many MB and memory-map it (0 = in RAM)",
+            cxxopts::value<int>()->default_value("0"))(
+            "graphCache", "Directory of cached conflict graphs, reused by runs over the same candidates (empty = off)",
+            cxxopts::value<string>()->default_value(""))(
+            "vertexOrder", "Row order of the conflict graph for the greedy: none, degree, rcm, bfs",
+            cxxopts::value<string>()->default_value("none"))(
+            "bitsetMemoryMB", "Store small dense conflict graphs as a bit matrix of up to this many MB (0 = never)",
+            cxxopts::value<int>()->default_value("64"))(
+            "solver", "Greedy of the codebook stage: sequential, parallel",
+            cxxopts::value<string>()->default_value("sequential"))(
+            "solverDegreeWindow", "Degree window of a parallel greedy round, relative to the minimum degree",
+            cxxopts::value<double>()->default_value("0"))(
+            "solverRestarts", "Sequential greedy passes with random tie-breaks over one graph; the largest codebook is kept",
+            cxxopts::value<int>()->default_value("1"))(
+            "kernelize", "Reduce the conflict graph exactly (pendant, domination, degree-2 folding) before the greedy",
+            cxxopts::value<bool>()->default_value("false"))(
+            "graph-shard", "Only build shard i/S of the conflict graph into the graph cache (e.g. 0/8)",
+            cxxopts::value<string>())(
+            "graph-merge", "Merge the conflict-graph shards in the graph cache into one cached graph",
+            cxxopts::value<bool>()->default_value("false"))(
             "c,config", "JSON configuration file", cxxopts::value<string>())
             ("cluster", "Use cluster-based iterative solving", cxxopts::value<bool>()->default_value("false"))
             ("numClusters", "Number of clusters to partition candidates into", cxxopts::value<int>()->default_value("500"))
@@ -479,7 +602,13 @@ void configure_parser(cxxopts::Options &options)
             "lc_row_perm", "Row permutation (CSV, 0-indexed)", cxxopts::value<string>())(
             "lc_col_perm", "Column permutation (CSV, 0-indexed)", cxxopts::value<string>())(
             "lc_random_seed", "Random seed for LinearCode vectors",
-            cxxopts::value<unsigned int>()->default_value("0"));
+            cxxopts::value<unsigned int>()->default_value("0"))
+        // Distance backend worker (internal: IndexGen starts itself this way when INDEXGEN_BACKEND=cpu)
+        ("graphWorker", "Run as the CPU stand-in of the distance backend",
+         cxxopts::value<bool>()->default_value("false"))(
+            "candidates-fd", "Candidate memory file of the worker", cxxopts::value<int>()->default_value("-1"))(
+            "edges-fd", "Edge pipe of the worker", cxxopts::value<int>()->default_value("-1"))(
+            "worker-fd", "Job socket of a persistent worker", cxxopts::value<int>()->default_value("-1"));
 }
 
 /**
@@ -45,37 +45,40 @@ void DeleteMatrix(const int n, bool **mat)
  * @brief Constructs an adjacency matrix for the compatibility graph.
  * @details An edge (i, j) is set to `true` if the edit distance between string i and
  * string j is greater than or equal to `minED`.
- * @param strs The vector of candidate strings.
+ * @param strs The packed candidate strings.
  * @param minED The minimum edit distance required for two strings to be compatible.
  * @param matrixOnesNum A reference to a long long to store the number of non-edges (conflicts).
  * @return A pointer to the newly created adjacency matrix.
  */
-bool **AdjMatrix(const std::vector<std::string> &strs, const int minED, long long int &matrixOnesNum)
+bool **AdjMatrix(const PackedCandidateSet &strs, const int minED, long long int &matrixOnesNum)
 {
     int n = strs.size();
     bool **m = AllocateMatrix(n);
     long long int conflictCount = 0;
 
-    // Iterate over the upper triangle of the matrix
+    // Iterate over the upper triangle of the matrix: start fully compatible, then clear the conflicts
     for (int i = 0; i < n; i++)
     {
-        PatternHandle H = MakePattern(strs[i]);
         for (int j = i + 1; j < n; j++)
         {
-            bool isCompatible = EditDistanceBandedAtLeast(strs[j], H, minED);
-            if (isCompatible)
-            {
-                // If compatible, add an edge in both directions
-                m[i][j] = true;
-                m[j][i] = true;
-            }
-            else
-            {
-                // If not compatible, they are in conflict.
-                conflictCount += 2;
-            }
+            m[i][j] = true;
+            m[j][i] = true;
         }
     }
+    ConflictScanStats stats;
+    WithConflictScanner(strs, PackedCompositions(strs), stats, [&](const auto &scanRow) {
+        for (int i = 0; i < n; i++)
+        {
+            scanRow(i, i + 1, n, minED,
+                    [&](size_t j)
+                    {
+                        // If not compatible, they are in conflict.
+                        m[i][j] = false;
+                        m[j][i] = false;
+                        conflictCount += 2;
+                    });
+        }
+    });
     matrixOnesNum = conflictCount; // Note: This variable name is misleading here; it stores conflicts.
     return m;
 }
@@ -83,12 +86,12 @@ bool **AdjMatrix(const std::vector<std::string> &strs, const int minED, long lon
 /**
  * @brief Finds the maximum clique and translates it into a codebook of strings.
  * @param params The generation parameters.
- * @param candidates The vector of candidate strings.
- * @param codebook An output vector to store the resulting codebook strings.
+ * @param candidates The packed candidate strings.
+ * @param codebook An output set to store the resulting codewords.
  * @param matrixOnesNum A reference to store the number of conflicts.
  */
-void MaxCliqueStrings(const Params &params, const std::vector<std::string> &candidates,
-                      std::vector<std::string> &codebook, long long int &matrixOnesNum)
+void MaxCliqueStrings(const Params &params, const PackedCandidateSet &candidates, PackedCandidateSet &codebook,
+                      long long int &matrixOnesNum)
 {
     bool **mat = AdjMatrix(candidates, params.codeMinED, matrixOnesNum);
     int size = candidates.size();
@@ -101,10 +104,11 @@ void MaxCliqueStrings(const Params &params, const std::vector<std::string> &cand
     // m.mcq(qmax, qsize); // A basic algorithm
     m.mcqdyn(qmax, qsize); // A dynamic, usually faster, algorithm
 
-    // Convert the indices from the clique back to strings
+    // Copy the clique members into the codebook
+    codebook = PackedCandidateSet(candidates.Length());
     codebook.reserve(qsize);
     for (int i = 0; i < qsize; i++)
-        codebook.push_back(candidates[qmax[i]]);
+        codebook.Append(candidates, qmax[i]);
 
     DeleteMatrix(size, mat);
 }
@@ -113,8 +117,8 @@ void MaxCliqueStrings(const Params &params, const std::vector<std::string> &cand
 void GenerateCodebookMaxClique(const Params &params)
 {
     PrintTestParams(params);
-    std::vector<std::string> candidates = Candidates(params);
-    std::vector<std::string> codebook;
+    PackedCandidateSet candidates = Candidates(params);
+    PackedCandidateSet codebook;
     long long int matrixOnesNum;
     int candidateNum = candidates.size();
 
@@ -0,0 +1,221 @@
+/**
+ * @file MetricIndex.cpp
+ * @brief Implements the pivot selection, the parallel table build, the queries and the binary file format.
+ */
+
+#include "MetricIndex.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+constexpr char kMagic[4] = {'I', 'G', 'M', 'I'};
+constexpr uint32_t kFormatVersion = 1;
+
+// Farthest-first pivot selection only looks at this many evenly spaced words
+constexpr size_t kPivotSample = 1024;
+
+uint8_t Saturate(int d)
+{
+    return (uint8_t)std::min(d, 255);
+}
+} // namespace
+
+MetricIndex::MetricIndex(const PackedCandidateSet &candidates, int threadNum, int pivotNum)
+    : len(candidates.Length()), words(candidates)
+{
+    const size_t n = words.size();
+    if (n == 0)
+        return;
+
+    // Farthest-first over a sample: each new pivot maximises its distance to the closest pivot chosen so far
+    const size_t sampleNum = std::min(n, kPivotSample);
+    std::vector<std::string> sample(sampleNum);
+    for (size_t s = 0; s < sampleNum; ++s)
+        words.Unpack(s * n / sampleNum, sample[s]);
+    std::vector<int> closest(sampleNum, 1 << 30);
+    size_t next = 0;
+    pivotNum = (int)std::min((size_t)std::max(1, pivotNum), sampleNum);
+    for (int p = 0; p < pivotNum; ++p)
+    {
+        pivots.push_back((int)(next * n / sampleNum));
+        pivotText.push_back(sample[next]);
+        const PatternHandle H = MakePattern(sample[next]);
+        for (size_t s = 0; s < sampleNum; ++s)
+            closest[s] = std::min(closest[s], EditDistanceExact(sample[s], H));
+        next = (size_t)(std::max_element(closest.begin(), closest.end()) - closest.begin());
+    }
+
+    // Table rows are independent; every thread fills a contiguous block of words for all pivots
+    table.resize(pivots.size() * n);
+    threadNum = std::max(1, threadNum);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadNum; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            std::vector<PatternHandle> handles;
+            for (const std::string &text : pivotText)
+                handles.push_back(MakePattern(text));
+            std::string text;
+            for (size_t i = n * t / threadNum; i < n * (t + 1) / threadNum; ++i)
+            {
+                words.Unpack(i, text);
+                for (size_t p = 0; p < handles.size(); ++p)
+                    table[p * n + i] = Saturate(EditDistanceExact(text, handles[p]));
+            }
+        });
+    }
+    for (std::thread &th : threads)
+        th.join();
+}
+
+PatternHandle MetricIndex::LowerBounds(const std::string &query, size_t first, std::vector<uint8_t> &bound) const
+{
+    const size_t n = size();
+    const size_t count = n - std::min(first, n);
+    bound.assign(count, 0);
+    PatternHandle H = MakePattern(query);
+    for (size_t p = 0; p < pivots.size(); ++p)
+    {
+        const uint8_t dq = Saturate(EditDistanceExact(pivotText[p], H));
+        const uint8_t *row = table.data() + p * n + (n - count);
+        uint8_t *out = bound.data();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint8_t gap = (uint8_t)(row[i] > dq ? row[i] - dq : dq - row[i]);
+            out[i] = std::max(out[i], gap);
+        }
+    }
+    return H;
+}
+
+std::vector<std::pair<int, int>> MetricIndex::Within(const std::string &query, int radius) const
+{
+    std::vector<std::pair<int, int>> found;
+    std::vector<uint8_t> bound;
+    ForEachWithin(query, radius, 0, bound, [&](int id, int d) { found.push_back(std::make_pair(id, d)); });
+    std::stable_sort(found.begin(), found.end(),
+                     [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.second < b.second; });
+    return found;
+}
+
+std::vector<std::pair<int, int>> MetricIndex::Nearest(const std::string &query, int k) const
+{
+    std::vector<std::pair<int, int>> result;
+    if (empty() || k <= 0)
+        return result;
+
+    std::vector<uint8_t> bound;
+    const PatternHandle H = LowerBounds(query, 0, bound);
+
+    // Bucket the words by lower bound (counting sort keeps index order inside a bucket)
+    std::vector<size_t> start(257, 0);
+    for (uint8_t b : bound)
+        ++start[b + 1];
+    for (size_t b = 1; b < start.size(); ++b)
+        start[b] += start[b - 1];
+    std::vector<int> byBound(bound.size());
+    {
+        std::vector<size_t> fill(start.begin(), start.end() - 1);
+        for (size_t i = 0; i < bound.size(); ++i)
+            byBound[fill[bound[i]]++] = (int)i;
+    }
+
+    // Max-heap on (distance, index): the top is the current k-th best. A word whose bound exceeds its distance
+    // cannot enter, and an equally distant word with a lower index still can, so the cap is the top's distance
+    std::priority_queue<std::pair<int, int>> best;
+    int cap = std::max(len, (int)query.size());
+    std::string text;
+    for (size_t b = 0; b < 256 && (int)b <= cap; ++b)
+    {
+        for (size_t s = start[b]; s < start[b + 1]; ++s)
+        {
+            const int i = byBound[s];
+            words.Unpack(i, text);
+            const int d = EditDistanceBanded(text, H, cap);
+            if (d > cap)
+                continue;
+            const std::pair<int, int> entry(d, i);
+            if ((int)best.size() < k)
+                best.push(entry);
+            else if (entry < best.top())
+            {
+                best.pop();
+                best.push(entry);
+            }
+            if ((int)best.size() == k)
+                cap = best.top().first;
+        }
+    }
+
+    while (!best.empty())
+    {
+        result.push_back(std::make_pair(best.top().second, best.top().first));
+        best.pop();
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+void MetricIndex::Save(const std::string &filename) const
+{
+    std::ofstream output(filename, std::ios::binary);
+    if (!output.is_open())
+        throw std::runtime_error("MetricIndex: cannot open " + filename + " for writing");
+    const uint32_t header[4] = {kFormatVersion, (uint32_t)len, (uint32_t)size(), (uint32_t)pivots.size()};
+    output.write(kMagic, sizeof(kMagic));
+    output.write(reinterpret_cast<const char *>(header), sizeof(header));
+    if (!empty())
+    {
+        output.write(reinterpret_cast<const char *>(words.Words(0)),
+                     size() * (size_t)words.WordsPerSeq() * sizeof(uint64_t));
+        output.write(reinterpret_cast<const char *>(pivots.data()), pivots.size() * sizeof(int));
+        output.write(reinterpret_cast<const char *>(table.data()), table.size());
+    }
+    if (!output)
+        throw std::runtime_error("MetricIndex: failed writing " + filename);
+}
+
+MetricIndex MetricIndex::Load(const std::string &filename)
+{
+    std::ifstream input(filename, std::ios::binary);
+    if (!input.is_open())
+        throw std::runtime_error("MetricIndex: cannot open " + filename);
+    char magic[sizeof(kMagic)];
+    uint32_t header[4];
+    input.read(magic, sizeof(magic));
+    input.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (!input || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || header[0] != kFormatVersion)
+        throw std::runtime_error("MetricIndex: " + filename + " is not a metric index file");
+
+    MetricIndex index;
+    index.len = (int)header[1];
+    const size_t count = header[2];
+    index.words = PackedCandidateSet(index.len);
+    const size_t wordsPerSeq = (size_t)index.words.WordsPerSeq();
+    std::vector<uint64_t> packed(count * wordsPerSeq);
+    index.pivots.resize(count ? header[3] : 0);
+    index.table.resize(index.pivots.size() * count);
+    input.read(reinterpret_cast<char *>(packed.data()), packed.size() * sizeof(uint64_t));
+    input.read(reinterpret_cast<char *>(index.pivots.data()), index.pivots.size() * sizeof(int));
+    input.read(reinterpret_cast<char *>(index.table.data()), index.table.size());
+    if (!input)
+        throw std::runtime_error("MetricIndex: " + filename + " is truncated");
+    if (input.peek() != std::ifstream::traits_type::eof())
+        throw std::runtime_error("MetricIndex: " + filename + " is longer than its header says");
+
+    index.words.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        index.words.PushBackWords(packed.data() + i * wordsPerSeq);
+    for (int p : index.pivots)
+    {
+        if (p < 0 || (size_t)p >= count)
+            throw std::runtime_error("MetricIndex: " + filename + " has an invalid pivot");
+        index.pivotText.push_back(index.words.Get(p));
+    }
+    return index;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file PackedCandidates.cpp
+ * @brief Implements the 2-bit packed candidate container and its text I/O.
+ */
+
+#include "PackedCandidates.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+PackedCandidateSet::PackedCandidateSet(int length)
+    : len(length), wordsPerSeq((length + kSymbolsPerWord - 1) / kSymbolsPerWord)
+{
+}
+
+void PackedCandidateSet::PushBack(const std::string &str)
+{
+    if (len == 0 && words.empty())
+    {
+        len = (int)str.size();
+        wordsPerSeq = (len + kSymbolsPerWord - 1) / kSymbolsPerWord;
+    }
+    if ((int)str.size() != len)
+    {
+        throw std::runtime_error("PackedCandidateSet: candidate of length " + std::to_string(str.size()) +
+                                 " added to a set of length " + std::to_string(len));
+    }
+    size_t base = words.size();
+    words.resize(base + wordsPerSeq, 0ULL);
+    for (int p = 0; p < len; ++p)
+    {
+        uint64_t sym = (uint64_t)((unsigned char)str[p] - (unsigned char)'0') & 3ULL;
+        words[base + p / kSymbolsPerWord] |= sym << (2 * (p % kSymbolsPerWord));
+    }
+}
+
+void PackedCandidateSet::Append(const PackedCandidateSet &other, size_t i)
+{
+    if (len == 0 && words.empty())
+    {
+        len = other.len;
+        wordsPerSeq = other.wordsPerSeq;
+    }
+    if (other.len != len)
+    {
+        throw std::runtime_error("PackedCandidateSet: cannot append candidates of length " +
+                                 std::to_string(other.len) + " to a set of length " + std::to_string(len));
+    }
+    const uint64_t *src = other.Words(i);
+    words.insert(words.end(), src, src + wordsPerSeq);
+}
+
+void PackedCandidateSet::AppendAll(const PackedCandidateSet &other)
+{
+    if (other.empty())
+        return;
+    if (len == 0 && words.empty())
+    {
+        len = other.len;
+        wordsPerSeq = other.wordsPerSeq;
+    }
+    if (other.len != len)
+    {
+        throw std::runtime_error("PackedCandidateSet: cannot append candidates of length " +
+                                 std::to_string(other.len) + " to a set of length " + std::to_string(len));
+    }
+    words.insert(words.end(), other.words.begin(), other.words.end());
+}
+
+void PackedCandidateSet::Unpack(size_t i, std::string &out) const
+{
+    out.resize(len);
+    const uint64_t *w = Words(i);
+    for (int p = 0; p < len; ++p)
+    {
+        out[p] = (char)('0' + ((w[p / kSymbolsPerWord] >> (2 * (p % kSymbolsPerWord))) & 3ULL));
+    }
+}
+
+std::string PackedCandidateSet::Get(size_t i) const
+{
+    std::string out;
+    Unpack(i, out);
+    return out;
+}
+
+std::vector<std::string> PackedCandidateSet::ToStrings() const
+{
+    std::vector<std::string> result(size());
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        Unpack(i, result[i]);
+    }
+    return result;
+}
+
+PackedCandidateSet PackedCandidateSet::FromStrings(const std::vector<std::string> &strs)
+{
+    PackedCandidateSet result(strs.empty() ? 0 : (int)strs[0].size());
+    result.reserve(strs.size());
+    for (const std::string &str : strs)
+    {
+        result.PushBack(str);
+    }
+    return result;
+}
+
+std::vector<uint64_t> PackedCompositions(const PackedCandidateSet &texts)
+{
+    std::vector<uint64_t> result(texts.size());
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        result[i] = PackedComposition(texts.Words(i), texts.Length());
+    }
+    return result;
+}
+
+CompositionTiles::CompositionTiles(const PackedCandidateSet &candidates, int tileSize) : sorted(candidates.Length())
+{
+    const std::vector<uint64_t> unsortedComp = PackedCompositions(candidates);
+    order.resize(candidates.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = (int)i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return unsortedComp[a] < unsortedComp[b]; });
+
+    sorted.reserve(order.size());
+    compositions.resize(order.size());
+    for (size_t k = 0; k < order.size(); ++k)
+    {
+        sorted.Append(candidates, order[k]);
+        compositions[k] = unsortedComp[order[k]];
+    }
+
+    // Cut at a composition change once the tile is large enough to be worth a bound check, or when it is full
+    const size_t maxTile = (size_t)std::max(1, tileSize);
+    const size_t minTile = std::max((size_t)1, maxTile / 8);
+    tileStart.push_back(0);
+    for (size_t k = 1; k < compositions.size(); ++k)
+    {
+        const size_t current = k - tileStart.back();
+        if (current >= maxTile || (current >= minTile && compositions[k] != compositions[k - 1]))
+            tileStart.push_back(k);
+    }
+    if (!compositions.empty())
+        tileStart.push_back(compositions.size());
+
+    const size_t tiles = tileStart.size() - 1;
+    tileMin.assign(tiles, 0);
+    tileMax.assign(tiles, 0);
+    for (size_t t = 0; t < tiles; ++t)
+    {
+        uint64_t lo = ~0ULL, hi = 0;
+        for (size_t k = TileBegin(t); k < TileEnd(t); ++k)
+        {
+            uint64_t nextLo = 0, nextHi = 0;
+            for (int s = 0; s < 4; ++s)
+            {
+                const uint64_t field = 0xFFFFULL << (16 * s);
+                nextLo |= std::min(lo & field, compositions[k] & field);
+                nextHi |= std::max(hi & field, compositions[k] & field);
+            }
+            lo = nextLo;
+            hi = nextHi;
+        }
+        tileMin[t] = lo;
+        tileMax[t] = hi;
+    }
+}
+
+int CompositionTiles::TileGapL1(size_t a, size_t b) const
+{
+    int gap = 0;
+    for (int s = 0; s < 4; ++s)
+    {
+        const int loA = (int)((tileMin[a] >> (16 * s)) & 0xFFFF), hiA = (int)((tileMax[a] >> (16 * s)) & 0xFFFF);
+        const int loB = (int)((tileMin[b] >> (16 * s)) & 0xFFFF), hiB = (int)((tileMax[b] >> (16 * s)) & 0xFFFF);
+        gap += std::max(0, std::max(loB - hiA, loA - hiB));
+    }
+    return gap;
+}
+
+void PackedToFile(const PackedCandidateSet &data, const std::string &fileName)
+{
+    std::ofstream output;
+    output.open(fileName.c_str());
+    if (!output.is_open())
+    {
+        std::cout << "Failed opening output file!" << std::endl;
+        return;
+    }
+    std::string line;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        data.Unpack(i, line);
+        output << line << '\n';
+    }
+    output.close();
+}
+
+void FileToPacked(PackedCandidateSet &data, const std::string &fileName)
+{
+    std::ifstream input;
+    input.open(fileName.c_str());
+    if (!input.is_open())
+    {
+        std::cout << "Failed opening input file!" << std::endl;
+        return;
+    }
+    data = PackedCandidateSet();
+    std::string line;
+    while (input >> line)
+    {
+        data.PushBack(line);
+    }
+    input.close();
+}
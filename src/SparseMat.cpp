@@ -1,6 +1,13 @@
 #include "SparseMat.hpp"
 #include "Candidates.hpp"
+#include "ConflictJoins.hpp"
+#include "EdgeRuns.hpp"
 #include "EditDistance.hpp"
+#include "GraphBackend.hpp"
+#include "GraphCache.hpp"
+#include "GraphKernel.hpp"
+#include "PackedCandidates.hpp"
+#include "TileScheduler.hpp"
 #include "Utils.hpp"
 #include "clustering/KMeansAdapter.hpp"
 #include <algorithm>
@@ -8,21 +15,80 @@
 #include <cassert>
 #include <chrono>
 #include <climits>
+#include <condition_variable>
+#include <cmath>
 #include <cstdlib> // Added for system()
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <thread>
 #include <unordered_map>
+#include <unistd.h>
 #include <unordered_set>
 #include <vector>
 
 namespace
 {
+// Run and CSR files of out-of-core builds are named per graph, so the graphs one process builds in the same working
+// directory keep theirs apart. The first graph of a process is the main (resumable) one.
+std::string NextGraphFilePrefix()
+{
+    static std::atomic<int> graphNum(0);
+    return "graph_ext_" + std::to_string(graphNum.fetch_add(1));
+}
+
+// The tie-break among equal degrees in a parallel greedy round: a splitmix64 hash of the node id, so that the chosen
+// nodes of a round are spread over the graph instead of clustering at low ids
+uint64_t NodePriority(int node)
+{
+    uint64_t x = (uint64_t)node + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// A reusable barrier for a fixed team of threads that meets once per phase
+class RoundBarrier
+{
+  public:
+    explicit RoundBarrier(int threadNum) : threadNum(threadNum), waiting(0), generation(0) {}
+
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        const long long int arrived = generation;
+        if (++waiting == threadNum)
+        {
+            waiting = 0;
+            ++generation;
+            released.notify_all();
+            return;
+        }
+        released.wait(lock, [&]() { return generation != arrived; });
+    }
+
+  private:
+    std::mutex mutex;
+    std::condition_variable released;
+    const int threadNum;
+    int waiting;
+    long long int generation;
+};
+
 /**
  * @brief Get the project root directory by detecting the executable's location.
  *
@@ -78,14 +144,39 @@ using namespace std;
 
 // *** AdjList Member Function Implementations ***
 
+AdjList::~AdjList()
+{
+    Unmap();
+}
+
+void AdjList::Unmap()
+{
+    if (mapping != nullptr)
+        munmap(mapping, mappingBytes);
+    mapping = nullptr;
+    mappingBytes = 0;
+}
+
 void AdjList::Init(int numNodes)
 {
-    m.resize(numNodes);
+    Unmap();
+    offsets.assign(numNodes + 1, 0);
+    rowOffsets = offsets.data();
+    neighbours.clear();
+    rowNeighbours = neighbours.data();
+    arenaOffsets.assign(numNodes + 1, 0);
+    arena.clear();
+    rowWords = 0;
+    vector<uint64_t>().swap(bitRows);
+    vector<uint64_t>().swap(live);
     deleted.assign(numNodes, false);
     degree.assign(numNodes, 0);
     pos_in_bucket.assign(numNodes, -1);
     num_active_nodes = numNodes;
     min_degree_tracker = 0;
+    masked = false;
+    order.clear();
+    rank.clear();
     // rowsBySum is allocated during RowsBySum() once degrees are known
 }
 
@@ -93,22 +184,25 @@ void AdjList::RowsBySum()
 {
     rowsBySum.clear();
     int max_d = 0;
-    for (int i = 0; i < (int)m.size(); ++i)
+    const int nodeNum = (int)deleted.size();
+    for (int i = 0; i < nodeNum; ++i)
     {
         if (deleted[i])
             continue;
-        int d = m[i].size();
+        int d = masked ? degree[i] : (int)(rowOffsets[i + 1] - rowOffsets[i]);
         degree[i] = d;
         if (d > max_d)
             max_d = d;
     }
 
     rowsBySum.resize(max_d + 1);
-    pos_in_bucket.resize(m.size(), -1);
+    pos_in_bucket.resize(nodeNum, -1);
     min_degree_tracker = max_d + 1;
 
-    for (int i = 0; i < (int)m.size(); ++i)
+    // In node order, so a relabelled graph breaks its ties as the original does
+    for (int node = 0; node < nodeNum; ++node)
     {
+        const int i = Row(node);
         if (deleted[i])
             continue;
         int d = degree[i];
@@ -119,11 +213,139 @@ void AdjList::RowsBySum()
     }
 }
 
+size_t AdjList::MaskNodes(const vector<bool> &active)
+{
+    const int nodeNum = (int)deleted.size();
+    num_active_nodes = 0;
+    for (int i = 0; i < nodeNum; ++i)
+    {
+        deleted[Row(i)] = !active[i];
+        num_active_nodes += active[i] ? 1 : 0;
+    }
+    if (rowWords > 0)
+    {
+        live.assign(rowWords, 0);
+        for (int i = 0; i < nodeNum; ++i)
+            if (!deleted[i])
+                live[i / 64] |= uint64_t(1) << (i % 64);
+    }
+    size_t entryNum = 0;
+    for (int i = 0; i < nodeNum; ++i)
+    {
+        degree[i] = 0;
+        if (deleted[i])
+            continue;
+        if (rowWords > 0)
+        {
+            const uint64_t *row = bitRows.data() + (size_t)i * rowWords;
+            for (size_t w = 0; w < rowWords; ++w)
+                degree[i] += __builtin_popcountll(row[w] & live[w]);
+        }
+        else
+            ForEachLiveNeighbour(i, [&](int) { ++degree[i]; });
+        entryNum += degree[i];
+    }
+    masked = true;
+    return entryNum;
+}
+
+bool AdjList::Relabel(const string &vertexOrder)
+{
+    if (vertexOrder != "none" && vertexOrder != "degree" && vertexOrder != "rcm" && vertexOrder != "bfs")
+        throw runtime_error("AdjList: unknown vertex order '" + vertexOrder + "' (none, degree, rcm or bfs)");
+    if (vertexOrder == "none" || compressed || rowWords > 0 || externalBudget > 0)
+        return false;
+
+    // The new order is worked out on the current rows, with every tie broken by node id, so it does not depend on an
+    // earlier relabelling
+    const int nodeNum = (int)deleted.size();
+    auto rowDegree = [&](int r) { return rowOffsets[r + 1] - rowOffsets[r]; };
+    vector<int> byNode(nodeNum);
+    for (int node = 0; node < nodeNum; ++node)
+        byNode[node] = Row(node);
+    vector<int> next;
+    next.reserve(nodeNum);
+    if (vertexOrder == "degree")
+    {
+        next = byNode;
+        stable_sort(next.begin(), next.end(), [&](int a, int b) { return rowDegree(a) < rowDegree(b); });
+    }
+    else
+    {
+        // Breadth-first over every component; Cuthill-McKee starts each one at a node of least degree and visits the
+        // neighbours by ascending degree, then reverses the whole sequence
+        const bool rcm = vertexOrder == "rcm";
+        vector<int> seeds = byNode;
+        if (rcm)
+            stable_sort(seeds.begin(), seeds.end(), [&](int a, int b) { return rowDegree(a) < rowDegree(b); });
+        vector<char> visited(nodeNum, 0);
+        vector<int> found;
+        for (int seed : seeds)
+        {
+            if (visited[seed])
+                continue;
+            visited[seed] = 1;
+            next.push_back(seed);
+            for (size_t head = next.size() - 1; head < next.size(); ++head)
+            {
+                found.clear();
+                ForEachNeighbour(next[head], [&](int j) {
+                    if (!visited[j])
+                    {
+                        visited[j] = 1;
+                        found.push_back(j);
+                    }
+                });
+                if (rcm)
+                    stable_sort(found.begin(), found.end(), [&](int a, int b) { return rowDegree(a) < rowDegree(b); });
+                next.insert(next.end(), found.begin(), found.end());
+            }
+        }
+        if (rcm)
+            reverse(next.begin(), next.end());
+    }
+
+    // Row next[k] becomes row k; the neighbours keep their node order
+    vector<int> newRow(nodeNum);
+    for (int k = 0; k < nodeNum; ++k)
+        newRow[next[k]] = k;
+    vector<size_t> newOffsets(nodeNum + 1, 0);
+    for (int k = 0; k < nodeNum; ++k)
+        newOffsets[k + 1] = newOffsets[k] + rowDegree(next[k]);
+    vector<int> newNeighbours(newOffsets[nodeNum]);
+    vector<bool> newDeleted(nodeNum);
+    vector<int> newDegree(nodeNum), newOrder(nodeNum);
+    for (int k = 0; k < nodeNum; ++k)
+    {
+        size_t out = newOffsets[k];
+        ForEachNeighbour(next[k], [&](int j) { newNeighbours[out++] = newRow[j]; });
+        newDeleted[k] = deleted[next[k]];
+        newDegree[k] = degree[next[k]];
+        newOrder[k] = Node(next[k]);
+    }
+    Unmap();
+    offsets.swap(newOffsets);
+    neighbours.swap(newNeighbours);
+    rowOffsets = offsets.data();
+    rowNeighbours = neighbours.data();
+    deleted.swap(newDeleted);
+    degree.swap(newDegree);
+    order.swap(newOrder);
+    rank.assign(nodeNum, 0);
+    for (int k = 0; k < nodeNum; ++k)
+        rank[order[k]] = k;
+    // The buckets are rebuilt by the next RowsBySum
+    rowsBySum.clear();
+    pos_in_bucket.assign(nodeNum, -1);
+    min_degree_tracker = 0;
+    return true;
+}
+
 int AdjList::MinSumRow() const
 {
     assert(min_degree_tracker >= 0 && min_degree_tracker < (int)rowsBySum.size());
     assert(!rowsBySum[min_degree_tracker].empty());
-    return rowsBySum[min_degree_tracker].back();
+    return Node(rowsBySum[min_degree_tracker].back());
 }
 
 int AdjList::MaxSumRow() const
@@ -131,7 +353,7 @@ int AdjList::MaxSumRow() const
     for (int d = (int)rowsBySum.size() - 1; d >= 0; --d)
     {
         if (!rowsBySum[d].empty())
-            return rowsBySum[d].back();
+            return Node(rowsBySum[d].back());
     }
     return -1;
 }
@@ -174,7 +396,7 @@ int AdjList::RemoveEmptyRows()
         removedRowsNum = rowsBySum[0].size();
         for (int row : rowsBySum[0])
         {
-            deleted[row] = true;
+            SetDeleted(row);
             num_active_nodes--;
         }
         rowsBySum[0].clear();
@@ -196,57 +418,331 @@ int AdjList::RowNum() const
     return num_active_nodes;
 }
 
-void AdjList::Set(int row, int col)
+void AdjList::Build(const vector<vector<pair<int, int>>> &edgeLists, int threadNum, bool symmetric)
+{
+    const size_t nodeNum = offsets.size() - 1;
+    threadNum = max(1, threadNum);
+    order.clear();
+    rank.clear();
+    rowWords = 0;
+    vector<uint64_t>().swap(bitRows);
+
+    // The edge sequence is cut into chunks at global positions; each chunk keeps one counter per node, so the chunk
+    // count is capped to keep the counters below half the size of the edge lists themselves
+    vector<size_t> listStart(1, 0);
+    for (const vector<pair<int, int>> &edges : edgeLists)
+        listStart.push_back(listStart.back() + edges.size());
+    const size_t total = listStart.back();
+    const size_t chunkNum = max<size_t>(1, min<size_t>(threadNum, total / max<size_t>(1, nodeNum)));
+    auto forEachEdge = [&](size_t chunk, auto &&f) {
+        const size_t first = total * chunk / chunkNum, last = total * (chunk + 1) / chunkNum;
+        size_t list = upper_bound(listStart.begin(), listStart.end(), first) - listStart.begin() - 1;
+        for (size_t pos = first; pos < last; ++list)
+        {
+            const size_t end = min(last, listStart[list + 1]);
+            for (; pos < end; ++pos)
+            {
+                const pair<int, int> &edge = edgeLists[list][pos - listStart[list]];
+                if (edge.first >= 0 && edge.second >= 0 && (size_t)edge.first < nodeNum &&
+                    (size_t)edge.second < nodeNum)
+                    f(edge.first, edge.second);
+            }
+        }
+    };
+    auto parallel = [&](size_t workNum, auto &&work) {
+        vector<thread> threads;
+        for (size_t w = 0; w < workNum; ++w)
+            threads.push_back(thread([&work, w]() { work(w); }));
+        for (thread &th : threads)
+            th.join();
+    };
+
+    // Count pass: cursor[chunk * nodeNum + u] = entries chunk adds to node u
+    vector<uint32_t> cursor(chunkNum * nodeNum, 0);
+    parallel(chunkNum, [&](size_t chunk) {
+        uint32_t *count = cursor.data() + chunk * nodeNum;
+        forEachEdge(chunk, [&](int u, int v) {
+            ++count[u];
+            if (symmetric)
+                ++count[v];
+        });
+    });
+
+    // Prefix sums: per node over the chunks (turning counts into each chunk's start within the row), then over nodes
+    const size_t rangeNum = min<size_t>(threadNum, max<size_t>(1, nodeNum));
+    parallel(rangeNum, [&](size_t range) {
+        for (size_t u = nodeNum * range / rangeNum; u < nodeNum * (range + 1) / rangeNum; ++u)
+        {
+            size_t running = 0;
+            for (size_t chunk = 0; chunk < chunkNum; ++chunk)
+            {
+                const uint32_t count = cursor[chunk * nodeNum + u];
+                cursor[chunk * nodeNum + u] = (uint32_t)running;
+                running += count;
+            }
+            offsets[u + 1] = running;
+        }
+    });
+    offsets[0] = 0;
+    for (size_t u = 0; u < nodeNum; ++u)
+        offsets[u + 1] += offsets[u];
+
+    // A small dense graph goes to a bit matrix when it fits the budget and takes no more than the plain lists. The
+    // edges are set one thread at a time (a few million at most within a sensible budget); duplicate edges, which the
+    // lists would keep, send the graph back to the lists
+    const size_t words = (nodeNum + 63) / 64;
+    const size_t matrixBytes = nodeNum * words * sizeof(uint64_t);
+    if (!compressed && bitsetBudget > 0 && nodeNum > 0 && matrixBytes <= bitsetBudget &&
+        matrixBytes <= offsets[nodeNum] * sizeof(int))
+    {
+        bitRows.assign(nodeNum * words, 0);
+        size_t bitNum = 0;
+        auto setBit = [&](int u, int v) {
+            uint64_t &word = bitRows[(size_t)u * words + v / 64];
+            const uint64_t bit = uint64_t(1) << (v % 64);
+            bitNum += (word & bit) ? 0 : 1;
+            word |= bit;
+        };
+        for (size_t chunk = 0; chunk < chunkNum; ++chunk)
+        {
+            forEachEdge(chunk, [&](int u, int v) {
+                setBit(u, v);
+                if (symmetric)
+                    setBit(v, u);
+            });
+        }
+        if (bitNum == offsets[nodeNum])
+        {
+            rowWords = words;
+            live.assign(words, ~uint64_t(0));
+            if (nodeNum % 64 != 0)
+                live.back() = (uint64_t(1) << (nodeNum % 64)) - 1;
+            vector<int>().swap(neighbours);
+            rowNeighbours = neighbours.data();
+            return;
+        }
+        vector<uint64_t>().swap(bitRows);
+    }
+
+    // Fill pass, per batch of nodes: every chunk writes the entries of the batch's nodes at its own cursors. Plain
+    // storage fills all nodes at once straight into `neighbours`; compressed storage fills an eighth of the entries at
+    // a time into a scratch array and encodes them before the next batch
+    const size_t entryNum = offsets[nodeNum];
+    const size_t batchEntries = compressed ? max<size_t>(entryNum / 8, size_t(1) << 20) : entryNum;
+    vector<int> scratch;
+    if (compressed)
+    {
+        vector<int>().swap(neighbours);
+        // Reserve once so the arena never reallocates: sorted lists of d values below nodeNum have gaps summing to
+        // less than nodeNum, and a gap g takes 1 + log2(g) / 7 bytes at most, so by concavity a list takes at most
+        // d * (1 + log2(nodeNum / d) / 7) bytes. Pages beyond the encoded size are never touched.
+        double bound = 0;
+        for (size_t u = 0; u < nodeNum; ++u)
+        {
+            const double d = (double)(offsets[u + 1] - offsets[u]);
+            if (d > 0)
+                bound += d + ceil(d * log2(max(1.0, nodeNum / d)) / 7) + 1;
+        }
+        arena.clear();
+        arena.reserve((size_t)bound);
+        arenaOffsets.assign(nodeNum + 1, 0);
+    }
+    else
+    {
+        neighbours.assign(entryNum, 0);
+        rowNeighbours = neighbours.data();
+    }
+    for (size_t lo = 0; lo < nodeNum;)
+    {
+        size_t hi = upper_bound(offsets.begin() + lo + 1, offsets.end(), offsets[lo] + batchEntries) - offsets.begin() - 1;
+        hi = max(hi, lo + 1);
+        // Entry k of the batch lives at batch[k - base]
+        const size_t base = compressed ? offsets[lo] : 0;
+        if (compressed)
+            scratch.assign(offsets[hi] - base, 0);
+        int *batch = compressed ? scratch.data() : neighbours.data();
+        parallel(chunkNum, [&](size_t chunk) {
+            uint32_t *next = cursor.data() + chunk * nodeNum;
+            forEachEdge(chunk, [&](int u, int v) {
+                if ((size_t)u >= lo && (size_t)u < hi)
+                    batch[offsets[u] - base + next[u]++] = v;
+                if (symmetric && (size_t)v >= lo && (size_t)v < hi)
+                    batch[offsets[v] - base + next[v]++] = u;
+            });
+        });
+
+        // Sort the lists; compressed storage then sizes every list's encoding, lays the lists out back to back and
+        // encodes them in place
+        const size_t rangeNum = min<size_t>(threadNum, hi - lo);
+        auto forEachList = [&](auto &&f) {
+            parallel(rangeNum, [&](size_t range) {
+                for (size_t u = lo + (hi - lo) * range / rangeNum; u < lo + (hi - lo) * (range + 1) / rangeNum; ++u)
+                    f(u, batch + (offsets[u] - base), batch + (offsets[u + 1] - base));
+            });
+        };
+        forEachList([&](size_t u, int *first, int *last) {
+            sort(first, last);
+            if (!compressed)
+                return;
+            size_t bytes = 0;
+            int prev = 0;
+            for (const int *j = first; j < last; ++j)
+            {
+                for (uint32_t gap = (uint32_t)(*j - prev); gap >= 0x80; gap >>= 7)
+                    ++bytes;
+                ++bytes;
+                prev = *j;
+            }
+            arenaOffsets[u + 1] = bytes;
+        });
+        if (compressed)
+        {
+            for (size_t u = lo; u < hi; ++u)
+                arenaOffsets[u + 1] += arenaOffsets[u];
+            arena.resize(arenaOffsets[hi]);
+            forEachList([&](size_t u, int *first, int *last) {
+                uint8_t *out = arena.data() + arenaOffsets[u];
+                int prev = 0;
+                for (const int *j = first; j < last; ++j)
+                {
+                    uint32_t gap = (uint32_t)(*j - prev);
+                    for (; gap >= 0x80; gap >>= 7)
+                        *out++ = (uint8_t)(gap | 0x80);
+                    *out++ = (uint8_t)gap;
+                    prev = *j;
+                }
+            });
+        }
+        lo = hi;
+    }
+}
+
+void AdjList::MapFile(const string &filename, size_t offset)
 {
-    if (row >= (int)m.size())
-        return; // Protection
-    m[row].push_back(col);
-    // degree logic is initialized later via RowsBySum()
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw runtime_error("AdjList: cannot open " + filename);
+    struct stat info;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size >= offset + sizeof(CsrFileHeader) && offset % 8 == 0)
+        base = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        throw runtime_error("AdjList: cannot map " + filename);
+
+    CsrFileHeader header;
+    memcpy(&header, static_cast<const char *>(base) + offset, sizeof(header));
+    static_assert(sizeof(size_t) == sizeof(uint64_t), "CSR offsets are read in place");
+    const size_t expected =
+        offset + sizeof(header) + (header.nodeNum + 1) * sizeof(uint64_t) + header.entryNum * sizeof(int32_t);
+    if (memcmp(header.magic, CsrFileHeader::kMagic, sizeof(header.magic)) != 0 ||
+        header.version != CsrFileHeader::kVersion || header.nodeNum > (uint64_t)INT_MAX ||
+        expected != (size_t)info.st_size)
+    {
+        munmap(base, (size_t)info.st_size);
+        throw runtime_error("AdjList: " + filename + " is not a CSR graph file");
+    }
+
+    Init((int)header.nodeNum);
+    vector<size_t>().swap(offsets);
+    vector<size_t>().swap(arenaOffsets);
+    compressed = false;
+    mapping = base;
+    mappingBytes = (size_t)info.st_size;
+    const char *sections = static_cast<const char *>(base) + offset + sizeof(header);
+    rowOffsets = reinterpret_cast<const size_t *>(sections);
+    rowNeighbours = reinterpret_cast<const int *>(sections + (header.nodeNum + 1) * sizeof(uint64_t));
 }
 
-void AdjList::DelRowCol(int i)
+void AdjList::WriteCsr(ostream &output) const
+{
+    const size_t nodeNum = deleted.size();
+    CsrFileHeader header;
+    memcpy(header.magic, CsrFileHeader::kMagic, sizeof(header.magic));
+    header.version = CsrFileHeader::kVersion;
+    header.nodeNum = nodeNum;
+    header.entryNum = EntryCount();
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (nodeNum == 0)
+    {
+        const uint64_t zero = 0;
+        output.write(reinterpret_cast<const char *>(&zero), sizeof(zero));
+        return;
+    }
+    if (order.empty())
+        output.write(reinterpret_cast<const char *>(rowOffsets), (nodeNum + 1) * sizeof(uint64_t));
+    else
+    {
+        // A relabelled graph is written in node order, as it was built
+        uint64_t offset = 0;
+        output.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+        for (size_t i = 0; i < nodeNum; ++i)
+        {
+            const int r = Row((int)i);
+            offset += rowOffsets[r + 1] - rowOffsets[r];
+            output.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+        }
+    }
+    if (!compressed && rowWords == 0 && order.empty())
+    {
+        output.write(reinterpret_cast<const char *>(rowNeighbours), header.entryNum * sizeof(int32_t));
+        return;
+    }
+    vector<int32_t> row;
+    for (size_t i = 0; i < nodeNum; ++i)
+    {
+        row.clear();
+        ForEachNeighbour(Row((int)i), [&](int j) { row.push_back(Node(j)); });
+        output.write(reinterpret_cast<const char *>(row.data()), row.size() * sizeof(int32_t));
+    }
+}
+
+void AdjList::BuildFromRuns(const vector<string> &runs, const string &csrFile)
+{
+    MergeEdgeRuns(runs, deleted.size(), csrFile, externalBudget);
+    MapFile(csrFile);
+    // The mapping keeps the pages alive; the name is not needed any more
+    remove(csrFile.c_str());
+}
+
+void AdjList::DelRowCol(int rc)
+{
+    DelRow(Row(rc));
+}
+
+void AdjList::DelRow(int i)
 {
     if (deleted[i])
         return;
 
-    const std::vector<int> &js = m[i];
-    for (int j : js)
-    {
-        if (deleted[j])
-            continue;
+    ForEachLiveNeighbour(i, [&](int j) {
         int currRowJSum = degree[j];
         if (currRowJSum > 0)
         {
             DecreaseSum(currRowJSum, j);
         }
-    }
+    });
 
     DeleteRow(degree[i], i);
-    deleted[i] = true;
+    SetDeleted(i);
     num_active_nodes--;
 }
 
 void AdjList::DelBall(const int matRow, vector<bool> &remaining)
 {
-    if (deleted[matRow])
+    const int row = Row(matRow);
+    if (deleted[row])
         return;
 
     // Collect all elements to logically delete: the node itself and all its active neighbors
     vector<int> toDel;
-    const std::vector<int> &neighbors = m[matRow];
-    for (int num : neighbors)
-    {
-        if (!deleted[num])
-        {
-            toDel.push_back(num);
-        }
-    }
-    toDel.push_back(matRow);
+    ForEachLiveNeighbour(row, [&](int num) { toDel.push_back(num); });
+    toDel.push_back(row);
 
     for (int num : toDel)
     {
-        DelRowCol(num);
-        remaining[num] = false;
+        DelRow(num);
+        remaining[Node(num)] = false;
     }
 }
 
@@ -283,6 +779,247 @@ int AdjList::FindMaxDel(vector<bool> &remaining, double &maxSumRowTime, double &
     return maxSumRow;
 }
 
+vector<int> AdjList::GreedyPass(int pass) const
+{
+    // The pass's own copy of the bucket state; a deleted row has degree -1
+    vector<int> passDegree(deleted.size(), -1);
+    for (size_t i = 0; i < deleted.size(); ++i)
+    {
+        if (!deleted[i])
+            passDegree[i] = degree[i];
+    }
+    vector<vector<int>> buckets = rowsBySum;
+    vector<int> position = pos_in_bucket;
+    int minDegree = max(0, min_degree_tracker);
+    mt19937_64 rng((uint64_t)pass);
+
+    auto unbucket = [&](int row) {
+        vector<int> &bucket = buckets[passDegree[row]];
+        const int last = bucket.back();
+        bucket[position[row]] = last;
+        position[last] = position[row];
+        bucket.pop_back();
+    };
+
+    // DelBall, DelRow and DecreaseSum on the copy, in the same order
+    vector<int> chosen, ball;
+    for (;;)
+    {
+        while (minDegree < (int)buckets.size() && buckets[minDegree].empty())
+            ++minDegree;
+        if (minDegree == (int)buckets.size())
+            break;
+        const vector<int> &bucket = buckets[minDegree];
+        const int row = pass == 0 ? bucket.back() : bucket[rng() % bucket.size()];
+        chosen.push_back(Node(row));
+
+        ball.clear();
+        ForEachNeighbour(row, [&](int j) {
+            if (passDegree[j] >= 0)
+                ball.push_back(j);
+        });
+        ball.push_back(row);
+        for (int i : ball)
+        {
+            if (passDegree[i] < 0)
+                continue;
+            ForEachNeighbour(i, [&](int j) {
+                if (passDegree[j] <= 0)
+                    return;
+                unbucket(j);
+                const int d = --passDegree[j];
+                position[j] = buckets[d].size();
+                buckets[d].push_back(j);
+                minDegree = min(minDegree, d);
+            });
+            unbucket(i);
+            passDegree[i] = -1;
+        }
+    }
+    return chosen;
+}
+
+vector<int> AdjList::ParallelGreedy(int threadNum, double degreeWindow, int &roundNum) const
+{
+    const int nodeNum = (int)deleted.size();
+    threadNum = max(1, threadNum);
+    degreeWindow = max(0.0, degreeWindow);
+    roundNum = 0;
+
+    // Per-row state shared by the threads: the degree among active rows, whether the row is active, and the last
+    // round that decremented its degree
+    unique_ptr<atomic<int>[]> liveDegree(new atomic<int>[nodeNum]);
+    unique_ptr<atomic<uint8_t>[]> alive(new atomic<uint8_t>[nodeNum]);
+    unique_ptr<atomic<int>[]> touchedRound(new atomic<int>[nodeNum]);
+
+    // Lazy degree buckets: a row is pushed again whenever its degree drops, and entries whose row is gone or whose
+    // degree no longer matches the bucket are dropped when the bucket is read
+    vector<vector<int>> buckets(1);
+    for (int i = 0; i < nodeNum; ++i)
+    {
+        alive[i].store(deleted[i] ? 0 : 1, memory_order_relaxed);
+        liveDegree[i].store(deleted[i] ? 0 : degree[i], memory_order_relaxed);
+        touchedRound[i].store(-1, memory_order_relaxed);
+        if (deleted[i])
+            continue;
+        if (degree[i] >= (int)buckets.size())
+            buckets.resize(degree[i] + 1);
+        buckets[degree[i]].push_back(i);
+    }
+    auto isLive = [&](int r, int d) {
+        return alive[r].load(memory_order_relaxed) && liveDegree[r].load(memory_order_relaxed) == d;
+    };
+
+    vector<int> chosen;
+    vector<int> eligible;
+    vector<uint8_t> picked;
+    vector<vector<int>> claimed(threadNum), touched(threadNum);
+    int minDegree = 0, maxDegree = 0;
+    bool done = false;
+
+    // Between rounds, on one thread: records the nodes the last round chose, rebuckets the rows it left, and collects
+    // the eligible rows of the next round
+    auto prepareRound = [&]() {
+        const int last = roundNum - 1;
+        for (vector<int> &rows : touched)
+        {
+            for (int r : rows)
+            {
+                if (!alive[r].load(memory_order_relaxed))
+                    continue;
+                const int d = liveDegree[r].load(memory_order_relaxed);
+                buckets[d].push_back(r);
+                minDegree = min(minDegree, d);
+            }
+            rows.clear();
+        }
+        const size_t chosenStart = chosen.size();
+        for (size_t k = 0; k < eligible.size(); ++k)
+        {
+            const int r = eligible[k];
+            if (picked[k])
+                chosen.push_back(Node(r));
+            else if (alive[r].load(memory_order_relaxed) && touchedRound[r].load(memory_order_relaxed) != last)
+                buckets[liveDegree[r].load(memory_order_relaxed)].push_back(r);
+        }
+        sort(chosen.begin() + chosenStart, chosen.end());
+        for (vector<int> &rows : claimed)
+            rows.clear();
+
+        eligible.clear();
+        for (; minDegree < (int)buckets.size(); ++minDegree)
+        {
+            vector<int> &bucket = buckets[minDegree];
+            bucket.erase(remove_if(bucket.begin(), bucket.end(), [&](int r) { return !isLive(r, minDegree); }),
+                         bucket.end());
+            if (!bucket.empty())
+                break;
+        }
+        if (minDegree == (int)buckets.size())
+        {
+            done = true;
+            return;
+        }
+        maxDegree = min((int)buckets.size() - 1, minDegree + (int)(degreeWindow * minDegree));
+        for (int d = minDegree; d <= maxDegree; ++d)
+        {
+            for (int r : buckets[d])
+            {
+                if (isLive(r, d))
+                    eligible.push_back(r);
+            }
+            vector<int>().swap(buckets[d]);
+        }
+        picked.assign(eligible.size(), 0);
+        ++roundNum;
+    };
+
+    // An eligible row is chosen when no eligible neighbour precedes it in (degree, priority, node id) order
+    auto precedes = [&](int a, int da, int b, int db) {
+        if (da != db)
+            return da < db;
+        const uint64_t pa = NodePriority(Node(a)), pb = NodePriority(Node(b));
+        return pa != pb ? pa < pb : Node(a) < Node(b);
+    };
+
+    RoundBarrier barrier(threadNum);
+    auto work = [&](int t) {
+        for (;;)
+        {
+            if (t == 0)
+                prepareRound();
+            barrier.Wait();
+            if (done)
+                return;
+            const int round = roundNum - 1;
+
+            // Choose: a slice of the eligible rows per thread
+            const size_t eligibleNum = eligible.size();
+            const size_t first = eligibleNum * t / threadNum, last = eligibleNum * (t + 1) / threadNum;
+            for (size_t k = first; k < last; ++k)
+            {
+                const int r = eligible[k];
+                const int d = liveDegree[r].load(memory_order_relaxed);
+                bool best = true;
+                ForEachNeighbour(r, [&](int u) {
+                    if (!best || !alive[u].load(memory_order_relaxed))
+                        return;
+                    const int du = liveDegree[u].load(memory_order_relaxed);
+                    if (du <= maxDegree && precedes(u, du, r, d))
+                        best = false;
+                });
+                picked[k] = best;
+            }
+            barrier.Wait();
+
+            // Delete the balls: every row of a ball is claimed by exactly one thread
+            for (size_t k = first; k < last; ++k)
+            {
+                if (!picked[k])
+                    continue;
+                const int r = eligible[k];
+                if (alive[r].exchange(0, memory_order_relaxed))
+                    claimed[t].push_back(r);
+                ForEachNeighbour(r, [&](int u) {
+                    if (alive[u].load(memory_order_relaxed) && alive[u].exchange(0, memory_order_relaxed))
+                        claimed[t].push_back(u);
+                });
+            }
+            barrier.Wait();
+
+            // Decrement the degrees of the surviving neighbours of the claimed rows, spread evenly over the threads
+            size_t claimedNum = 0;
+            for (const vector<int> &rows : claimed)
+                claimedNum += rows.size();
+            size_t from = claimedNum * t / threadNum, to = claimedNum * (t + 1) / threadNum;
+            for (const vector<int> &rows : claimed)
+            {
+                for (size_t k = min(from, rows.size()); k < min(to, rows.size()); ++k)
+                {
+                    ForEachNeighbour(rows[k], [&](int u) {
+                        if (!alive[u].load(memory_order_relaxed))
+                            return;
+                        liveDegree[u].fetch_sub(1, memory_order_relaxed);
+                        if (touchedRound[u].exchange(round, memory_order_relaxed) != round)
+                            touched[t].push_back(u);
+                    });
+                }
+                from -= min(from, rows.size());
+                to -= min(to, rows.size());
+            }
+            barrier.Wait();
+        }
+    };
+
+    vector<thread> threads;
+    for (int t = 1; t < threadNum; ++t)
+        threads.push_back(thread(work, t));
+    work(0);
+    for (thread &th : threads)
+        th.join();
+    return chosen;
+}
+
 void AdjList::ToFile(const string &filename) const
 {
     ofstream output;
@@ -292,15 +1029,14 @@ void AdjList::ToFile(const string &filename) const
         std::cout << "Failed opening output file!" << endl;
         return;
     }
-    for (int i = 0; i < (int)m.size(); i++)
+    for (int i = 0; i < (int)deleted.size(); i++)
     {
-        if (deleted[i])
+        if (deleted[Row(i)])
             continue;
-        for (int j : m[i])
-        {
+        ForEachNeighbour(Row(i), [&](int j) {
             if (!deleted[j])
-                output << i << '\t' << j << '\n';
-        }
+                output << i << '\t' << Node(j) << '\n';
+        });
     }
     output.close();
 }
@@ -326,67 +1062,11 @@ void AdjList::FromFile(const string &filename)
     }
     input.close();
 
-    if (max_node >= 0)
-        Init(max_node + 1);
-    for (const auto &e : edges)
-    {
-        m[e.first].push_back(e.second);
-    }
-}
-
-// *** NEW: FAST BINARY LOADER FOR GPU INTEGRATION ***
-void AdjList::FromBinaryFile(const string &filename, long long int &matrixOnesNum, bool silent)
-{
-    ifstream input(filename, ios::binary);
-    if (!input.is_open())
-    {
-        std::cerr << "Error: Could not open binary edges file: " << filename << endl;
-        return;
-    }
-
-    // Read file into a buffer
-    input.seekg(0, ios::end);
-    size_t fileSize = input.tellg();
-    input.seekg(0, ios::beg);
-
-    if (fileSize == 0)
+    if (max_node < 0)
         return;
-
-    std::vector<int32_t> buffer(fileSize / sizeof(int32_t));
-    input.read(reinterpret_cast<char *>(buffer.data()), fileSize);
-    input.close();
-
-    // Process buffer (format: u, v, u, v...)
-    // Buffer contains only UNIQUE pairs (u < v). We must add symmetric edges.
-    size_t numInts = buffer.size();
-
-    // Pass 1: Count degrees for reserve()
-    std::vector<int> deg(m.size(), 0);
-    for (size_t i = 0; i < numInts; i += 2)
-    {
-        int u = buffer[i];
-        int v = buffer[i + 1];
-        if (u >= (int)m.size() || v >= (int)m.size())
-            continue;
-        deg[u]++;
-        deg[v]++;
-    }
-    for (int i = 0; i < (int)m.size(); ++i)
-        m[i].reserve(deg[i]);
-
-    // Pass 2: Populate adjacency lists
-    for (size_t i = 0; i < numInts; i += 2)
-    {
-        int u = buffer[i];
-        int v = buffer[i + 1];
-        if (u >= (int)m.size() || v >= (int)m.size())
-            continue;
-        m[u].push_back(v);
-        m[v].push_back(u);
-    }
-    matrixOnesNum = numInts;
-    if (!silent)
-        std::cout << "Loaded " << (numInts / 2) << " edges from binary file." << endl;
+    Init(max_node + 1);
+    // The file lists every stored entry, both directions included
+    Build(vector<vector<pair<int, int>>>(1, std::move(edges)), 1, false);
 }
 
 // *** Standalone Helper Functions ***
@@ -433,12 +1113,39 @@ void SaveProgressAdjListComp(const int i, const vector<pair<int, int>> &threadPa
     NumToFile(i, iFilename);
 }
 
-void LoadProgressAdjListComp(int &i, vector<pair<int, int>> &threadPairVec, int threadIdx)
+// Loads a thread's saved pairs and, for the row-based engines, its last finished row. Returns false (leaving `i`
+// unchanged) when the progress was saved by the tile scheduler, which records completed tiles instead of a row.
+bool LoadProgressAdjListComp(int &i, vector<pair<int, int>> &threadPairVec, int threadIdx)
 {
     string alFilename = "progress_adj_list_comp_" + to_string(threadIdx) + ".txt";
     PairsFromFile(alFilename, threadPairVec);
     string iFilename = "progress_adj_list_comp_i_" + to_string(threadIdx) + ".txt";
+    if (!std::filesystem::exists(iFilename))
+        return false;
     FileToNum(i, iFilename);
+    return true;
+}
+
+// Tile-scheduler checkpoint: the thread's pairs plus the ids of the tiles it completed, after the total tile count.
+// Both files are written aside and renamed into place, pairs first, so an interrupted save leaves at worst pairs of
+// a tile not yet listed as done (recomputed and deduplicated on resume), never a tile listed without its pairs.
+void SaveProgressAdjListTiles(const vector<int> &doneTiles, const vector<pair<int, int>> &threadPairVec,
+                              const int threadIdx)
+{
+    string alFilename = "progress_adj_list_comp_" + to_string(threadIdx) + ".txt";
+    PairsToFile(alFilename + ".tmp", threadPairVec);
+    std::filesystem::rename(alFilename + ".tmp", alFilename);
+    string tilesFilename = "progress_adj_list_tiles_" + to_string(threadIdx) + ".txt";
+    IntVecToFile(doneTiles, tilesFilename + ".tmp");
+    std::filesystem::rename(tilesFilename + ".tmp", tilesFilename);
+}
+
+// Reads the tiles a thread completed before the restart; empty when it saved none
+void LoadProgressAdjListTiles(vector<int> &doneTiles, const int threadIdx)
+{
+    string tilesFilename = "progress_adj_list_tiles_" + to_string(threadIdx) + ".txt";
+    if (std::filesystem::exists(tilesFilename))
+        FileToIntVec(doneTiles, tilesFilename);
 }
 
 void DelProgressAdjListComp(const int threadIdx)
@@ -447,112 +1154,436 @@ void DelProgressAdjListComp(const int threadIdx)
     remove(alFilename.c_str());
     string iFilename = "progress_adj_list_comp_i_" + to_string(threadIdx) + ".txt";
     remove(iFilename.c_str());
+    string tilesFilename = "progress_adj_list_tiles_" + to_string(threadIdx) + ".txt";
+    remove(tilesFilename.c_str());
 }
 
-// *** NEW: Helper to run Python GPU script (System Call) ***
-// OPTIMIZATION: Added inputFilename argument to avoid re-writing the vector file
-void FillAdjListGPU(AdjList &adjList, const vector<string> &candidates, const int minED, long long int &matrixOnesNum,
-                    const string &inputFilename = "", double maxGPUMemoryGB = 10.0, bool silent = false, bool isBinary = false)
+// The distance backend command: the CUDA script, or IndexGen itself as the CPU stand-in when INDEXGEN_BACKEND=cpu.
+// RunGraphBackend appends the descriptor arguments
+vector<string> GraphBackendCommand(const int minED, const int threadNum, double maxGPUMemoryGB, bool isBinary)
 {
-    static std::atomic<int> file_id{0};
-    int id = file_id++;
-    string vecFile = "temp_vectors_" + to_string(id) + ".txt";
-    string edgesFile = "temp_edges_" + to_string(id) + ".bin";
+    const char *env_backend = std::getenv("INDEXGEN_BACKEND");
+    if (env_backend != nullptr && string(env_backend) == "cpu")
+        return {std::filesystem::read_symlink("/proc/self/exe").string(), "--graphWorker", "--editDist",
+                to_string(minED), "--threads", to_string(threadNum)};
+
+    // Determine script path: auto-detect from executable location, allow env override
+    const char *env_root = std::getenv("INDEXGEN_ROOT");
+    string project_root = (env_root) ? string(env_root) : getProjectRoot();
+    string script_path = project_root + (isBinary ? "/src/gpu_graph_generator_binary.py" : "/src/gpu_graph_generator.py");
+    const char* env_python = std::getenv("INDEXGEN_PYTHON");
+    std::string python_cmd = env_python ? std::string(env_python) : "python3";
+    return {python_cmd, script_path, to_string(minED), to_string(maxGPUMemoryGB)};
+}
 
-    string fileToUse = vecFile;
+// Builds the graph from the distance backend's edge stream (see GraphBackend.hpp). The candidates go over in a memory
+// file and the edges come back through a pipe while the backend computes them. In RAM the chunks are kept as they
+// arrive and built once the stream ends; out of core, a pool of threads sorts and spills every chunk as a run while
+// the next one is read
+void FillAdjListGPU(AdjList &adjList, const PackedCandidateSet &candidates, const int minED, const int threadNum,
+                    long long int &matrixOnesNum, double maxGPUMemoryGB, bool silent, bool isBinary)
+{
+    const vector<string> command = GraphBackendCommand(minED, threadNum, maxGPUMemoryGB, isBinary);
+    if (!silent)
+    {
+        std::cout << "[C++] Executing graph backend:";
+        for (const string &arg : command)
+            std::cout << " " << arg;
+        std::cout << endl;
+    }
+    auto load_start = chrono::steady_clock::now();
+    adjList.Init(candidates.size());
 
-    // OPTIMIZATION: If we already have a file on disk (progress_cand.txt), use it!
-    if (!inputFilename.empty())
+    size_t edgeNum = 0;
+    if (adjList.ExternalBudget() > 0)
     {
+        // The budget covers the chunks being spilled, the one waiting in the queue and the one being read
+        const int spillerNum = max(1, threadNum);
+        const string prefix = NextGraphFilePrefix();
+        EdgeRunWriter runs(prefix, adjList.ExternalBudget(), spillerNum + 2, false);
+        std::mutex queueMutex;
+        std::condition_variable queueReady, queueRoom;
+        vector<vector<pair<int, int>>> queue;
+        bool streamDone = false;
+        std::exception_ptr spillError;
+        vector<thread> spillers;
+        for (int t = 0; t < spillerNum; t++)
+        {
+            spillers.push_back(thread([&]() {
+                for (;;)
+                {
+                    vector<pair<int, int>> chunk;
+                    {
+                        std::unique_lock<std::mutex> lock(queueMutex);
+                        queueReady.wait(lock, [&]() { return streamDone || !queue.empty(); });
+                        if (queue.empty())
+                            return;
+                        chunk.swap(queue.back());
+                        queue.pop_back();
+                    }
+                    queueRoom.notify_one();
+                    try
+                    {
+                        runs.Spill(chunk);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(queueMutex);
+                        spillError = std::current_exception();
+                    }
+                }
+            }));
+        }
+        auto finish = [&]() {
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                streamDone = true;
+            }
+            queueReady.notify_all();
+            for (thread &th : spillers)
+                th.join();
+        };
+        try
+        {
+            auto enqueue = [&](vector<pair<int, int>> &chunk) {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueRoom.wait(lock, [&]() { return queue.empty(); });
+                queue.push_back(std::move(chunk));
+                lock.unlock();
+                queueReady.notify_one();
+            };
+            edgeNum = RunGraphBackend(command, candidates, runs.SpillPairs(), silent, enqueue);
+        }
+        catch (...)
+        {
+            finish();
+            throw;
+        }
+        finish();
+        if (spillError)
+            std::rethrow_exception(spillError);
+        const vector<string> runFiles = runs.Runs();
+        adjList.BuildFromRuns(runFiles, prefix + ".csr");
         if (!silent)
-            std::cout << "[C++] Using existing candidate file: " << inputFilename << endl;
-        fileToUse = inputFilename;
+            std::cout << "[C++] Streamed " << NumberWithCommas((long long int)edgeNum) << " edges into "
+                      << runFiles.size() << " runs." << endl;
     }
     else
     {
-        // Fallback: Save candidates to temp file
+        vector<vector<pair<int, int>>> edgeLists;
+        edgeNum = RunGraphBackend(command, candidates, size_t(1) << 20, silent,
+                                  [&](vector<pair<int, int>> &chunk) { edgeLists.push_back(std::move(chunk)); });
+        adjList.Build(edgeLists, threadNum);
         if (!silent)
-            std::cout << "[C++] Saving candidates to " << vecFile << "..." << endl;
-        StrVecToFile(candidates, vecFile);
+            std::cout << "[C++] Streamed " << NumberWithCommas((long long int)edgeNum) << " edges." << endl;
     }
+    matrixOnesNum = (long long int)adjList.EntryCount();
 
-    // 2. Call Python Script
-    // Usage: python3 gpu_graph_generator.py <input> <output> <threshold>
-    // Determine script path: auto-detect from executable location, allow env override
-    const char *env_root = std::getenv("INDEXGEN_ROOT");
-    string project_root = (env_root) ? string(env_root) : getProjectRoot();
-    string script_path = project_root + (isBinary ? "/src/gpu_graph_generator_binary.py" : "/src/gpu_graph_generator.py");
-    const char* env_python = std::getenv("INDEXGEN_PYTHON");
-    std::string python_cmd = env_python ? std::string(env_python) : "python3";
+    chrono::duration<double> load_time = chrono::steady_clock::now() - load_start;
+    if (!silent)
+        std::cout << "[C++] Backend and edge ingest time: " << fixed << setprecision(2) << load_time.count() << "s"
+                  << endl;
+}
+
+// The upper triangle of the pair matrix cut into the all-pairs engine's work items: row tile a against a band of up
+// to kTileBand consecutive column tiles starting at b >= a. With composition tiles the rows are the composition-sorted
+// copy and its tiles; without, fixed blocks of kTileRows candidates in input order.
+struct PairTriangle
+{
+    static constexpr size_t kTileRows = CompositionTiles::kDefaultTileSize;
+    static constexpr size_t kTileBand = 16;
+
+    const PackedCandidateSet &set;        // rows and columns in scan order
+    const vector<uint64_t> &compositions; // PackedComposition of every candidate of set
+    const CompositionTiles *tiles;        // tile bounds and original indices; null for fixed blocks
+    size_t tileNum;
+    vector<pair<uint32_t, uint32_t>> items; // (row tile, first column tile), row tile major
+
+    PairTriangle(const PackedCandidateSet &set_, const vector<uint64_t> &compositions_, const CompositionTiles *tiles_)
+        : set(set_), compositions(compositions_), tiles(tiles_),
+          tileNum(tiles_ ? tiles_->TileCount() : (set_.size() + kTileRows - 1) / kTileRows)
+    {
+        for (size_t a = 0; a < tileNum; ++a)
+        {
+            for (size_t b = a; b < tileNum; b += kTileBand)
+                items.push_back(make_pair((uint32_t)a, (uint32_t)b));
+        }
+    }
 
-    string cmd = python_cmd + " " + script_path + " " + fileToUse + " " + edgesFile + " " + to_string(minED) + " " +
-                 to_string(maxGPUMemoryGB);
+    size_t TileBegin(size_t t) const
+    {
+        return tiles ? tiles->TileBegin(t) : t * kTileRows;
+    }
 
-    if (silent)
+    size_t TileEnd(size_t t) const
     {
-        cmd += " > /dev/null 2>&1";
+        return tiles ? tiles->TileEnd(t) : min((t + 1) * kTileRows, set.size());
     }
-    else
+
+    int Original(size_t k) const
     {
-        std::cout << "[C++] Executing GPU Solver: " << cmd << endl;
+        return tiles ? tiles->Original(k) : (int)k;
     }
 
-    int ret = system(cmd.c_str());
-    if (ret != 0)
+    // Whether the composition bounds of two distinct tiles rule out every conflict between them
+    bool Skippable(size_t a, size_t b, const int minED) const
     {
-        if (silent)
+        return tiles && a != b && tiles->TileGapL1(a, b) >= 2 * minED;
+    }
+};
+
+// All-pairs engine, one thread: pulls work items from the shared queue until it is drained. Column tiles whose
+// composition bounds leave no room for a conflict are skipped, the rest are merged into contiguous ranges and scanned
+// with the staged row scanners. Pairs are stored with original indices; progress is saved per completed item. With
+// `labels`, every pair also gets its exact edit distance (below minED), from the banded kernel capped at minED - 1.
+void FillAdjListTilesTH(vector<pair<int, int>> &pairVec, vector<int> &doneItems, ConflictScanStats &stats,
+                        long long int &skippedTilePairs, double &busySeconds, const PairTriangle &triangle,
+                        TileQueue &queue, const int minED, const int threadIdx, const int saveInterval,
+                        EdgeRunWriter *runs, vector<uint8_t> *labels)
+{
+    const auto startTime = chrono::steady_clock::now();
+    auto lastSaveTime = startTime;
+    vector<pair<size_t, size_t>> ranges;
+    PatternHandle rowPattern;
+    string text;
+    WithConflictScanner(triangle.set, triangle.compositions, stats, [&](const auto &scanRow) {
+        uint32_t item;
+        while (queue.Next(threadIdx, item))
         {
-            // If it failed silently, try to run again without silence to show error, or just print generic error
-            std::cerr << "Error: Python GPU script failed (run without silence to see details)." << endl;
+            const size_t a = triangle.items[item].first, firstCol = triangle.items[item].second;
+            const size_t lastCol = min(firstCol + PairTriangle::kTileBand, triangle.tileNum);
+
+            // Contiguous runs of unskipped column tiles, as sorted-position ranges; the diagonal tile is scanned
+            // per row from i + 1
+            ranges.clear();
+            for (size_t b = max(firstCol, a + 1); b < lastCol; ++b)
+            {
+                if (triangle.Skippable(a, b, minED))
+                {
+                    ++skippedTilePairs;
+                    continue;
+                }
+                if (!ranges.empty() && ranges.back().second == triangle.TileBegin(b))
+                    ranges.back().second = triangle.TileEnd(b);
+                else
+                    ranges.push_back(make_pair(triangle.TileBegin(b), triangle.TileEnd(b)));
+            }
+
+            for (size_t i = triangle.TileBegin(a); i < triangle.TileEnd(a); ++i)
+            {
+                const int orig = triangle.Original(i);
+                if (labels != nullptr)
+                    rowPattern = MakePattern(triangle.set.Get(i));
+                auto emit = [&](size_t j) {
+                    pairVec.push_back(make_pair(orig, triangle.Original(j)));
+                    if (labels != nullptr)
+                    {
+                        triangle.set.Unpack(j, text);
+                        labels->push_back((uint8_t)EditDistanceBanded(text, rowPattern, minED - 1));
+                    }
+                };
+                if (firstCol == a)
+                    scanRow(i, i + 1, triangle.TileEnd(a), minED, emit);
+                for (const pair<size_t, size_t> &range : ranges)
+                    scanRow(i, range.first, range.second, minED, emit);
+            }
+            doneItems.push_back((int)item);
+            if (runs != nullptr && runs->Full(pairVec))
+                runs->Spill(pairVec);
+
+            auto currentTime = chrono::steady_clock::now();
+            chrono::duration<double> elapsed_seconds = currentTime - lastSaveTime;
+            if (saveInterval > 0 && elapsed_seconds.count() > saveInterval)
+            {
+                vector<int> checkpoint(1, (int)triangle.items.size());
+                checkpoint.insert(checkpoint.end(), doneItems.begin(), doneItems.end());
+                SaveProgressAdjListTiles(checkpoint, pairVec, threadIdx);
+                lastSaveTime = currentTime;
+                std::cout << "Adj List Comp PROGRESS: " << doneItems.size() << " tiles done\tthreadId\t" << threadIdx
+                          << endl;
+            }
         }
-        else
+    });
+    busySeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+}
+
+// Rewrites the per-thread pair lists into the order the untiled scan produces: pair (a, b) with a < b goes to list
+// a % threadNum, each list sorted by (a, b). Neighbour order decides greedy tie-breaks, so this keeps codebooks
+// identical whether or not the candidates were reordered.
+void CanonicalPairOrder(vector<vector<pair<int, int>>> &threadPairVecs, const int candNum)
+{
+    const int threadNum = (int)threadPairVecs.size();
+    vector<size_t> start(candNum + 1, 0);
+    for (const vector<pair<int, int>> &thvec : threadPairVecs)
+    {
+        for (const pair<int, int> &pr : thvec)
+            ++start[min(pr.first, pr.second) + 1];
+    }
+    for (int a = 0; a < candNum; ++a)
+        start[a + 1] += start[a];
+
+    vector<int> cols(start[candNum]);
+    vector<size_t> fill(start.begin(), start.end() - 1);
+    for (vector<pair<int, int>> &thvec : threadPairVecs)
+    {
+        for (const pair<int, int> &pr : thvec)
+            cols[fill[min(pr.first, pr.second)]++] = max(pr.first, pr.second);
+        vector<pair<int, int>>().swap(thvec);
+    }
+
+    for (int t = 0; t < threadNum; ++t)
+    {
+        size_t listSize = 0;
+        for (int a = t; a < candNum; a += threadNum)
+            listSize += start[a + 1] - start[a];
+        threadPairVecs[t].reserve(listSize);
+    }
+    for (int a = 0; a < candNum; ++a)
+    {
+        // Duplicates only arise when a restart recomputes a tile whose pairs were saved but not yet marked done
+        sort(cols.begin() + start[a], cols.begin() + start[a + 1]);
+        const auto rowEnd = unique(cols.begin() + start[a], cols.begin() + start[a + 1]);
+        vector<pair<int, int>> &thvec = threadPairVecs[a % threadNum];
+        for (auto col = cols.begin() + start[a]; col != rowEnd; ++col)
+            thvec.push_back(make_pair(a, *col));
+    }
+}
+
+// All-pairs engine: every pair is scanned with the staged row scanners, optionally over composition-sorted tiles. The
+// triangle is cut into fixed-size work items handed out by a work-stealing queue; on resume the items completed
+// before the restart are left out. With `threadLabelVecs`, each thread's pairs come with their edit distances in the
+// parallel label list, and the pairs are left in the order they were found. With `shardCount` > 1 only the items
+// congruent to `shardIndex` are scanned (one shard of a graph built by several processes). Returns the number of work
+// items of the triangle, which fixes how shards are cut.
+size_t FillPairsAllPairs(vector<vector<pair<int, int>>> &threadPairVecs, const PackedCandidateSet &candidates,
+                       const int minED, const bool resume, const int saveInterval, const GraphParams &graph,
+                       EdgeRunWriter *runs, bool silent, vector<vector<uint8_t>> *threadLabelVecs = nullptr,
+                       int shardIndex = 0, int shardCount = 1)
+{
+    const int threadNum = (int)threadPairVecs.size();
+    unique_ptr<CompositionTiles> tiles;
+    vector<uint64_t> compositions;
+    if (graph.compositionTiles)
+        tiles.reset(new CompositionTiles(candidates));
+    else
+        compositions = PackedCompositions(candidates);
+    const PairTriangle triangle(tiles ? tiles->Sorted() : candidates, tiles ? tiles->Compositions() : compositions,
+                                tiles.get());
+
+    vector<char> done(triangle.items.size(), 0);
+    vector<vector<int>> threadDone(threadNum);
+    if (resume)
+    {
+        for (int t = 0; t < threadNum; t++)
         {
-            std::cerr << "Error: Python GPU script failed." << endl;
+            vector<int> saved;
+            LoadProgressAdjListTiles(saved, t);
+            if (saved.empty())
+                continue;
+            if (saved[0] != (int)triangle.items.size())
+            {
+                // Saved for a different candidate set or tiling: its pairs cannot be trusted either
+                std::cout << "Adj List Comp: discarding tile progress of thread " << t << endl;
+                vector<pair<int, int>>().swap(threadPairVecs[t]);
+                continue;
+            }
+            threadDone[t].assign(saved.begin() + 1, saved.end());
+            for (int item : threadDone[t])
+                done[item] = 1;
         }
-        exit(1);
     }
+    vector<uint32_t> pending;
+    for (size_t item = 0; item < triangle.items.size(); ++item)
+    {
+        if (!done[item] && (int)(item % shardCount) == shardIndex)
+            pending.push_back((uint32_t)item);
+    }
+    TileQueue queue(pending, threadNum);
 
-    // 3. Load Binary Edges
-    if (!silent)
-        std::cout << "[C++] Loading edges from " << edgesFile << "..." << endl;
-    auto load_start = chrono::steady_clock::now();
-
-    adjList.Init(candidates.size());
-    adjList.FromBinaryFile(edgesFile, matrixOnesNum, silent);
+    vector<ConflictScanStats> threadStats(threadNum);
+    vector<long long int> threadSkipped(threadNum, 0);
+    vector<double> threadBusy(threadNum, 0.0);
+    vector<thread> threads;
+    for (int i = 0; i < threadNum; i++)
+    {
+        threads.push_back(thread(FillAdjListTilesTH, ref(threadPairVecs[i]), ref(threadDone[i]), ref(threadStats[i]),
+                                 ref(threadSkipped[i]), ref(threadBusy[i]), cref(triangle), ref(queue), minED, i,
+                                 saveInterval, runs, threadLabelVecs ? &(*threadLabelVecs)[i] : nullptr));
+    }
+    for (thread &th : threads)
+        th.join();
+    // Out of core, the merge sorts and deduplicates; labelled lists are never resumed, so hold no duplicates
+    if (runs == nullptr && threadLabelVecs == nullptr)
+        CanonicalPairOrder(threadPairVecs, candidates.size());
 
-    auto load_end = chrono::steady_clock::now();
-    chrono::duration<double> load_time = load_end - load_start;
     if (!silent)
-        std::cout << "[C++] Edge load time: " << fixed << setprecision(2) << load_time.count() << "s" << endl;
-
-    // Clean up temp file only if we created it
-    if (inputFilename.empty())
     {
-        remove(vecFile.c_str());
+        std::ostringstream busy;
+        busy << std::fixed << std::setprecision(2) << *min_element(threadBusy.begin(), threadBusy.end()) << " - "
+             << *max_element(threadBusy.begin(), threadBusy.end()) << " s";
+        std::cout << "Tile Scheduler:\t" << NumberWithCommas((long long int)queue.size()) << " tiles\t"
+                  << NumberWithCommas(queue.Steals()) << " steals\tthread busy time " << busy.str() << endl;
+        if (tiles)
+        {
+            long long int skipped = 0;
+            for (long long int ts : threadSkipped)
+                skipped += ts;
+            const long long int tileNum = (long long int)tiles->TileCount();
+            const long long int tilePairs = tileNum * (tileNum - 1) / 2;
+            std::ostringstream skipRate;
+            skipRate << std::fixed << std::setprecision(1) << (tilePairs ? 100.0 * skipped / tilePairs : 0.0) << "%";
+            std::cout << "Composition Tiles:\t" << NumberWithCommas(tileNum) << " tiles\t" << NumberWithCommas(skipped)
+                      << " of " << NumberWithCommas(tilePairs) << " tile pairs skipped (" << skipRate.str() << ")"
+                      << endl;
+        }
+
+        ConflictScanStats stats;
+        for (const ConflictScanStats &ts : threadStats)
+            stats.Add(ts);
+        std::ostringstream hitRate;
+        hitRate << std::fixed << std::setprecision(1) << stats.CompositionHitRate() << "%";
+        std::cout << "Conflict Stages:\tHamming " << NumberWithCommas(stats.hammingConflicts) << " conflicts"
+                  << "\tComposition " << NumberWithCommas(stats.compositionRejects) << " rejected (" << hitRate.str()
+                  << ")\tEdit Distance " << NumberWithCommas(stats.dpConflicts) << " conflicts of "
+                  << NumberWithCommas(stats.dpPairs) << " pairs" << endl;
     }
-    remove(edgesFile.c_str());
+    return triangle.items.size();
 }
 
-void FillAdjListTH(vector<pair<int, int>> &pairVec, const vector<string> &candidates,
-                   const vector<vector<char>> &cand0123Cont, const int minED, const int threadStart,
-                   const int threadIdx, const int threadNum, const int saveInterval)
+// Edit-ball engine, one thread: every threadNum-th row enumerates its radius-(minED - 1) ball and probes the index.
+// Each row emits its neighbours j > i sorted and deduplicated, so the lists come out in canonical order.
+void FillAdjListBallTH(vector<pair<int, int>> &pairVec, long long int &probes, const PackedCandidateSet &candidates,
+                       const PackedWordIndex &index, const EditBallEnumerator &ball, const int threadStart,
+                       const int threadIdx, const int threadNum, const int saveInterval, EdgeRunWriter *runs)
 {
     auto lastSaveTime = chrono::steady_clock::now();
-    int candNum = candidates.size();
+    const int candNum = candidates.size();
+    constexpr size_t kPrefetchAhead = 8;
+    vector<uint64_t> neighbours;
+    vector<int> found;
     for (int i = threadStart; i < candNum; i += threadNum)
     {
-        PatternHandle H = MakePattern(candidates[i]);
-        for (int j = i + 1; j < candNum; j++)
+        // Enumerate first, then probe with the index slots prefetched a few lookups ahead (probes are cache misses)
+        neighbours.clear();
+        found.clear();
+        ball.ForEach(candidates.Words(i)[0], [&](uint64_t neighbour) { neighbours.push_back(neighbour); });
+        probes += (long long int)neighbours.size();
+        for (size_t k = 0; k < neighbours.size(); ++k)
         {
-            bool EDIsAtLeastMinED =
-                // FastEditDistance0123(candidates[i], candidates[j], minED, cand0123Cont[i], cand0123Cont[j]);
-                // EditDistanceExactAtLeast(candidates[j], H, minED);
-                EditDistanceBandedAtLeast(candidates[j], H, minED);
-            if (!EDIsAtLeastMinED)
-            {
-                pairVec.push_back(make_pair(i, j));
-            }
+            if (k + kPrefetchAhead < neighbours.size())
+                index.Prefetch(neighbours[k + kPrefetchAhead]);
+            index.ForEachMatch(neighbours[k], [&](int j) {
+                if (j > i)
+                    found.push_back(j);
+            });
         }
+        sort(found.begin(), found.end());
+        found.erase(unique(found.begin(), found.end()), found.end());
+        for (int j : found)
+            pairVec.push_back(make_pair(i, j));
+        if (runs != nullptr && runs->Full(pairVec))
+            runs->Spill(pairVec);
+
         auto currentTime = chrono::steady_clock::now();
         chrono::duration<double> elapsed_seconds = currentTime - lastSaveTime;
         if (saveInterval > 0 && elapsed_seconds.count() > saveInterval)
@@ -564,49 +1595,340 @@ void FillAdjListTH(vector<pair<int, int>> &pairVec, const vector<string> &candid
     }
 }
 
-void FillAdjList(AdjList &adjList, const vector<string> &candidates, const int minED, const int threadNum,
-                 const int saveInterval, const bool resume, long long int &matrixOnesNum)
+// A ball probe (enumeration plus a mostly-missing index lookup) costs about as much as this many pair tests of the
+// all-pairs scan, which only visits half the set per row and runs its kernel 16-32 lanes wide.
+constexpr size_t kBallProbeCost = 16;
+
+// Edit-ball engine. Returns false without touching the lists when it does not apply (codewords too long to enumerate
+// in one word) or would be slower than all-pairs (ball larger than the candidate set once weighted by kBallProbeCost).
+bool FillPairsBall(vector<vector<pair<int, int>>> &threadPairVecs, const PackedCandidateSet &candidates,
+                   const int minED, const vector<int> &threadStartCand, const int saveInterval, EdgeRunWriter *runs,
+                   bool silent)
+{
+    const int n = candidates.Length();
+    const int radius = minED - 1;
+    if (candidates.empty() || !EditBallEnumerator::Applicable(n, radius))
+    {
+        if (!silent)
+            std::cout << "Graph Builder:\tball does not apply to length " << n << ", using allpairs" << endl;
+        return false;
+    }
+    const EditBallEnumerator ball(n, radius, PackedAlphabetSize(candidates));
+    const size_t ballSize = ball.DistinctSize(candidates.Words(0)[0]);
+    if (ballSize * kBallProbeCost > candidates.size())
+    {
+        if (!silent)
+            std::cout << "Graph Builder:\tball of " << NumberWithCommas(ballSize) << " strings too large for "
+                      << NumberWithCommas(candidates.size()) << " candidates, using allpairs" << endl;
+        return false;
+    }
+
+    const PackedWordIndex index(candidates);
+    const int threadNum = (int)threadPairVecs.size();
+    vector<long long int> threadProbes(threadNum, 0);
+    vector<thread> threads;
+    for (int i = 0; i < threadNum; i++)
+    {
+        threads.push_back(thread(FillAdjListBallTH, ref(threadPairVecs[i]), ref(threadProbes[i]), cref(candidates),
+                                 cref(index), cref(ball), threadStartCand[i], i, threadNum, saveInterval, runs));
+    }
+    for (thread &th : threads)
+        th.join();
+
+    if (!silent)
+    {
+        long long int probes = 0;
+        for (long long int tp : threadProbes)
+            probes += tp;
+        std::cout << "Graph Builder:\tball (" << NumberWithCommas(ballSize) << " strings, radius " << radius << ")\t"
+                  << NumberWithCommas(probes) << " index probes" << endl;
+    }
+    return true;
+}
+
+// Segment engine, one thread: every threadNum-th row gathers the candidates j > i sharing a segment with it behind a
+// copy of itself and verifies them with the row scanner. The few conflicts of a row are sorted before they are
+// emitted, so the lists come out in canonical order.
+void FillAdjListSegmentTH(vector<pair<int, int>> &pairVec, ConflictScanStats &stats,
+                          const PackedCandidateSet &candidates, const SegmentIndex &index, const int minED,
+                          const int threadStart, const int threadIdx, const int threadNum, const int saveInterval,
+                          EdgeRunWriter *runs)
+{
+    auto lastSaveTime = chrono::steady_clock::now();
+    const int candNum = candidates.size();
+    vector<int> found, conflicts;
+    PackedCandidateSet gathered(candidates.Length());
+    WithConflictScanner(gathered, vector<uint64_t>(), stats, [&](const auto &scan) {
+        for (int i = threadStart; i < candNum; i += threadNum)
+        {
+            found.clear();
+            gathered.clear();
+            gathered.Append(candidates, i);
+            index.ForEachCandidate(candidates.Words(i)[0], i + 1, [&](int j, uint64_t word) {
+                found.push_back(j);
+                gathered.PushBackWords(&word);
+            });
+            conflicts.clear();
+            scan(0, 1, gathered.size(), minED, [&](size_t k) { conflicts.push_back(found[k - 1]); });
+            sort(conflicts.begin(), conflicts.end());
+            for (int j : conflicts)
+                pairVec.push_back(make_pair(i, j));
+            if (runs != nullptr && runs->Full(pairVec))
+                runs->Spill(pairVec);
+
+            auto currentTime = chrono::steady_clock::now();
+            chrono::duration<double> elapsed_seconds = currentTime - lastSaveTime;
+            if (saveInterval > 0 && elapsed_seconds.count() > saveInterval)
+            {
+                SaveProgressAdjListComp(i, pairVec, threadIdx);
+                lastSaveTime = currentTime;
+                std::cout << "Adj List Comp PROGRESS: i=" << i << " of " << candNum << "\tthreadId\t" << threadIdx
+                          << endl;
+            }
+        }
+    });
+}
+
+// Past this expected share of the candidate set per query, verifying the candidates (which resemble the row, so the
+// kernel rarely exits early) plus the lookups and gathering costs more than the all-pairs scan.
+constexpr double kSegmentMaxHitFraction = 0.3;
+
+// Segment engine. Returns false without touching the lists when the codewords cannot be split into minED
+// single-word segments (or minED is above 8) or the segments are too short to be selective.
+bool FillPairsSegment(vector<vector<pair<int, int>>> &threadPairVecs, const PackedCandidateSet &candidates,
+                      const int minED, const vector<int> &threadStartCand, const int saveInterval, EdgeRunWriter *runs,
+                      bool silent)
+{
+    const int n = candidates.Length();
+    if (candidates.empty() || !SegmentIndex::Applicable(n, minED))
+    {
+        if (!silent)
+            std::cout << "Graph Builder:\tsegment does not apply to length " << n << " and edit distance " << minED
+                      << ", using allpairs" << endl;
+        return false;
+    }
+    const SegmentIndex index(candidates, minED);
+    const double hitFraction = index.ExpectedHitFraction(PackedAlphabetSize(candidates));
+    if (hitFraction > kSegmentMaxHitFraction)
+    {
+        if (!silent)
+            std::cout << "Graph Builder:\tsegments of length " << n / minED << " too short to filter, using allpairs"
+                      << endl;
+        return false;
+    }
+
+    const int threadNum = (int)threadPairVecs.size();
+    vector<ConflictScanStats> threadStats(threadNum);
+    vector<thread> threads;
+    for (int i = 0; i < threadNum; i++)
+    {
+        threads.push_back(thread(FillAdjListSegmentTH, ref(threadPairVecs[i]), ref(threadStats[i]), cref(candidates),
+                                 cref(index), minED, threadStartCand[i], i, threadNum, saveInterval, runs));
+    }
+    for (thread &th : threads)
+        th.join();
+
+    if (!silent)
+    {
+        ConflictScanStats stats;
+        for (const ConflictScanStats &ts : threadStats)
+            stats.Add(ts);
+        const long long int verified = stats.hammingConflicts + stats.dpPairs;
+        const long long int allPairs = (long long int)candidates.size() * ((long long int)candidates.size() - 1) / 2;
+        std::ostringstream share;
+        share << std::fixed << std::setprecision(2) << (allPairs ? 100.0 * verified / allPairs : 0.0) << "%";
+        std::cout << "Graph Builder:\tsegment (" << minED << " segments, " << index.ProbesPerQuery()
+                  << " probes per candidate)\t" << NumberWithCommas(verified) << " candidate pairs (" << share.str()
+                  << " of all pairs)\t" << NumberWithCommas(stats.hammingConflicts + stats.dpConflicts)
+                  << " conflicts" << endl;
+    }
+    return true;
+}
+
+// Deletion engine, one thread: every threadNum-th row looks up its deletion variants, gathers the distinct holders
+// j > i behind a copy of itself and verifies them with the row scanner; conflicts are sorted as in the segment engine.
+void FillAdjListDeletionTH(vector<pair<int, int>> &pairVec, ConflictScanStats &stats,
+                           const PackedCandidateSet &candidates, const DeletionIndex &index, const int minED,
+                           const int threadStart, const int threadIdx, const int threadNum, const int saveInterval,
+                           EdgeRunWriter *runs)
+{
+    auto lastSaveTime = chrono::steady_clock::now();
+    const int candNum = candidates.size();
+    constexpr size_t kPrefetchAhead = 8;
+    vector<uint64_t> variants;
+    vector<int> found, conflicts;
+    vector<int> seenBy(candNum, -1); // last row that reported each candidate, to drop repeats without sorting
+    PackedCandidateSet gathered(candidates.Length());
+    WithConflictScanner(gathered, vector<uint64_t>(), stats, [&](const auto &scan) {
+        for (int i = threadStart; i < candNum; i += threadNum)
+        {
+            DeletionIndex::Variants(candidates.Words(i)[0], candidates.Length(), minED - 1, variants);
+            found.clear();
+            gathered.clear();
+            gathered.Append(candidates, i);
+            for (size_t k = 0; k < variants.size(); ++k)
+            {
+                if (k + kPrefetchAhead < variants.size())
+                    index.Prefetch(variants[k + kPrefetchAhead]);
+                index.ForEachHolder(variants[k], i + 1, [&](int j) {
+                    if (seenBy[j] != i)
+                    {
+                        seenBy[j] = i;
+                        found.push_back(j);
+                        gathered.Append(candidates, j);
+                    }
+                });
+            }
+            conflicts.clear();
+            scan(0, 1, gathered.size(), minED, [&](size_t k) { conflicts.push_back(found[k - 1]); });
+            sort(conflicts.begin(), conflicts.end());
+            for (int j : conflicts)
+                pairVec.push_back(make_pair(i, j));
+            if (runs != nullptr && runs->Full(pairVec))
+                runs->Spill(pairVec);
+
+            auto currentTime = chrono::steady_clock::now();
+            chrono::duration<double> elapsed_seconds = currentTime - lastSaveTime;
+            if (saveInterval > 0 && elapsed_seconds.count() > saveInterval)
+            {
+                SaveProgressAdjListComp(i, pairVec, threadIdx);
+                lastSaveTime = currentTime;
+                std::cout << "Adj List Comp PROGRESS: i=" << i << " of " << candNum << "\tthreadId\t" << threadIdx
+                          << endl;
+            }
+        }
+    });
+}
+
+// A variant lookup (mostly a cache miss on the hash table) costs about as much as this many pair tests of the
+// all-pairs scan.
+constexpr size_t kDeletionProbeCost = 16;
+
+// Deletion engine. Returns false without touching the lists when the codewords do not fit one word, the
+// (variant, candidate) entries would not fit DeletionIndex::kMaxBuildBytes, or the variants outnumber the candidates
+// once weighted by kDeletionProbeCost.
+bool FillPairsDeletion(vector<vector<pair<int, int>>> &threadPairVecs, const PackedCandidateSet &candidates,
+                       const int minED, const vector<int> &threadStartCand, const int saveInterval,
+                       EdgeRunWriter *runs, bool silent)
+{
+    const int n = candidates.Length();
+    const int depth = minED - 1;
+    if (candidates.empty() || !DeletionIndex::Applicable(n, depth, candidates.size()))
+    {
+        if (!silent)
+            std::cout << "Graph Builder:\tdeletion does not apply to length " << n << ", using allpairs" << endl;
+        return false;
+    }
+    const size_t variants = DeletionIndex::MaxVariants(n, depth);
+    const size_t buildBytes = candidates.size() * variants * DeletionIndex::kBuildBytesPerEntry;
+    if (buildBytes > DeletionIndex::kMaxBuildBytes || variants * kDeletionProbeCost > candidates.size())
+    {
+        if (!silent)
+            std::cout << "Graph Builder:\t" << NumberWithCommas(variants) << " deletion variants per candidate too many"
+                      << " for " << NumberWithCommas(candidates.size()) << " candidates, using allpairs" << endl;
+        return false;
+    }
+
+    const int threadNum = (int)threadPairVecs.size();
+    const DeletionIndex index(candidates, depth, threadNum);
+    vector<ConflictScanStats> threadStats(threadNum);
+    vector<thread> threads;
+    for (int i = 0; i < threadNum; i++)
+    {
+        threads.push_back(thread(FillAdjListDeletionTH, ref(threadPairVecs[i]), ref(threadStats[i]),
+                                 cref(candidates), cref(index), minED, threadStartCand[i], i, threadNum,
+                                 saveInterval, runs));
+    }
+    for (thread &th : threads)
+        th.join();
+
+    if (!silent)
+    {
+        ConflictScanStats stats;
+        for (const ConflictScanStats &ts : threadStats)
+            stats.Add(ts);
+        const long long int verified = stats.hammingConflicts + stats.dpPairs;
+        const long long int allPairs = (long long int)candidates.size() * ((long long int)candidates.size() - 1) / 2;
+        std::ostringstream share;
+        share << std::fixed << std::setprecision(2) << (allPairs ? 100.0 * verified / allPairs : 0.0) << "%";
+        std::cout << "Graph Builder:\tdeletion (depth " << depth << ", " << NumberWithCommas(index.VariantCount())
+                  << " variants, " << NumberWithCommas(index.EntryCount()) << " entries)\t"
+                  << NumberWithCommas(verified) << " candidate pairs (" << share.str() << " of all pairs)\t"
+                  << NumberWithCommas(stats.hammingConflicts + stats.dpConflicts) << " conflicts" << endl;
+    }
+    return true;
+}
+
+void FillAdjList(AdjList &adjList, const PackedCandidateSet &candidates, const int minED, const int threadNum,
+                 const int saveInterval, const bool resume, long long int &matrixOnesNum, const GraphParams &graph,
+                 bool silent)
 {
     vector<vector<pair<int, int>>> threadPairVecs(threadNum, vector<pair<int, int>>());
-    vector<thread> threads;
     vector<int> threadStartCand(threadNum);
-    vector<vector<char>> cand0123Cont = Cont0123(candidates);
+    const string filePrefix = NextGraphFilePrefix();
+    unique_ptr<EdgeRunWriter> runs;
+    if (adjList.ExternalBudget() > 0)
+    {
+        // A resumed build keeps the runs spilled before the restart: they hold pairs the checkpoints no longer do
+        runs.reset(new EdgeRunWriter(filePrefix, adjList.ExternalBudget(), threadNum, resume));
+    }
 
-    if (not resume)
+    for (int i = 0; i < threadNum; i++)
     {
-        for (int i = 0; i < threadNum; i++)
-        {
-            threadStartCand[i] = i;
-        }
+        threadStartCand[i] = i;
     }
-    else
+    if (resume)
     {
+        // Row-based engines resume after their last saved row; the all-pairs engine reads its completed tiles itself
         for (int i = 0; i < threadNum; i++)
         {
-            LoadProgressAdjListComp(threadStartCand[i], threadPairVecs[i], i);
-            threadStartCand[i] += threadNum;
+            int lastRow;
+            if (LoadProgressAdjListComp(lastRow, threadPairVecs[i], i))
+                threadStartCand[i] = lastRow + threadNum;
         }
     }
 
-    for (int i = 0; i < threadNum; i++)
+    bool built = false;
+    if (graph.builder == "ball")
     {
-        threads.push_back(thread(FillAdjListTH, ref(threadPairVecs[i]), ref(candidates), ref(cand0123Cont), minED,
-                                 threadStartCand[i], i, threadNum, saveInterval));
+        built = FillPairsBall(threadPairVecs, candidates, minED, threadStartCand, saveInterval, runs.get(), silent);
+    }
+    else if (graph.builder == "segment")
+    {
+        built = FillPairsSegment(threadPairVecs, candidates, minED, threadStartCand, saveInterval, runs.get(), silent);
+    }
+    else if (graph.builder == "deletion")
+    {
+        built = FillPairsDeletion(threadPairVecs, candidates, minED, threadStartCand, saveInterval, runs.get(),
+                                  silent);
+    }
+    else if (graph.builder != "allpairs" && !silent)
+    {
+        std::cout << "Graph Builder:\tunknown builder '" << graph.builder << "', using allpairs" << endl;
+    }
+    if (!built)
+    {
+        FillPairsAllPairs(threadPairVecs, candidates, minED, resume, saveInterval, graph, runs.get(), silent);
     }
-    for (thread &th : threads)
-        th.join();
 
     adjList.Init(candidates.size());
-    matrixOnesNum = 0;
-    for (vector<pair<int, int>> &thvec : threadPairVecs)
+    if (runs)
     {
-        matrixOnesNum += (thvec.size() * 2);
-        for (pair<int, int> &pr : thvec)
-        {
-            adjList.Set(pr.first, pr.second);
-            adjList.Set(pr.second, pr.first);
-        }
+        for (vector<pair<int, int>> &thvec : threadPairVecs)
+            runs->Spill(thvec);
+        vector<vector<pair<int, int>>>().swap(threadPairVecs);
+        const vector<string> runFiles = runs->Runs();
+        adjList.BuildFromRuns(runFiles, filePrefix + ".csr");
+        if (!silent)
+            std::cout << "Graph Build:\tout of core\t" << runFiles.size()
+                      << " sorted runs merged into a mapped CSR file" << endl;
+    }
+    else
+    {
+        adjList.Build(threadPairVecs, threadNum);
     }
+    matrixOnesNum = (long long int)adjList.EntryCount();
+    vector<vector<pair<int, int>>>().swap(threadPairVecs);
     for (int i = 0; i < threadNum; i++)
     {
         DelProgressAdjListComp(i);
@@ -655,17 +1977,17 @@ void VecBoolFromFile(vector<bool> &vb, const string &filename, int totalSize)
     input.close();
 }
 
-void SaveProgressCodebook(const vector<bool> &remaining, const AdjList &adjList, const vector<string> &codebook)
+void SaveProgressCodebook(const vector<bool> &remaining, const AdjList &adjList, const PackedCandidateSet &codebook)
 {
     VecBoolToFile(remaining, "progress_remaining.txt");
-    StrVecToFile(codebook, "progress_codebook.txt");
+    PackedToFile(codebook, "progress_codebook.txt");
     adjList.ToFile("progress_adj_list.txt");
 }
 
-void LoadProgressCodebook(vector<bool> &remaining, AdjList &adjList, vector<string> &codebook, int totalSize)
+void LoadProgressCodebook(vector<bool> &remaining, AdjList &adjList, PackedCandidateSet &codebook, int totalSize)
 {
     VecBoolFromFile(remaining, "progress_remaining.txt", totalSize);
-    FileToStrVec(codebook, "progress_codebook.txt");
+    FileToPacked(codebook, "progress_codebook.txt");
     adjList.FromFile("progress_adj_list.txt");
 }
 
@@ -676,16 +1998,87 @@ void DelProgressCodebook()
     remove("progress_adj_list.txt");
 }
 
-void Codebook(AdjList &adjList, vector<string> &codebook, const vector<string> &candidates, const int saveInterval,
-              const bool resume)
+// Runs the greedy named by solver.method, with solver.restarts passes, on a graph whose buckets are built; no progress
+// files are written and the graph is left as it is
+vector<int> GreedyNodes(const AdjList &adjList, const SolverParams &solver, const int threadNum)
+{
+    if (solver.method == "parallel")
+    {
+        auto start = chrono::steady_clock::now();
+        int roundNum = 0;
+        vector<int> nodes = adjList.ParallelGreedy(threadNum, solver.degreeWindow, roundNum);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        std::cout << "Parallel Greedy:\t" << NumberWithCommas(roundNum) << " rounds\t" << fixed << setprecision(2)
+                  << elapsed.count() << "\tseconds" << std::endl;
+        return nodes;
+    }
+
+    // Several passes share the graph and the largest codebook wins, the lowest pass on ties
+    if (solver.restarts > 1)
+    {
+        auto start = chrono::steady_clock::now();
+        const int passNum = solver.restarts;
+        const int workerNum = max(1, min(threadNum, passNum));
+        vector<vector<int>> best(workerNum);
+        vector<int> bestPass(workerNum, -1);
+        vector<size_t> smallest(workerNum, SIZE_MAX);
+        size_t plainSize = 0;
+        atomic<int> nextPass(0);
+        vector<thread> threads;
+        for (int t = 0; t < workerNum; ++t)
+        {
+            threads.push_back(thread([&, t]() {
+                for (int pass = nextPass.fetch_add(1); pass < passNum; pass = nextPass.fetch_add(1))
+                {
+                    vector<int> chosen = adjList.GreedyPass(pass);
+                    smallest[t] = min(smallest[t], chosen.size());
+                    if (pass == 0)
+                        plainSize = chosen.size();
+                    if (bestPass[t] < 0 || chosen.size() > best[t].size() ||
+                        (chosen.size() == best[t].size() && pass < bestPass[t]))
+                    {
+                        best[t].swap(chosen);
+                        bestPass[t] = pass;
+                    }
+                }
+            }));
+        }
+        for (thread &th : threads)
+            th.join();
+        int winner = 0;
+        for (int t = 1; t < workerNum; ++t)
+        {
+            if (best[t].size() > best[winner].size() ||
+                (best[t].size() == best[winner].size() && bestPass[t] < bestPass[winner]))
+                winner = t;
+        }
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        std::cout << "Greedy Restarts:\t" << passNum << " passes\tplain " << NumberWithCommas(plainSize) << "\tbest "
+                  << NumberWithCommas(best[winner].size())
+                  << " (pass " << bestPass[winner] << ")\tworst "
+                  << NumberWithCommas(*min_element(smallest.begin(), smallest.end())) << "\t" << fixed
+                  << setprecision(2) << elapsed.count() << "\tseconds" << std::endl;
+        return best[winner];
+    }
+    return adjList.GreedyPass(0);
+}
+
+void Codebook(AdjList &adjList, PackedCandidateSet &codebook, const PackedCandidateSet &candidates,
+              const int saveInterval, const bool resume, const SolverParams &solver, const int threadNum)
 {
-    codebook.clear();
+    codebook = PackedCandidateSet(candidates.Length());
     auto lastSaveTime = chrono::steady_clock::now();
 
     vector<bool> remaining;
     if (not resume)
     {
         IndicesToSet(remaining, candidates.size());
+        // Nodes masked out of the graph are not candidates of this codebook
+        for (int i = 0; i < (int)remaining.size(); i++)
+        {
+            if (!adjList.Active(i))
+                remaining[i] = false;
+        }
         SaveProgressCodebook(remaining, adjList, codebook);
     }
     else
@@ -693,6 +2086,32 @@ void Codebook(AdjList &adjList, vector<string> &codebook, const vector<string> &
         LoadProgressCodebook(remaining, adjList, codebook, candidates.size());
     }
 
+    // These solvers run to the end in one go; a resumed run continues with the sequential greedy
+    if ((solver.method == "parallel" || solver.restarts > 1 || solver.kernel) && not resume)
+    {
+        vector<int> nodes;
+        if (solver.kernel)
+        {
+            auto start = chrono::steady_clock::now();
+            GraphKernel kernel(adjList, threadNum);
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            AdjList &reduced = kernel.Reduced();
+            std::cout << "Graph Kernel:\t" << NumberWithCommas(kernel.TakenNum()) << " taken\t"
+                      << NumberWithCommas(kernel.RemovedNum()) << " removed (" << NumberWithCommas(kernel.DominatedNum())
+                      << " dominated)\t" << NumberWithCommas(kernel.FoldNum()) << " folded\t"
+                      << NumberWithCommas(reduced.NodeCount()) << " of " << NumberWithCommas(adjList.RowNum())
+                      << " nodes and " << NumberWithCommas(reduced.EntryCount() / 2) << " edges left\t" << fixed
+                      << setprecision(2) << elapsed.count() << "\tseconds" << std::endl;
+            nodes = kernel.Lift(GreedyNodes(reduced, solver, threadNum));
+        }
+        else
+            nodes = GreedyNodes(adjList, solver, threadNum);
+        for (int node : nodes)
+            codebook.Append(candidates, node);
+        DelProgressCodebook();
+        return;
+    }
+
     double minSumRowTime = 0.0, delBallTime = 0.0;
 
     while (not adjList.empty())
@@ -702,7 +2121,7 @@ void Codebook(AdjList &adjList, vector<string> &codebook, const vector<string> &
 
         // // (1) Choose min sum row and delete its ball
         int minEntry = adjList.FindMinDel(remaining, minSumRowTime, delBallTime);
-        codebook.push_back(candidates[minEntry]);
+        codebook.Append(candidates, minEntry);
 
         // (2) Remove max sum row candidate without adding to codebook
         // adjList.FindMaxDel(remaining, minSumRowTime, delBallTime);
@@ -725,39 +2144,91 @@ void Codebook(AdjList &adjList, vector<string> &codebook, const vector<string> &
     for (int i = 0; i < (int)remaining.size(); i++)
     {
         if (remaining[i])
-            codebook.push_back(candidates[i]);
+            codebook.Append(candidates, i);
     }
     DelProgressCodebook();
 }
 
+// Stores a freshly built graph in the cache; a failure only costs the next run a rebuild
+void StoreGraphInCache(const AdjList &adjList, const GraphParams &graph, const IGraphHeader &cacheKey)
+{
+    try
+    {
+        StoreCachedGraph(adjList, graph.cacheDir, cacheKey);
+        std::cout << "Graph Cache:\tstored\t" << cacheKey.FileName() << endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Warning: could not store the graph in the cache: " << e.what() << endl;
+    }
+}
+
+// Stores the rows of a built graph in graph.vertexOrder before the greedy; the caller rebuilds the buckets
+void ReorderGraph(AdjList &adjList, const GraphParams &graph, bool silent)
+{
+    if (graph.vertexOrder == "none")
+        return;
+    auto start = chrono::steady_clock::now();
+    const bool relabelled = adjList.Relabel(graph.vertexOrder);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    if (silent)
+        return;
+    if (relabelled)
+        std::cout << "Vertex Order:\t" << graph.vertexOrder << "\t" << fixed << setprecision(2) << elapsed.count()
+                  << "\tseconds" << endl;
+    else
+        std::cout << "Vertex Order:\tkept node order (compressed, bit-matrix and out-of-core graphs are not relabelled)" << endl;
+}
+
 // Updated signature to include useGPU flag and isBinary flag
-void CodebookAdjList(const vector<string> &candidates, vector<string> &codebook, const int minED, const int threadNum,
-                     const int saveInterval, long long int &matrixOnesNum,
+void CodebookAdjList(const PackedCandidateSet &candidates, PackedCandidateSet &codebook, const int minED,
+                     const int threadNum, const int saveInterval, long long int &matrixOnesNum,
                      std::chrono::duration<double> &fillAdjListTime, std::chrono::duration<double> &processMatrixTime,
-                     const bool useGPU, double maxGPUMemoryGB, const string &candFilename = "", bool isBinary = false) // ADDED Arguments
+                     const bool useGPU, double maxGPUMemoryGB, const GraphParams &graph, const SolverParams &solver,
+                     bool isBinary = false)
 {
     AdjList adjList;
+    adjList.SetCompressed(graph.compressGraph);
+    adjList.SetBitsetBudget((size_t)max(0, graph.bitsetMemoryMB) << 20);
+    adjList.SetExternalMemory((size_t)max(0, graph.graphMemoryMB) << 20);
     NumToFile(1, "progress_stage.txt");
 
     auto starta = chrono::steady_clock::now();
 
-    if (useGPU)
+    const IGraphHeader cacheKey = IGraphHeader::ForCandidates(candidates, minED);
+    const bool cached = !graph.cacheDir.empty() && LoadCachedGraph(adjList, graph.cacheDir, cacheKey);
+    if (cached)
+    {
+        matrixOnesNum = (long long int)adjList.EntryCount();
+        std::cout << "Graph Cache:\thit\t" << cacheKey.FileName() << endl;
+    }
+    else if (useGPU)
     {
         // --- INTEGRATION CHANGE: USE GPU SOLVER ---
-        // Pass the existing filename (candFilename) to avoid redundant writing
         std::cout << "[C++] Mode: GPU Accelerated (Max Mem: " << maxGPUMemoryGB << " GB) (Binary: " << isBinary << ")" << endl;
-        FillAdjListGPU(adjList, candidates, minED, matrixOnesNum, candFilename, maxGPUMemoryGB, false, isBinary);
+        FillAdjListGPU(adjList, candidates, minED, threadNum, matrixOnesNum, maxGPUMemoryGB, false, isBinary);
     }
     else
     {
         // --- ORIGINAL: CPU THREADED SOLVER ---
         std::cout << "[C++] Mode: CPU Threaded" << endl;
-        FillAdjList(adjList, candidates, minED, threadNum, saveInterval, false, matrixOnesNum);
+        FillAdjList(adjList, candidates, minED, threadNum, saveInterval, false, matrixOnesNum, graph);
     }
+    if (!cached && !graph.cacheDir.empty())
+        StoreGraphInCache(adjList, graph, cacheKey);
+    ReorderGraph(adjList, graph, false);
 
     adjList.RowsBySum(); // Must build the optimization map after loading
     // ------------------------------------------
 
+    const size_t edgeNum = adjList.EntryCount() / 2;
+    const char *storage =
+        adjList.Mapped() ? "mapped" : adjList.Bitset() ? "bitset" : graph.compressGraph ? "compressed" : "plain";
+    std::cout << "Graph Storage:\t" << storage << "\t"
+              << NumberWithCommas((long long int)adjList.NeighbourBytes()) << " bytes of neighbour lists\t" << fixed
+              << setprecision(2) << (edgeNum ? (double)adjList.NeighbourBytes() / edgeNum : 0.0) << " bytes per edge"
+              << endl;
+
     auto enda = chrono::steady_clock::now();
     fillAdjListTime = enda - starta;
     std::cout << "Fill AdjList Time:\t" << fixed << setprecision(2) << fillAdjListTime.count() << "\tseconds" << endl;
@@ -766,7 +2237,7 @@ void CodebookAdjList(const vector<string> &candidates, vector<string> &codebook,
     LongLongIntToFile(matrixOnesNum, "matrix_ones_num.txt");
 
     auto startc = chrono::steady_clock::now();
-    Codebook(adjList, codebook, candidates, saveInterval, false);
+    Codebook(adjList, codebook, candidates, saveInterval, false, solver, threadNum);
     auto endc = chrono::steady_clock::now();
     processMatrixTime = endc - startc;
     std::cout << "Process Matrix Time:\t" << fixed << setprecision(2) << processMatrixTime.count() << "\tseconds"
@@ -776,13 +2247,38 @@ void CodebookAdjList(const vector<string> &candidates, vector<string> &codebook,
     remove("matrix_ones_num.txt");
 }
 
+// The memory-only min-degree greedy of the clustered solver (Codebook without the progress files)
+PackedCandidateSet GreedyIndependentSet(AdjList &adjList, const PackedCandidateSet &candidates)
+{
+    adjList.RowsBySum();
+
+    PackedCandidateSet result_codebook(candidates.Length());
+    vector<bool> remaining;
+    IndicesToSet(remaining, candidates.size());
+
+    double d1 = 0, d2 = 0;
+    while (!adjList.empty())
+    {
+        int minEntry = adjList.FindMinDel(remaining, d1, d2);
+        result_codebook.Append(candidates, minEntry);
+    }
+    for (int i = 0; i < (int)remaining.size(); i++)
+    {
+        if (remaining[i])
+            result_codebook.Append(candidates, i);
+    }
+
+    return result_codebook;
+}
+
 /**
  * @brief Solves the Independent Set problem for a given set of candidates.
  * @return A subset of candidates forming the codebook.
  */
 // Optimized version that reuses the GPU logic if enabled
-std::vector<std::string> SolveIndependentSet(const std::vector<std::string> &candidates, const int minED,
-                                             const int threadNum, const bool useGPU, double maxGPUMemoryGB, bool isBinary = false)
+PackedCandidateSet SolveIndependentSet(const PackedCandidateSet &candidates, const int minED, const int threadNum,
+                                       const bool useGPU, double maxGPUMemoryGB, const GraphParams &graph,
+                                       bool isBinary)
 {
     // If empty or trivial
     if (candidates.empty())
@@ -791,85 +2287,148 @@ std::vector<std::string> SolveIndependentSet(const std::vector<std::string> &can
         return candidates;
 
     AdjList adjList;
+    adjList.SetCompressed(graph.compressGraph);
+    adjList.SetBitsetBudget((size_t)max(0, graph.bitsetMemoryMB) << 20);
+    adjList.SetExternalMemory((size_t)max(0, graph.graphMemoryMB) << 20);
     long long int matrixOnesNum = 0;
 
     // Fill AdjList (Graph Construction)
-    // We use a temporary filename for GPU interaction if needed
-    // Use a unique name to avoid collision if running in parallel logic
-    static std::atomic<int> call_count{0};
-    string candFilename = "temp_cand_" + to_string(call_count++) + ".txt";
-
-    // We need to write candidates to file for GPU logic
-    if (useGPU)
-    {
-        StrVecToFile(candidates, candFilename);
-    }
-
     if (useGPU)
     {
         // Suppress some output during inner loops
         // std::cout << "..." << endl;
-        FillAdjListGPU(adjList, candidates, minED, matrixOnesNum, candFilename, maxGPUMemoryGB, true, isBinary);
+        FillAdjListGPU(adjList, candidates, minED, threadNum, matrixOnesNum, maxGPUMemoryGB, true, isBinary);
     }
     else
     {
-        FillAdjList(adjList, candidates, minED, threadNum, 0, false, matrixOnesNum);
+        FillAdjList(adjList, candidates, minED, threadNum, 0, false, matrixOnesNum, graph, true);
     }
+    ReorderGraph(adjList, graph, true);
 
-    adjList.RowsBySum();
-
-    // Solve Codebook (Max Independent Set / Min Vertex Cover on Complement)
-    // Using existing Codebook function logic but without persistence/files for inner loops ideally
-    // But existing Codebook function relies on persistence?
-    // Let's copy the core logic of `Codebook` here but simplified for memory-only operation
-    // OR just use the existing `Codebook` function and cleanup files.
+    return GreedyIndependentSet(adjList, candidates);
+}
 
-    // Optimized memory-only version of "Codebook" function logic:
-    std::vector<std::string> result_codebook;
-    vector<bool> remaining;
-    IndicesToSet(remaining, candidates.size());
+// Solves a cluster whose conflict edges a persistent worker already built, as (u, v) records in the cluster's own
+// numbering
+PackedCandidateSet SolveIndependentSetFromEdges(const PackedCandidateSet &candidates, vector<pair<int, int>> &edges,
+                                                const int threadNum, const GraphParams &graph)
+{
+    if (candidates.size() <= 1)
+        return candidates;
 
-    double d1 = 0, d2 = 0;
-    while (!adjList.empty())
+    AdjList adjList;
+    adjList.SetCompressed(graph.compressGraph);
+    adjList.SetBitsetBudget((size_t)max(0, graph.bitsetMemoryMB) << 20);
+    adjList.SetExternalMemory((size_t)max(0, graph.graphMemoryMB) << 20);
+    adjList.Init(candidates.size());
+    if (adjList.ExternalBudget() > 0)
     {
-        int minEntry = adjList.FindMinDel(remaining, d1, d2);
-        result_codebook.push_back(candidates[minEntry]);
+        const string prefix = NextGraphFilePrefix();
+        EdgeRunWriter runs(prefix, adjList.ExternalBudget(), 1, false);
+        runs.Spill(edges);
+        adjList.BuildFromRuns(runs.Runs(), prefix + ".csr");
     }
-    for (int i = 0; i < (int)remaining.size(); i++)
+    else
     {
-        if (remaining[i])
-            result_codebook.push_back(candidates[i]);
+        vector<vector<pair<int, int>>> edgeLists(1);
+        edgeLists[0].swap(edges);
+        adjList.Build(edgeLists, threadNum);
     }
+    ReorderGraph(adjList, graph, true);
+    return GreedyIndependentSet(adjList, candidates);
+}
 
-    // Cleanup
-    if (useGPU)
+// Candidates and cache key of a sharded graph build; every shard and the merge generate the same candidates
+IGraphHeader ShardedGraphKey(const Params &params, PackedCandidateSet &candidates)
+{
+    if (params.graph.cacheDir.empty())
+        throw std::runtime_error("Sharded graph builds keep their shards in the graph cache: set --graphCache");
+    candidates = Candidates(params);
+    std::cout << "Number of Candidates: " << NumberWithCommas(candidates.size()) << std::endl;
+    return IGraphHeader::ForCandidates(candidates, params.codeMinED);
+}
+
+void GenerateGraphShard(const Params &params)
+{
+    auto start = chrono::steady_clock::now();
+    PrintTestParams(params);
+    PackedCandidateSet candidates;
+    const IGraphHeader key = ShardedGraphKey(params, candidates);
+    const int shardIndex = params.graphShardIndex, shardCount = params.graphShardCount;
+    std::cout << "Graph Shard:\t" << shardIndex << "/" << shardCount << "\t" << key.FileName() << endl;
+    if (GraphShardDone(params.graph.cacheDir, key, shardIndex, shardCount, params.graph.compositionTiles))
     {
-        remove(candFilename.c_str());
+        std::cout << "Graph Shard:\talready complete" << endl;
+        return;
     }
+    if (params.graph.builder != "allpairs")
+        std::cout << "Graph Shard:\tshards are cut from the allpairs tiles; ignoring builder '" << params.graph.builder
+                  << "'" << endl;
+
+    // Without a memory budget every thread spills its pairs once, at the end
+    std::filesystem::create_directories(params.graph.cacheDir);
+    const int threadNum = max(1, params.threadNum);
+    const size_t budget = params.graph.graphMemoryMB > 0 ? (size_t)params.graph.graphMemoryMB << 20
+                                                         : std::numeric_limits<size_t>::max() / 2;
+    EdgeRunWriter runs(GraphShardPrefix(params.graph.cacheDir, key, shardIndex, shardCount), budget, threadNum, false);
+    vector<vector<pair<int, int>>> threadPairVecs(threadNum);
+    GraphShardCut cut;
+    cut.itemNum = (uint32_t)FillPairsAllPairs(threadPairVecs, candidates, params.codeMinED, false, 0, params.graph,
+                                              &runs, false, nullptr, shardIndex, shardCount);
+    cut.compositionTiles = params.graph.compositionTiles;
+    for (vector<pair<int, int>> &thvec : threadPairVecs)
+        runs.Spill(thvec);
+    const vector<string> runFiles = runs.Runs();
+    size_t keyNum = 0;
+    for (const string &run : runFiles)
+        keyNum += std::filesystem::file_size(run) / sizeof(uint64_t);
+    CommitGraphShard(params.graph.cacheDir, key, shardIndex, shardCount, cut, runFiles);
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    std::cout << "Graph Shard:\t" << shardIndex << "/" << shardCount << "\t"
+              << NumberWithCommas((long long int)(keyNum / 2)) << " edges\t" << runFiles.size() << " runs\t" << fixed
+              << setprecision(2) << elapsed.count() << "\tseconds" << endl;
+}
 
-    return result_codebook;
+void GenerateGraphMerge(const Params &params)
+{
+    auto start = chrono::steady_clock::now();
+    PrintTestParams(params);
+    PackedCandidateSet candidates;
+    const IGraphHeader key = ShardedGraphKey(params, candidates);
+    const size_t budget = (size_t)(params.graph.graphMemoryMB > 0 ? params.graph.graphMemoryMB : 256) << 20;
+    const string path = MergeGraphShards(params.graph.cacheDir, key, budget);
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    std::cout << "Graph Merge:\t" << path << "\t" << fixed << setprecision(2) << elapsed.count() << "\tseconds"
+              << endl;
+    std::cout << "Graph Merge:\trun again without --graph-merge and with this graph cache to solve" << endl;
 }
 
-void CodebookAdjListResumeFromFile(const vector<string> &candidates, vector<string> &codebook, const Params &params,
-                                   long long int &matrixOnesNum)
+void CodebookAdjListResumeFromFile(const PackedCandidateSet &candidates, PackedCandidateSet &codebook,
+                                   const Params &params, long long int &matrixOnesNum)
 {
     AdjList adjList;
+    adjList.SetCompressed(params.graph.compressGraph);
+    adjList.SetBitsetBudget((size_t)max(0, params.graph.bitsetMemoryMB) << 20);
+    adjList.SetExternalMemory((size_t)max(0, params.graph.graphMemoryMB) << 20);
     int stage;
     FileToNum(stage, "progress_stage.txt");
     if (stage == 1)
     {
         std::cout << "Resuming adj list comp" << endl;
         // Resume logic currently uses CPU. If restart is needed, it will use GPU from scratch.
-        FillAdjList(adjList, candidates, params.codeMinED, params.threadNum, params.saveInterval, true, matrixOnesNum);
+        FillAdjList(adjList, candidates, params.codeMinED, params.threadNum, params.saveInterval, true, matrixOnesNum,
+                    params.graph);
         NumToFile(2, "progress_stage.txt");
-        Codebook(adjList, codebook, candidates, params.saveInterval, false);
+        Codebook(adjList, codebook, candidates, params.saveInterval, false, params.solver, params.threadNum);
     }
     else
     {
         assert(stage == 2);
         std::cout << "Resuming codebook comp" << endl;
         FileToLongLongInt(matrixOnesNum, "matrix_ones_num.txt");
-        Codebook(adjList, codebook, candidates, params.saveInterval, true);
+        Codebook(adjList, codebook, candidates, params.saveInterval, true, params.solver, params.threadNum);
         remove("matrix_ones_num.txt");
     }
     remove("progress_stage.txt");
@@ -882,13 +2441,13 @@ void GenerateCodebookAdj(const Params &params)
     PrintTestParams(params);
 
     auto start_candidates = std::chrono::steady_clock::now();
-    vector<string> candidates = Candidates(params);
+    PackedCandidateSet candidates = Candidates(params);
     std::cout << "Number of Candidates: " << NumberWithCommas(candidates.size()) << std::endl;
+    std::cout << "Candidate Store:\t" << fixed << setprecision(2) << candidates.MemoryBytes() / (1024.0 * 1024.0)
+              << "\tMB (2-bit packed)" << std::endl;
 
     // This file is saved here for checkpointing.
-    // We will reuse this filename for the GPU input to avoid re-writing 262k strings.
-    string candFilename = "progress_cand.txt";
-    StrVecToFile(candidates, candFilename);
+    PackedToFile(candidates, "progress_cand.txt");
 
     auto end_candidates = std::chrono::steady_clock::now();
     std::chrono::duration<double> elapsed_secs_candidates = end_candidates - start_candidates;
@@ -897,7 +2456,7 @@ void GenerateCodebookAdj(const Params &params)
 
     std::chrono::duration<double> fillAdjListTime, processMatrixTime;
 
-    vector<string> codebook;
+    PackedCandidateSet codebook;
     long long int matrixOnesNum;
 
     // --- REFACTORED LOGIC FOR CLUSTERING ---
@@ -911,19 +2470,36 @@ void GenerateCodebookAdj(const Params &params)
         std::cout << "Clustering disabled. Running standard generation..." << std::endl;
         bool isBinary = (params.method == GenerationMethod::LINEAR_BINARY_CODE || 
                          params.method == GenerationMethod::BINARY_FILE_READ);
-        // Pass candFilename to the function
         CodebookAdjList(candidates, codebook, params.codeMinED, params.threadNum, params.saveInterval, matrixOnesNum,
-                        fillAdjListTime, processMatrixTime, params.useGPU, params.maxGPUMemoryGB, candFilename, isBinary);
+                        fillAdjListTime, processMatrixTime, params.useGPU, params.maxGPUMemoryGB, params.graph,
+                        params.solver, isBinary);
     }
     else
     {
         // NEW BEHAVIOR: Iterative Clustering
         std::cout << "Clustering enabled. Starting iterative process..." << std::endl;
 
-        std::vector<std::string> current_candidates = candidates;
+        PackedCandidateSet current_candidates = candidates;
         std::vector<size_t> previous_sizes;
         int iteration = 0;
 
+        // The distance backend stays up for the whole run and takes the clusters in batches, instead of a process
+        // (and its interpreter and CUDA start-up) per cluster per iteration
+        std::unique_ptr<GraphWorker> graphWorker;
+        if (params.useGPU)
+        {
+            bool isBinary = (params.method == GenerationMethod::LINEAR_BINARY_CODE ||
+                             params.method == GenerationMethod::BINARY_FILE_READ);
+            const vector<string> command =
+                GraphBackendCommand(params.codeMinED, params.threadNum, params.maxGPUMemoryGB, isBinary);
+            std::cout << "[C++] Starting graph worker:";
+            for (const string &arg : command)
+                std::cout << " " << arg;
+            std::cout << endl;
+            graphWorker.reset(new GraphWorker(command, true));
+        }
+        int total_batches = 0;
+
         while (true)
         {
             auto iter_start = std::chrono::steady_clock::now();
@@ -953,7 +2529,7 @@ void GenerateCodebookAdj(const Params &params)
                              params.method == GenerationMethod::BINARY_FILE_READ);
             // Configure KMeansAdapter with user config method
             indexgen::clustering::KMeansAdapter adapter(effective_k, params.clustering.method, isBinary);
-            std::vector<std::vector<std::string>> clusters = adapter.cluster(current_candidates);
+            std::vector<PackedCandidateSet> clusters = adapter.cluster(current_candidates);
 
             std::cout << "Clustering produced " << clusters.size() << " clusters." << std::endl;
 
@@ -961,8 +2537,8 @@ void GenerateCodebookAdj(const Params &params)
             double clustering_time = std::chrono::duration<double>(cluster_end - cluster_start).count();
 
             // Step 2: Solve Independent Set per Cluster
-            std::vector<std::string> next_candidates;
-            std::vector<std::vector<std::string>> cluster_results(clusters.size());
+            PackedCandidateSet next_candidates(current_candidates.Length());
+            std::vector<PackedCandidateSet> cluster_results(clusters.size());
 
             auto solve_start = std::chrono::steady_clock::now();
 
@@ -971,41 +2547,109 @@ void GenerateCodebookAdj(const Params &params)
             individual_solve_times.reserve(clusters.size());
 
             int num_clusters = clusters.size();
-            std::atomic<int> next_cluster{0};
             std::mutex times_mutex;
 
             int num_concurrent = std::min((int)clusters.size(), params.threadNum);
             double mem_limit = params.maxGPUMemoryGB;
-            if (params.useGPU)
+            if (params.useGPU && !graphWorker)
             {
                 // To avoid OOM, divide raw memory proportionally
                 mem_limit = std::max(0.5, params.maxGPUMemoryGB / num_concurrent);
             }
 
+            // With the persistent worker, consecutive clusters go over together as one batch of jobs. A batch is cut
+            // at a share of the candidates that keeps every solver thread busy (and at the largest cluster size), so
+            // one thread runs the greedy on a batch's graphs while the worker builds the next batch
+            std::vector<int> batch_starts{0};
+            if (graphWorker)
+            {
+                const size_t batch_target =
+                    std::max<size_t>(1, std::min<size_t>(MAX_CLUSTER_SIZE, current_candidates.size() / num_concurrent));
+                size_t batch_size = 0;
+                for (int i = 0; i < num_clusters; ++i)
+                {
+                    batch_size += clusters[i].size();
+                    if (batch_size >= batch_target && i + 1 < num_clusters)
+                    {
+                        batch_starts.push_back(i + 1);
+                        batch_size = 0;
+                    }
+                }
+            }
+            else
+            {
+                for (int i = 1; i < num_clusters; ++i)
+                    batch_starts.push_back(i);
+            }
+            batch_starts.push_back(num_clusters);
+            const int num_batches = (int)batch_starts.size() - 1;
+            if (graphWorker)
+                total_batches += num_batches;
+            std::atomic<int> next_batch{0};
+            std::exception_ptr worker_error;
+
             auto worker_func = [&]()
             {
                 while (true)
                 {
-                    int i = next_cluster++;
-                    if (i >= num_clusters)
+                    int b = next_batch++;
+                    if (b >= num_batches)
                         break;
 
-                    auto single_solve_start = std::chrono::steady_clock::now();
-
                     int threads_for_this = 1;
                     if (!params.useGPU)
                     {
                         threads_for_this = std::max(1, params.threadNum / num_concurrent);
                     }
 
-                    cluster_results[i] =
-                        SolveIndependentSet(clusters[i], params.codeMinED, threads_for_this, params.useGPU, mem_limit, isBinary);
+                    if (!graphWorker)
+                    {
+                        int i = batch_starts[b];
+                        auto single_solve_start = std::chrono::steady_clock::now();
+
+                        cluster_results[i] = SolveIndependentSet(clusters[i], params.codeMinED, threads_for_this,
+                                                                 params.useGPU, mem_limit, params.graph, isBinary);
 
-                    auto single_solve_end = std::chrono::steady_clock::now();
-                    double duration = std::chrono::duration<double>(single_solve_end - single_solve_start).count();
+                        auto single_solve_end = std::chrono::steady_clock::now();
+                        double duration = std::chrono::duration<double>(single_solve_end - single_solve_start).count();
 
-                    std::lock_guard<std::mutex> lock(times_mutex);
-                    individual_solve_times.push_back(duration);
+                        std::lock_guard<std::mutex> lock(times_mutex);
+                        individual_solve_times.push_back(duration);
+                        continue;
+                    }
+
+                    // Each cluster is charged its share of the batch's backend time plus its own greedy
+                    auto batch_start = std::chrono::steady_clock::now();
+                    std::vector<const PackedCandidateSet *> jobs;
+                    for (int i = batch_starts[b]; i < batch_starts[b + 1]; ++i)
+                        jobs.push_back(&clusters[i]);
+                    std::vector<std::vector<std::pair<int, int>>> job_edges;
+                    try
+                    {
+                        job_edges = graphWorker->Run(jobs);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(times_mutex);
+                        if (!worker_error)
+                            worker_error = std::current_exception();
+                        continue;
+                    }
+                    double backend_share =
+                        std::chrono::duration<double>(std::chrono::steady_clock::now() - batch_start).count() /
+                        jobs.size();
+                    for (size_t j = 0; j < jobs.size(); ++j)
+                    {
+                        auto single_solve_start = std::chrono::steady_clock::now();
+                        cluster_results[batch_starts[b] + j] =
+                            SolveIndependentSetFromEdges(*jobs[j], job_edges[j], threads_for_this, params.graph);
+                        double duration = backend_share + std::chrono::duration<double>(
+                                                              std::chrono::steady_clock::now() - single_solve_start)
+                                                              .count();
+
+                        std::lock_guard<std::mutex> lock(times_mutex);
+                        individual_solve_times.push_back(duration);
+                    }
                 }
             };
 
@@ -1018,6 +2662,8 @@ void GenerateCodebookAdj(const Params &params)
             {
                 w.join();
             }
+            if (worker_error)
+                std::rethrow_exception(worker_error);
 
             auto solve_end = std::chrono::steady_clock::now();
             double solving_total_time = std::chrono::duration<double>(solve_end - solve_start).count();
@@ -1028,7 +2674,7 @@ void GenerateCodebookAdj(const Params &params)
             // Step 3: Combine
             for (const auto &res : cluster_results)
             {
-                next_candidates.insert(next_candidates.end(), res.begin(), res.end());
+                next_candidates.AppendAll(res);
             }
 
             // Step 4: Check Convergence (3 iterations identical size)
@@ -1058,6 +2704,8 @@ void GenerateCodebookAdj(const Params &params)
                           << std::endl;
                 std::cout << "  - Avg Cluster Solve:    " << fixed << setprecision(3) << avg_solve_time << " s"
                           << std::endl;
+                if (graphWorker)
+                    std::cout << "  - Worker Batches:       " << num_batches << std::endl;
             }
 
             int converge_n = params.clustering.convergenceIterations;
@@ -1092,6 +2740,12 @@ void GenerateCodebookAdj(const Params &params)
             // Update for next iteration
             current_candidates = next_candidates;
         }
+        if (graphWorker)
+        {
+            graphWorker->Close();
+            std::cout << "[C++] Graph worker served " << NumberWithCommas((long long int)total_batches)
+                      << " batches." << std::endl;
+        }
     }
 
     long long int candidateNum = candidates.size(); // Original candidates count
@@ -1143,6 +2797,206 @@ void GenerateCodebookAdj(const Params &params)
     std::cout << "=====================================================" << std::endl;
 }
 
+// Runs the greedy once per filter cell on the subgraph induced by the cell's candidates, and writes every codebook to
+// the cell's directory as a separate run with the cell's filters would write it
+void SolveFilterCells(AdjList &adjList, const PackedCandidateSet &candidates,
+                      const vector<ConstraintSignature> &signatures, const vector<FilterCell> &cells, Params &params,
+                      const std::chrono::duration<double> &candidatesTime,
+                      const std::chrono::duration<double> &fillAdjListTime,
+                      const std::chrono::steady_clock::time_point &start)
+{
+    const int maxRun = params.maxRun;
+    const double minGCCont = params.minGCCont, maxGCCont = params.maxGCCont;
+    vector<bool> active(candidates.size());
+    for (const FilterCell &cell : cells)
+    {
+        auto startProcess = std::chrono::steady_clock::now();
+        int candidateNum = 0;
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            active[i] = signatures[i].Passes(candidates.Length(), cell.maxRun, cell.minGCCont, cell.maxGCCont);
+            candidateNum += active[i] ? 1 : 0;
+        }
+        const long long int matrixOnesNum = (long long int)adjList.MaskNodes(active);
+        adjList.RowsBySum();
+
+        PackedCandidateSet codebook;
+        Codebook(adjList, codebook, candidates, 0, false, params.solver, params.threadNum);
+        std::chrono::duration<double> processMatrixTime = std::chrono::steady_clock::now() - startProcess;
+        std::cout << "Filter Sweep:\t" << cell.Label() << "\tED" << params.codeMinED << "\t"
+                  << NumberWithCommas(candidateNum) << " candidates\t" << NumberWithCommas(matrixOnesNum / 2)
+                  << " edges\t" << NumberWithCommas(codebook.size()) << " codewords\t" << fixed << setprecision(2)
+                  << processMatrixTime.count() << "\tseconds" << std::endl;
+
+        params.maxRun = cell.maxRun;
+        params.minGCCont = cell.minGCCont;
+        params.maxGCCont = cell.maxGCCont;
+        PrintTestResults(candidateNum, matrixOnesNum, codebook.size());
+        std::chrono::duration<double> overAllTime = std::chrono::steady_clock::now() - start;
+        ToFile(codebook, params, candidateNum, matrixOnesNum, candidatesTime, fillAdjListTime, processMatrixTime,
+               overAllTime, -1, -1, cell.Label());
+        if (params.verify)
+        {
+            const bool isBinary = (params.method == GenerationMethod::LINEAR_BINARY_CODE ||
+                                   params.method == GenerationMethod::BINARY_FILE_READ);
+            VerifyDist(codebook, params.codeMinED, params.threadNum, params.useGPU, params.maxGPUMemoryGB, isBinary);
+        }
+    }
+    params.maxRun = maxRun;
+    params.minGCCont = minGCCont;
+    params.maxGCCont = maxGCCont;
+}
+
+// Generates the candidates of a run: the unfiltered superset with its signatures when sweeping filter cells
+PackedCandidateSet RunCandidates(Params &params, const vector<FilterCell> &cells,
+                                 vector<ConstraintSignature> &signatures,
+                                 std::chrono::duration<double> &candidatesTime)
+{
+    auto start_candidates = std::chrono::steady_clock::now();
+    PackedCandidateSet candidates = cells.empty() ? Candidates(params) : UnfilteredCandidates(params);
+    if (!cells.empty())
+    {
+        const bool isBinary = (params.method == GenerationMethod::LINEAR_BINARY_CODE ||
+                               params.method == GenerationMethod::BINARY_FILE_READ);
+        signatures = ConstraintSignatures(candidates, isBinary);
+        std::cout << "Filter Sweep:\t" << cells.size() << " cells over the unfiltered candidates:";
+        for (const FilterCell &cell : cells)
+            std::cout << " " << cell.Label();
+        std::cout << std::endl;
+    }
+    std::cout << "Number of Candidates: " << NumberWithCommas(candidates.size()) << std::endl;
+    candidatesTime = std::chrono::steady_clock::now() - start_candidates;
+    std::cout << "Candidates Time: " << fixed << setprecision(2) << candidatesTime.count() << "\tseconds" << std::endl;
+    return candidates;
+}
+
+void GenerateCodebooksAdjSweep(Params &params)
+{
+    auto start = std::chrono::steady_clock::now();
+    PrintTestParams(params);
+    const vector<FilterCell> cells = FilterCells(params);
+    vector<ConstraintSignature> signatures;
+    std::chrono::duration<double> candidatesTime;
+    PackedCandidateSet candidates = RunCandidates(params, cells, signatures, candidatesTime);
+
+    if (params.useGPU)
+        std::cout << "Filter Sweep:\tthe superset graph is built by the CPU engines, using them" << std::endl;
+
+    auto startFill = std::chrono::steady_clock::now();
+    AdjList adjList;
+    adjList.SetCompressed(params.graph.compressGraph);
+    adjList.SetBitsetBudget((size_t)max(0, params.graph.bitsetMemoryMB) << 20);
+    adjList.SetExternalMemory((size_t)max(0, params.graph.graphMemoryMB) << 20);
+    long long int matrixOnesNum = 0;
+    const IGraphHeader cacheKey = IGraphHeader::ForCandidates(candidates, params.codeMinED);
+    const bool cached = !params.graph.cacheDir.empty() && LoadCachedGraph(adjList, params.graph.cacheDir, cacheKey);
+    if (cached)
+        std::cout << "Graph Cache:\thit\t" << cacheKey.FileName() << endl;
+    else
+    {
+        FillAdjList(adjList, candidates, params.codeMinED, params.threadNum, 0, false, matrixOnesNum, params.graph);
+        if (!params.graph.cacheDir.empty())
+            StoreGraphInCache(adjList, params.graph, cacheKey);
+    }
+    ReorderGraph(adjList, params.graph, false);
+    std::chrono::duration<double> fillAdjListTime = std::chrono::steady_clock::now() - startFill;
+    std::cout << "Fill AdjList Time:\t" << fixed << setprecision(2) << fillAdjListTime.count() << "\tseconds" << endl;
+
+    SolveFilterCells(adjList, candidates, signatures, cells, params, candidatesTime, fillAdjListTime, start);
+
+    std::chrono::duration<double> overAllTime = std::chrono::steady_clock::now() - start;
+    std::cout << "Codebook Time: " << fixed << setprecision(2) << overAllTime.count() << "\tseconds" << std::endl;
+    std::cout << "=====================================================" << std::endl;
+}
+
+void GenerateCodebooksAdjLabelled(Params &params)
+{
+    auto start = std::chrono::steady_clock::now();
+    vector<int> minEDs = params.editDists;
+    sort(minEDs.rbegin(), minEDs.rend());
+    minEDs.erase(unique(minEDs.begin(), minEDs.end()), minEDs.end());
+    const int maxED = minEDs.front();
+    params.codeMinED = maxED;
+    PrintTestParams(params);
+
+    const vector<FilterCell> cells = FilterCells(params);
+    vector<ConstraintSignature> signatures;
+    std::chrono::duration<double> candidatesTime;
+    PackedCandidateSet candidates = RunCandidates(params, cells, signatures, candidatesTime);
+
+    if (params.useGPU || params.graph.builder != "allpairs")
+        std::cout << "Labelled Graph:\tdistance labels come from the CPU allpairs engine, using it" << std::endl;
+
+    // One scan at the largest threshold; every conflict keeps its exact distance
+    auto startFill = std::chrono::steady_clock::now();
+    vector<vector<pair<int, int>>> threadPairVecs(params.threadNum);
+    vector<vector<uint8_t>> threadLabelVecs(params.threadNum);
+    FillPairsAllPairs(threadPairVecs, candidates, maxED, false, 0, params.graph, nullptr, false, &threadLabelVecs);
+    std::chrono::duration<double> fillAdjListTime = std::chrono::steady_clock::now() - startFill;
+    std::cout << "Fill AdjList Time:\t" << fixed << setprecision(2) << fillAdjListTime.count() << "\tseconds" << endl;
+
+    for (int minED : minEDs)
+    {
+        // Thresholds are visited in decreasing order, so dropping the edges at distance >= minED only shrinks the lists
+        auto startProcess = std::chrono::steady_clock::now();
+        for (int t = 0; t < params.threadNum; t++)
+        {
+            vector<pair<int, int>> &pairs = threadPairVecs[t];
+            vector<uint8_t> &labels = threadLabelVecs[t];
+            size_t kept = 0;
+            for (size_t k = 0; k < pairs.size(); ++k)
+            {
+                if (labels[k] < minED)
+                {
+                    pairs[kept] = pairs[k];
+                    labels[kept++] = labels[k];
+                }
+            }
+            pairs.resize(kept);
+            labels.resize(kept);
+        }
+
+        AdjList adjList;
+        adjList.SetCompressed(params.graph.compressGraph);
+        adjList.SetBitsetBudget((size_t)max(0, params.graph.bitsetMemoryMB) << 20);
+        adjList.Init(candidates.size());
+        adjList.Build(threadPairVecs, params.threadNum);
+        ReorderGraph(adjList, params.graph, false);
+        if (!cells.empty())
+        {
+            params.codeMinED = minED;
+            SolveFilterCells(adjList, candidates, signatures, cells, params, candidatesTime, fillAdjListTime, start);
+            continue;
+        }
+        adjList.RowsBySum();
+        const long long int matrixOnesNum = (long long int)adjList.EntryCount();
+
+        PackedCandidateSet codebook;
+        Codebook(adjList, codebook, candidates, 0, false, params.solver, params.threadNum);
+        std::chrono::duration<double> processMatrixTime = std::chrono::steady_clock::now() - startProcess;
+        std::cout << "Labelled Graph:\tED" << minED << "\t" << NumberWithCommas(matrixOnesNum / 2) << " edges\t"
+                  << NumberWithCommas(codebook.size()) << " codewords\t" << fixed << setprecision(2)
+                  << processMatrixTime.count() << "\tseconds" << std::endl;
+
+        params.codeMinED = minED;
+        PrintTestResults(candidates.size(), matrixOnesNum, codebook.size());
+        std::chrono::duration<double> overAllTime = std::chrono::steady_clock::now() - start;
+        ToFile(codebook, params, candidates.size(), matrixOnesNum, candidatesTime, fillAdjListTime, processMatrixTime,
+               overAllTime);
+        if (params.verify)
+        {
+            const bool isBinary = (params.method == GenerationMethod::LINEAR_BINARY_CODE ||
+                                   params.method == GenerationMethod::BINARY_FILE_READ);
+            VerifyDist(codebook, minED, params.threadNum, params.useGPU, params.maxGPUMemoryGB, isBinary);
+        }
+    }
+    params.codeMinED = maxED;
+
+    std::chrono::duration<double> overAllTime = std::chrono::steady_clock::now() - start;
+    std::cout << "Codebook Time: " << fixed << setprecision(2) << overAllTime.count() << "\tseconds" << std::endl;
+    std::cout << "=====================================================" << std::endl;
+}
+
 void GenerateCodebookAdjResumeFromFile()
 {
     try
@@ -1151,9 +3005,9 @@ void GenerateCodebookAdjResumeFromFile()
         FileToParams(params, "progress_params.txt");
         std::cout << "Resuming Codebook Adj from file" << std::endl;
         PrintTestParams(params);
-        vector<string> candidates;
-        FileToStrVec(candidates, "progress_cand.txt");
-        vector<string> codebook;
+        PackedCandidateSet candidates;
+        FileToPacked(candidates, "progress_cand.txt");
+        PackedCandidateSet codebook;
         int candidateNum = candidates.size();
         long long int matrixOnesNum;
         CodebookAdjListResumeFromFile(candidates, codebook, params, matrixOnesNum);
@@ -1177,4 +3031,79 @@ void GenerateCodebookAdjResumeFromFile()
     {
         std::cout << "Read/Write progress files error! Aborted." << std::endl;
     }
-}
\ No newline at end of file
+}
+
+// Runs as the CPU stand-in backend: reads the candidate memory file, builds the pairs with the all-pairs engine and
+// writes them to the edge pipe as (u, v) records with u < v
+int RunCpuGraphBackend(int candidateFd, int edgeFd, int minED, int threadNum)
+{
+    try
+    {
+        PackedCandidateSet candidates = ReadCandidateSegment(candidateFd);
+        close(candidateFd);
+        vector<vector<pair<int, int>>> threadPairVecs(max(1, threadNum));
+        FillPairsAllPairs(threadPairVecs, candidates, minED, false, 0, GraphParams(), nullptr, true);
+        for (vector<pair<int, int>> &pairs : threadPairVecs)
+        {
+            for (pair<int, int> &p : pairs)
+            {
+                if (p.first > p.second)
+                    swap(p.first, p.second);
+            }
+            WriteEdgeRecords(edgeFd, pairs.data(), pairs.size());
+            vector<pair<int, int>>().swap(pairs);
+        }
+        close(edgeFd);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Graph worker: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Runs as the CPU stand-in of a persistent worker: each batch's jobs are spread over the threads, a big job getting
+// several of them, and the replies go back in job order
+int RunCpuGraphWorker(int workerFd, int minED, int threadNum)
+{
+    try
+    {
+        threadNum = max(1, threadNum);
+        vector<PackedCandidateSet> jobs;
+        while (ReadJobBatch(workerFd, jobs))
+        {
+            const int jobNum = (int)jobs.size();
+            const int threadsPerJob = max(1, threadNum / max(1, jobNum));
+            vector<vector<pair<int, int>>> jobEdges(jobNum);
+            std::atomic<int> nextJob{0};
+            auto buildJobs = [&]() {
+                for (int j = nextJob++; j < jobNum; j = nextJob++)
+                {
+                    vector<vector<pair<int, int>>> threadPairVecs(threadsPerJob);
+                    FillPairsAllPairs(threadPairVecs, jobs[j], minED, false, 0, GraphParams(), nullptr, true);
+                    for (vector<pair<int, int>> &pairs : threadPairVecs)
+                    {
+                        for (const pair<int, int> &p : pairs)
+                            jobEdges[j].push_back(p.first < p.second ? p : make_pair(p.second, p.first));
+                        vector<pair<int, int>>().swap(pairs);
+                    }
+                }
+            };
+            vector<thread> threads;
+            for (int t = 0; t < min(jobNum, threadNum / threadsPerJob); t++)
+                threads.push_back(thread(buildJobs));
+            for (thread &th : threads)
+                th.join();
+            for (const vector<pair<int, int>> &edges : jobEdges)
+                WriteJobEdges(workerFd, edges);
+        }
+        close(workerFd);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Graph worker: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
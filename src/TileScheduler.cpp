@@ -0,0 +1,71 @@
+/**
+ * @file TileScheduler.cpp
+ * @brief Implements the lock-free tile queue.
+ */
+
+#include "TileScheduler.hpp"
+#include <algorithm>
+#include <utility>
+
+TileQueue::TileQueue(std::vector<uint32_t> items_, int threadNum_)
+    : items(std::move(items_)), slots(new Slot[std::max(1, threadNum_)]), threadNum(std::max(1, threadNum_))
+{
+    const uint64_t itemNum = items.size();
+    for (int t = 0; t < threadNum; ++t)
+    {
+        slots[t].range.store(Pack(itemNum * t / threadNum, itemNum * (t + 1) / threadNum), std::memory_order_relaxed);
+        slots[t].steals.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TileQueue::Next(int threadIdx, uint32_t &item)
+{
+    // Own range first, from the front
+    Slot &own = slots[threadIdx];
+    uint64_t range = own.range.load(std::memory_order_acquire);
+    while ((range >> 32) < (range & 0xFFFFFFFFULL))
+    {
+        const uint64_t begin = range >> 32;
+        if (own.range.compare_exchange_weak(range, Pack(begin + 1, range & 0xFFFFFFFFULL), std::memory_order_acq_rel))
+        {
+            item = items[begin];
+            return true;
+        }
+    }
+
+    // Then the back half of the first non-empty range after ours. A sweep that lost a race retries, so the queue only
+    // reports empty after a sweep that found every range empty.
+    bool contended = true;
+    while (contended)
+    {
+        contended = false;
+        for (int k = 1; k < threadNum; ++k)
+        {
+            Slot &victim = slots[(threadIdx + k) % threadNum];
+            range = victim.range.load(std::memory_order_acquire);
+            while ((range >> 32) < (range & 0xFFFFFFFFULL))
+            {
+                const uint64_t begin = range >> 32, end = range & 0xFFFFFFFFULL;
+                const uint64_t take = (end - begin + 1) / 2;
+                if (victim.range.compare_exchange_weak(range, Pack(begin, end - take), std::memory_order_acq_rel))
+                {
+                    // Only this thread refills its own empty range, and thieves skip empty ranges
+                    own.range.store(Pack(end - take + 1, end), std::memory_order_release);
+                    own.steals.fetch_add(1, std::memory_order_relaxed);
+                    item = items[end - take];
+                    return true;
+                }
+                contended = true;
+            }
+        }
+    }
+    return false;
+}
+
+long long int TileQueue::Steals() const
+{
+    long long int total = 0;
+    for (int t = 0; t < threadNum; ++t)
+        total += slots[t].steals.load(std::memory_order_relaxed);
+    return total;
+}
@@ -181,26 +181,24 @@ int HammingDist(const string &str1, const string &str2)
     return count;
 }
 
-void VerifyDistT(const vector<string> &vecs, const int minED, const int threadIdx, const int threadNum,
-                 atomic<bool> &success)
+void VerifyDistT(const PackedCandidateSet &vecs, const vector<uint64_t> &compositions, const int minED,
+                 const int threadIdx, const int threadNum, atomic<bool> &success, ConflictScanStats &stats)
 {
-    for (unsigned i = threadIdx; i < vecs.size(); i += threadNum)
-    {
-        PatternHandle handle = MakePattern(vecs[i]);
-        for (unsigned j = i + 1; j < vecs.size(); j++)
+    WithConflictScanner(vecs, compositions, stats, [&](const auto &scanRow) {
+        for (unsigned i = threadIdx; i < vecs.size(); i += threadNum)
         {
-            // int ED = FastEditDistance(vecs[i], vecs[j]); // Old version
-            int ED = EditDistanceBanded(vecs[j], handle, minED - 1);
-            if (ED < minED)
+            bool violated = false;
+            scanRow(i, i + 1, vecs.size(), minED, [&](size_t) { violated = true; });
+            if (violated)
             {
                 success = false;
                 return;
             }
         }
-    }
+    });
 }
 
-void VerifyDist(vector<string> &vecs, const int minED, const int threadNum, bool useGPU, double maxGPUMemoryGB, bool isBinary)
+void VerifyDist(const PackedCandidateSet &vecs, const int minED, const int threadNum, bool useGPU, double maxGPUMemoryGB, bool isBinary)
 {
     if (useGPU)
     {
@@ -213,7 +211,7 @@ void VerifyDist(vector<string> &vecs, const int minED, const int threadNum, bool
         string edgesFile = "temp_verify_edges.bin";
         
         // Write codebook to temp file
-        StrVecToFile(vecs, vecFile);
+        PackedToFile(vecs, vecFile);
         
         // Detect project root
         std::string project_root = ".";
@@ -291,12 +289,22 @@ void VerifyDist(vector<string> &vecs, const int minED, const int threadNum, bool
         // CPU verification (original path)
         atomic<bool> success(true);
         vector<thread> threads;
+        vector<ConflictScanStats> threadStats(threadNum);
+        const vector<uint64_t> compositions = PackedCompositions(vecs);
         for (int i = 0; i < threadNum; i++)
         {
-            threads.push_back(thread(VerifyDistT, vecs, minED, i, threadNum, ref(success)));
+            threads.push_back(thread(VerifyDistT, cref(vecs), cref(compositions), minED, i, threadNum, ref(success),
+                                     ref(threadStats[i])));
         }
         for (thread &th : threads)
             th.join();
+        ConflictScanStats stats;
+        for (const ConflictScanStats &ts : threadStats)
+            stats.Add(ts);
+        cout << "Verify Stages:\tHamming " << NumberWithCommas(stats.hammingConflicts) << " violations"
+             << "\tComposition " << NumberWithCommas(stats.compositionRejects) << " cleared"
+             << "\tEdit Distance " << NumberWithCommas(stats.dpConflicts) << " violations of "
+             << NumberWithCommas(stats.dpPairs) << " pairs" << endl;
         if (success)
         {
             cout << "Vector distance SUCCESS" << endl;
@@ -391,15 +399,20 @@ string FileName(const int codeLen, const int codeSize, const int minED)
     return fileName;
 }
 
-void ToFile(const vector<string> &codeWords, const Params &params, const int candidateNum,
+void ToFile(const PackedCandidateSet &codeWords, const Params &params, const int candidateNum,
             const long long int matrixOnesNum, const std::chrono::duration<double> &candidatesTime,
             const std::chrono::duration<double> &fillAdjListTime,
             const std::chrono::duration<double> &processMatrixTime, const std::chrono::duration<double> &overallTime,
-            int clusterK, int clusterIterations)
+            int clusterK, int clusterIterations, const string &directory)
 {
     int codeSize = codeWords.size();
     ofstream output;
     string fileName = FileName(params.codeLen, codeSize, params.codeMinED);
+    if (!directory.empty())
+    {
+        filesystem::create_directories(directory);
+        fileName = directory + "/" + fileName;
+    }
     output.open(fileName.c_str());
     if (!output.is_open())
     {
@@ -410,8 +423,10 @@ void ToFile(const vector<string> &codeWords, const Params &params, const int can
     PrintParamsToFile(output, candidateNum, codeSize, params, matrixOnesNum, candidatesTime, fillAdjListTime,
                       processMatrixTime, overallTime, clusterK, clusterIterations);
 
-    for (const string &word : codeWords)
+    string word;
+    for (size_t i = 0; i < codeWords.size(); i++)
     {
+        codeWords.Unpack(i, word);
         output << word << '\n';
     }
     output.close();
@@ -768,6 +783,17 @@ void ParamsToFile(const Params &params, const std::string &fileName)
     output_file << params.clustering.verbose << '\n';
     output_file << params.clustering.convergenceIterations << '\n';
     output_file << params.clustering.method << '\n';
+    output_file << params.graph.compositionTiles << '\n';
+    output_file << params.graph.builder << '\n';
+    output_file << params.graph.compressGraph << '\n';
+    output_file << params.graph.graphMemoryMB << '\n';
+    output_file << std::quoted(params.graph.cacheDir) << '\n';
+    output_file << params.graph.vertexOrder << '\n';
+    output_file << params.graph.bitsetMemoryMB << '\n';
+    output_file << params.solver.method << '\n';
+    output_file << params.solver.degreeWindow << '\n';
+    output_file << params.solver.restarts << '\n';
+    output_file << params.solver.kernel << '\n';
 
     // 2. Write the generation method type identifier (as an integer)
     output_file << static_cast<int>(params.method) << '\n';
@@ -809,6 +835,17 @@ void FileToParams(Params &params, const std::string &fileName)
     input_file >> params.clustering.verbose;
     input_file >> params.clustering.convergenceIterations;
     input_file >> params.clustering.method;
+    input_file >> params.graph.compositionTiles;
+    input_file >> params.graph.builder;
+    input_file >> params.graph.compressGraph;
+    input_file >> params.graph.graphMemoryMB;
+    input_file >> std::quoted(params.graph.cacheDir);
+    input_file >> params.graph.vertexOrder;
+    input_file >> params.graph.bitsetMemoryMB;
+    input_file >> params.solver.method;
+    input_file >> params.solver.degreeWindow;
+    input_file >> params.solver.restarts;
+    input_file >> params.solver.kernel;
 
     // 2. Read the integer, then cast it back to the GenerationMethod enum
     int method_type_int;
@@ -1228,6 +1265,7 @@ void LoadParamsFromJson(Params &params, const std::string &filename)
         auto& c = j["core"];
         if (c.contains("lenStart")) params.codeLen = c["lenStart"]; // Note: logic in main sets loops, here we just set base struct
         if (c.contains("editDist")) params.codeMinED = c["editDist"];
+        if (c.contains("editDists")) params.editDists = c["editDists"].get<std::vector<int>>();
     }
 
     // Constraints
@@ -1236,6 +1274,8 @@ void LoadParamsFromJson(Params &params, const std::string &filename)
         if (c.contains("maxRun")) params.maxRun = c["maxRun"];
         if (c.contains("minGC")) params.minGCCont = c["minGC"];
         if (c.contains("maxGC")) params.maxGCCont = c["maxGC"];
+        if (c.contains("maxRunSweep")) params.maxRunSweep = c["maxRunSweep"].get<std::vector<int>>();
+        if (c.contains("gcSweep")) params.gcSweep = c["gcSweep"].get<std::vector<std::pair<double, double>>>();
     }
 
     // Performance
@@ -1245,6 +1285,13 @@ void LoadParamsFromJson(Params &params, const std::string &filename)
         if (p.contains("saveInterval")) params.saveInterval = p["saveInterval"];
     if (p.contains("use_gpu")) params.useGPU = p["use_gpu"];
     if (p.contains("max_gpu_memory_gb")) params.maxGPUMemoryGB = p["max_gpu_memory_gb"];
+    if (p.contains("composition_tiles")) params.graph.compositionTiles = p["composition_tiles"];
+    if (p.contains("graphBuilder")) params.graph.builder = p["graphBuilder"];
+    if (p.contains("compress_graph")) params.graph.compressGraph = p["compress_graph"];
+    if (p.contains("graph_memory_mb")) params.graph.graphMemoryMB = p["graph_memory_mb"];
+    if (p.contains("graph_cache_dir")) params.graph.cacheDir = p["graph_cache_dir"];
+    if (p.contains("vertex_order")) params.graph.vertexOrder = p["vertex_order"];
+    if (p.contains("bitset_memory_mb")) params.graph.bitsetMemoryMB = p["bitset_memory_mb"];
     if (p.contains("do_clustering")) { // Backwards compatibility or manual override in performance
          params.clustering.enabled = p["do_clustering"];
     }
@@ -1260,6 +1307,15 @@ void LoadParamsFromJson(Params &params, const std::string &filename)
         if (c.contains("method")) params.clustering.method = c["method"];
     }
     
+    // Solver
+    if (j.contains("solver")) {
+        auto& c = j["solver"];
+        if (c.contains("method")) params.solver.method = c["method"];
+        if (c.contains("degreeWindow")) params.solver.degreeWindow = c["degreeWindow"];
+        if (c.contains("restarts")) params.solver.restarts = c["restarts"];
+        if (c.contains("kernelize")) params.solver.kernel = c["kernelize"];
+    }
+
     // Verify
     if (j.contains("verify")) params.verify = j["verify"];
 
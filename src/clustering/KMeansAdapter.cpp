@@ -53,5 +53,19 @@ std::vector<std::vector<std::string>> KMeansAdapter::cluster(const std::vector<s
     return hkmeans.getTraversableClusters();
 }
 
+std::vector<PackedCandidateSet> KMeansAdapter::cluster(const PackedCandidateSet &data)
+{
+    std::vector<std::vector<std::string>> textClusters = cluster(data.ToStrings());
+
+    std::vector<PackedCandidateSet> clusters;
+    clusters.reserve(textClusters.size());
+    for (std::vector<std::string> &textCluster : textClusters)
+    {
+        clusters.push_back(PackedCandidateSet::FromStrings(textCluster));
+        std::vector<std::string>().swap(textCluster);
+    }
+    return clusters;
+}
+
 } // namespace clustering
 } // namespace indexgen
@@ -3,6 +3,7 @@
 #include <string>
 #include <memory>
 #include "clustering/ClusteringInterface.hpp"
+#include "PackedCandidates.hpp"
 #include "impl/hierarchical_kmeans/HierarchicalAdjKMeans.hpp"
 
 namespace indexgen {
@@ -16,6 +17,10 @@ private:
 public:
     KMeansAdapter(int k, const std::string& method = "hierarchical_kmeans", bool isBinary = false);
     std::vector<std::vector<std::string>> cluster(const std::vector<std::string>& data) override;
+
+    // Packed front-end: the clustering implementations work on text, so the set is unpacked only for the duration
+    // of the fit and every cluster is packed again before it is returned.
+    std::vector<PackedCandidateSet> cluster(const PackedCandidateSet& data);
 };
 
 } // namespace clustering
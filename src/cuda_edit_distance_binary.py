@@ -1,6 +1,7 @@
 import numpy as np
 import math
 import warnings
+from contextlib import nullcontext
 from numba import cuda, uint64, int32, uint8, njit, prange
 from numba.core.errors import NumbaPerformanceWarning
 
@@ -356,7 +357,8 @@ def solve_edit_distance_cuda_binary(strings, threshold, output_file, tile_size=N
             global_edge_count[0] += count
 
     tile_idx = 0
-    with open(output_file, 'ab') as f_out:
+    # output_file is a path to append to, or an open binary stream (the IndexGen edge pipe), which the caller closes
+    with (nullcontext(output_file) if hasattr(output_file, 'write') else open(output_file, 'ab')) as f_out:
         while tile_idx < len(tiles) or len(active_tasks) > 0:
             while len(active_tasks) < num_streams and tile_idx < len(tiles):
                 stream_id = tile_idx % num_streams
@@ -3,6 +3,7 @@ import os
 import numpy as np
 import time
 from cuda_edit_distance import solve_edit_distance_cuda
+from graph_backend_protocol import parse_backend_args, read_candidates, open_edge_stream, serve_jobs
 
 # Configuration
 # Chunk size for writing binary data to keep RAM low
@@ -15,22 +16,44 @@ def load_candidates(filename):
     return strings
 
 def main():
-    if len(sys.argv) < 4:
+    # IndexGen passes the candidates and the edge pipe as descriptors (see graph_backend_protocol.py); the file
+    # interface is kept for running the script by hand
+    args, candidates_fd, edges_fd, worker_fd = parse_backend_args(sys.argv[1:])
+    streaming = candidates_fd is not None and edges_fd is not None
+    if ((streaming or worker_fd is not None) and len(args) < 1) or \
+            (not streaming and worker_fd is None and len(args) < 3):
         print("Usage: python gpu_graph_generator.py <input_vectors.txt> <output_edges.bin> <threshold> [max_gpu_memory_gb]")
+        print("       python gpu_graph_generator.py <threshold> [max_gpu_memory_gb] --candidates-fd N --edges-fd M")
+        print("       python gpu_graph_generator.py <threshold> [max_gpu_memory_gb] --worker-fd N")
         sys.exit(1)
 
-    input_file = sys.argv[1]
-    output_file = sys.argv[2]
-    threshold = int(sys.argv[3])
+    # Persistent worker: the CUDA context and the JIT-compiled kernels are reused for every job IndexGen sends
+    if worker_fd is not None:
+        threshold = int(args[0])
+        max_gpu_gb = float(args[1]) if len(args) > 1 else 9.0
+
+        def build_edges(strings):
+            adj_list = solve_edit_distance_cuda(strings, threshold, tile_size=16384, max_gpu_memory_gb=max_gpu_gb)
+            return [(i, neighbor) for i, neighbors in enumerate(adj_list) for neighbor in neighbors if i < neighbor]
+
+        serve_jobs(worker_fd, build_edges)
+        return
+
+    if streaming:
+        input_file, output_file = f"fd {candidates_fd}", f"fd {edges_fd}"
+        args = [None, None] + args
+    else:
+        input_file, output_file = args[0], args[1]
+    threshold = int(args[2])
     
     max_gpu_gb = 9.0
 
-    if len(sys.argv) > 4:
-        max_gpu_gb = float(sys.argv[4])
+    if len(args) > 3:
+        max_gpu_gb = float(args[3])
     
     # 1. Load Strings
     print(f"[Python GPU] Loading strings from {input_file}...")
-    strings = load_candidates(input_file)
+    strings = read_candidates(candidates_fd) if streaming else load_candidates(input_file)
     N = len(strings)
     print(f"[Python GPU] Loaded {N} strings. Running CUDA Solver with T={threshold}, Memory Limit={max_gpu_gb}GB...")
 
@@ -51,10 +74,10 @@ def main():
     # However, to save disk I/O, we only write unique pairs (i, j) where i < j.
     # The C++ loader will handle the symmetric insertion.
     
-    print(f"[Python GPU] Writing edges to binary file {output_file}...")
+    print(f"[Python GPU] Writing edges to {output_file}...")
     start_t = time.time()
     edge_count = 0
-    with open(output_file, 'wb') as f_out:
+    with (open_edge_stream(edges_fd) if streaming else open(output_file, 'wb')) as f_out:
         buffer = []
         for i, neighbors in enumerate(adj_list):
             for neighbor in neighbors:
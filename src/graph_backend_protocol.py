@@ -0,0 +1,132 @@
+"""
+Binary hand-off between IndexGen and a distance backend (see include/GraphBackend.hpp).
+
+IndexGen starts a backend as
+
+    <backend> <threshold> [max_gpu_memory_gb] --candidates-fd N --edges-fd M
+
+Descriptor N is an anonymous memory file holding a 24-byte header (magic b'IGPK', version, candidate count, code
+length, 64-bit words per candidate) followed by the 2-bit packed candidates. Descriptor M is a pipe that takes the
+conflict edges as int32 (u, v) records with u < v, written as they are found; the backend exits with status 0 once
+all of them are written.
+
+Started with `--worker-fd N` instead, the backend is a persistent worker: descriptor N is a Unix stream socket that
+carries job batches, each a 24-byte header (magic b'IGJB', version, job count, code length, 64-bit words per candidate,
+reserved), one uint64 candidate count per job and then every job's packed candidates back to back. The worker answers
+each job in order with a uint64 edge count followed by that many int32 (u, v) records, u < v in the job's own
+numbering, and exits with status 0 once IndexGen shuts the socket down.
+"""
+
+import mmap
+import os
+import socket
+import struct
+
+import numpy as np
+
+HEADER = struct.Struct('<4sIQII')
+MAGIC = b'IGPK'
+VERSION = 1
+BATCH_HEADER = struct.Struct('<4sIIIII')
+BATCH_MAGIC = b'IGJB'
+BATCH_VERSION = 1
+SYMBOLS_PER_WORD = 32
+
+
+def parse_backend_args(argv):
+    """Splits argv into (positional args, candidates fd, edges fd, worker fd); absent fds are None (the legacy file
+    interface has none of them)."""
+    positional = []
+    fds = {'--candidates-fd': None, '--edges-fd': None, '--worker-fd': None}
+    i = 0
+    while i < len(argv):
+        if argv[i] in fds and i + 1 < len(argv):
+            fds[argv[i]] = int(argv[i + 1])
+            i += 2
+        else:
+            positional.append(argv[i])
+            i += 1
+    return positional, fds['--candidates-fd'], fds['--edges-fd'], fds['--worker-fd']
+
+
+def read_candidate_symbols(fd):
+    """Returns the candidates of the memory file as an (N, L) uint8 array of symbols 0..3."""
+    size = os.fstat(fd).st_size
+    if size < HEADER.size:
+        raise ValueError("candidate segment is truncated")
+    with mmap.mmap(fd, size, prot=mmap.PROT_READ) as segment:
+        magic, version, n, length, words_per_seq = HEADER.unpack_from(segment, 0)
+        if magic != MAGIC or version != VERSION or size < HEADER.size + 8 * n * words_per_seq:
+            raise ValueError("malformed candidate segment")
+        words = np.frombuffer(segment, dtype=np.uint64, count=n * words_per_seq, offset=HEADER.size)
+        words = words.reshape(n, words_per_seq).copy()
+
+    return unpack_symbols(words, length)
+
+
+def unpack_symbols(words, length):
+    """Turns (N, words per candidate) packed uint64 words into an (N, L) uint8 array of symbols 0..3."""
+    symbols = np.empty((words.shape[0], length), dtype=np.uint8)
+    for pos in range(length):
+        shift = np.uint64(2 * (pos % SYMBOLS_PER_WORD))
+        symbols[:, pos] = (words[:, pos // SYMBOLS_PER_WORD] >> shift) & np.uint64(3)
+    return symbols
+
+
+def symbols_to_strings(symbols):
+    """Returns the rows of a symbol array as strings over '0'..'3' (the form the CUDA solvers take)."""
+    n, length = symbols.shape
+    raw = (symbols + ord('0')).tobytes().decode('ascii')
+    return [raw[i * length:(i + 1) * length] for i in range(n)]
+
+
+def read_candidates(fd):
+    """Returns the candidates of the memory file as strings over '0'..'3'."""
+    return symbols_to_strings(read_candidate_symbols(fd))
+
+
+def open_edge_stream(fd):
+    """Opens the edge pipe for writing int32 (u, v) records."""
+    return os.fdopen(fd, 'wb', buffering=1 << 20)
+
+
+def _read_exact(stream, size):
+    data = stream.read(size)
+    if len(data) != size:
+        raise ValueError("the job stream ended inside a batch")
+    return data
+
+
+def serve_jobs(fd, build_edges):
+    """Serves the job batches of the worker socket until IndexGen shuts it down.
+
+    build_edges(strings) returns a job's conflict edges as int32 (u, v) records with u < v: raw bytes or an array
+    that converts to an (E, 2) int32 array.
+    """
+    sock = socket.socket(fileno=fd)
+    reader = sock.makefile('rb')
+    writer = sock.makefile('wb')
+    while True:
+        header = reader.read(BATCH_HEADER.size)
+        if not header:
+            break
+        if len(header) != BATCH_HEADER.size:
+            raise ValueError("the job stream ended inside a batch header")
+        magic, version, job_num, length, words_per_seq, _ = BATCH_HEADER.unpack(header)
+        if magic != BATCH_MAGIC or version != BATCH_VERSION:
+            raise ValueError("malformed job batch")
+        counts = np.frombuffer(_read_exact(reader, 8 * job_num), dtype=np.uint64)
+        jobs = []
+        for count in counts:
+            words = np.frombuffer(_read_exact(reader, 8 * int(count) * words_per_seq), dtype=np.uint64)
+            jobs.append(symbols_to_strings(unpack_symbols(words.reshape(int(count), words_per_seq), length)))
+        for strings in jobs:
+            edges = build_edges(strings) if strings else b''
+            if not isinstance(edges, (bytes, bytearray)):
+                edges = np.ascontiguousarray(edges, dtype=np.int32).reshape(-1, 2).tobytes()
+            writer.write(struct.pack('<Q', len(edges) // 8))
+            writer.write(edges)
+        writer.flush()
+    writer.close()
+    reader.close()
+    sock.close()